@@ -0,0 +1,247 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <QPainter>
+
+#include "../core/compressedpixmapcache_p.h"
+#include "../core/observer.h"
+
+class CacheTestObserver : public Okular::DocumentObserver
+{
+};
+
+class CompressedPixmapCacheTest
+    : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void initTestCase();
+        void testRoundTrip_data();
+        void testRoundTrip();
+        void testSizeMismatch();
+        void testMemoryLimit();
+        void testDiskSpill();
+        void testDiskLru();
+        void testRemove();
+        void testDisabled();
+
+    private:
+        static QImage pageImage( int width, int height, QImage::Format format, int seed );
+
+        CacheTestObserver m_observer;
+        CacheTestObserver m_otherObserver;
+};
+
+QImage CompressedPixmapCacheTest::pageImage( int width, int height, QImage::Format format, int seed )
+{
+    // white with some lines of "text", compresses like a real page
+    QImage image( width, height, QImage::Format_ARGB32_Premultiplied );
+    image.fill( Qt::white );
+    QPainter painter( &image );
+    for ( int y = 10 + seed % 7; y < height - 10; y += 14 )
+        painter.fillRect( 20, y, width - 40 - ( y * seed ) % 50, 8, Qt::black );
+    painter.end();
+    return image.convertToFormat( format );
+}
+
+void CompressedPixmapCacheTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled( true );
+}
+
+void CompressedPixmapCacheTest::testRoundTrip_data()
+{
+    QTest::addColumn< int >( "format" );
+
+    QTest::newRow( "ARGB32_Premultiplied" ) << int( QImage::Format_ARGB32_Premultiplied );
+    QTest::newRow( "RGB32" ) << int( QImage::Format_RGB32 );
+    QTest::newRow( "Grayscale8" ) << int( QImage::Format_Grayscale8 );
+}
+
+void CompressedPixmapCacheTest::testRoundTrip()
+{
+    QFETCH( int, format );
+
+    Okular::CompressedPixmapCache cache;
+    cache.setLimits( 16 * 1024 * 1024, 0 );
+
+    // an odd width, so the lines of the 8 bit image are padded
+    const QImage image = pageImage( 301, 400, QImage::Format( format ), 1 );
+    cache.insert( &m_observer, 3, image );
+    QCOMPARE( cache.count(), 1 );
+
+    // the compressed image takes much less than the original
+    QTRY_VERIFY( cache.memory() < qulonglong( image.byteCount() ) / 4 );
+
+    const QImage restored = cache.image( &m_observer, 3, 301, 400 );
+    QCOMPARE( restored.format(), image.format() );
+    QCOMPARE( restored, image );
+
+    // it stays there
+    QCOMPARE( cache.image( &m_observer, 3, 301, 400 ), image );
+    QVERIFY( cache.image( &m_otherObserver, 3, 301, 400 ).isNull() );
+    QVERIFY( cache.image( &m_observer, 4, 301, 400 ).isNull() );
+}
+
+void CompressedPixmapCacheTest::testSizeMismatch()
+{
+    Okular::CompressedPixmapCache cache;
+    cache.setLimits( 16 * 1024 * 1024, 0 );
+
+    cache.insert( &m_observer, 0, pageImage( 200, 300, QImage::Format_ARGB32_Premultiplied, 1 ) );
+    QVERIFY( cache.image( &m_observer, 0, 400, 600 ).isNull() );
+
+    // another size replaces the one kept
+    const QImage bigger = pageImage( 400, 600, QImage::Format_ARGB32_Premultiplied, 2 );
+    cache.insert( &m_observer, 0, bigger );
+    QCOMPARE( cache.count(), 1 );
+    QVERIFY( cache.image( &m_observer, 0, 200, 300 ).isNull() );
+    QCOMPARE( cache.image( &m_observer, 0, 400, 600 ), bigger );
+}
+
+void CompressedPixmapCacheTest::testMemoryLimit()
+{
+    Okular::CompressedPixmapCache cache;
+    cache.setLimits( 16 * 1024 * 1024, 0 );
+
+    QList< QImage > images;
+    for ( int page = 0; page < 8; ++page )
+    {
+        images << pageImage( 600, 800, QImage::Format_ARGB32_Premultiplied, page );
+        cache.insert( &m_observer, page, images.last() );
+    }
+    QTRY_VERIFY( cache.memory() < qulonglong( images.first().byteCount() ) );
+    const qulonglong compressedSize = cache.memory() / 8;
+
+    // page 0 is used again, so page 1 is now the least recently used one
+    QVERIFY( !cache.image( &m_observer, 0, 600, 800 ).isNull() );
+
+    // room for about four pages, without a disk to move them to
+    cache.setLimits( compressedSize * 4 + compressedSize / 2, 0 );
+    QVERIFY( cache.memory() <= compressedSize * 4 + compressedSize / 2 );
+    QVERIFY( cache.count() < 8 );
+    QCOMPARE( cache.diskMemory(), qulonglong( 0 ) );
+    QCOMPARE( cache.image( &m_observer, 0, 600, 800 ), images.at( 0 ) );
+    QCOMPARE( cache.image( &m_observer, 7, 600, 800 ), images.at( 7 ) );
+    QVERIFY( cache.image( &m_observer, 1, 600, 800 ).isNull() );
+}
+
+void CompressedPixmapCacheTest::testDiskSpill()
+{
+    QList< QImage > images;
+    for ( int page = 0; page < 6; ++page )
+        images << pageImage( 600, 800, QImage::Format_ARGB32_Premultiplied, page );
+
+    qulonglong compressedSize;
+    {
+        Okular::CompressedPixmapCache cache;
+        cache.setLimits( 16 * 1024 * 1024, 0 );
+        cache.insert( &m_observer, 0, images.first() );
+        QTRY_VERIFY( cache.memory() < qulonglong( images.first().byteCount() ) );
+        compressedSize = cache.memory();
+    }
+
+    Okular::CompressedPixmapCache cache;
+    cache.setLimits( compressedSize * 2 + compressedSize / 2, 64 * 1024 * 1024 );
+    for ( int page = 0; page < 6; ++page )
+    {
+        cache.insert( &m_observer, page, images.at( page ) );
+        // the pages that don't fit in memory anymore go to disk
+        QTRY_VERIFY( cache.memory() <= compressedSize * 2 + compressedSize / 2 );
+    }
+    QTRY_COMPARE( cache.count(), 6 );
+    QVERIFY( cache.diskMemory() > 0 );
+
+    for ( int page = 0; page < 6; ++page )
+        QCOMPARE( cache.image( &m_observer, page, 600, 800 ), images.at( page ) );
+}
+
+void CompressedPixmapCacheTest::testDiskLru()
+{
+    QList< QImage > images;
+    for ( int page = 0; page < 4; ++page )
+        images << pageImage( 600, 800, QImage::Format_ARGB32_Premultiplied, page );
+
+    qulonglong compressedSize;
+    {
+        Okular::CompressedPixmapCache cache;
+        cache.setLimits( 16 * 1024 * 1024, 0 );
+        cache.insert( &m_observer, 0, images.first() );
+        QTRY_VERIFY( cache.memory() < qulonglong( images.first().byteCount() ) );
+        compressedSize = cache.memory();
+    }
+
+    // room for one page in memory and two on disk
+    const qulonglong memoryLimit = compressedSize + compressedSize / 2;
+    Okular::CompressedPixmapCache cache;
+    cache.setLimits( memoryLimit, compressedSize * 2 + compressedSize / 2 );
+    for ( int page = 0; page < 3; ++page )
+    {
+        cache.insert( &m_observer, page, images.at( page ) );
+        QTRY_VERIFY( cache.memory() <= memoryLimit );
+    }
+    QCOMPARE( cache.count(), 3 );
+
+    // pages 0 and 1 are on disk, page 0 is used again, so moving page 2
+    // there too drops page 1
+    QCOMPARE( cache.image( &m_observer, 0, 600, 800 ), images.at( 0 ) );
+    cache.insert( &m_observer, 3, images.at( 3 ) );
+    QTRY_COMPARE( cache.count(), 3 );
+    QVERIFY( cache.image( &m_observer, 1, 600, 800 ).isNull() );
+    QCOMPARE( cache.image( &m_observer, 0, 600, 800 ), images.at( 0 ) );
+    QCOMPARE( cache.image( &m_observer, 2, 600, 800 ), images.at( 2 ) );
+    QCOMPARE( cache.image( &m_observer, 3, 600, 800 ), images.at( 3 ) );
+}
+
+void CompressedPixmapCacheTest::testRemove()
+{
+    Okular::CompressedPixmapCache cache;
+    cache.setLimits( 16 * 1024 * 1024, 0 );
+
+    const QImage image = pageImage( 200, 300, QImage::Format_RGB32, 3 );
+    cache.insert( &m_observer, 0, image );
+    cache.insert( &m_observer, 1, image );
+    cache.insert( &m_otherObserver, 0, image );
+    cache.insert( &m_otherObserver, 1, image );
+    QCOMPARE( cache.count(), 4 );
+
+    cache.removePage( 1 );
+    QCOMPARE( cache.count(), 2 );
+    QVERIFY( cache.image( &m_observer, 1, 200, 300 ).isNull() );
+
+    cache.removeObserver( &m_otherObserver );
+    QCOMPARE( cache.count(), 1 );
+    QCOMPARE( cache.image( &m_observer, 0, 200, 300 ), image );
+
+    cache.clear();
+    QCOMPARE( cache.count(), 0 );
+    QTRY_COMPARE( cache.memory(), qulonglong( 0 ) );
+}
+
+void CompressedPixmapCacheTest::testDisabled()
+{
+    Okular::CompressedPixmapCache cache;
+    cache.insert( &m_observer, 0, pageImage( 200, 300, QImage::Format_RGB32, 1 ) );
+    QCOMPARE( cache.count(), 0 );
+
+    cache.setLimits( 16 * 1024 * 1024, 0 );
+    cache.insert( &m_observer, 0, pageImage( 200, 300, QImage::Format_RGB32, 1 ) );
+    QCOMPARE( cache.count(), 1 );
+
+    // switching it off drops what is kept
+    cache.setLimits( 0, 0 );
+    QCOMPARE( cache.count(), 0 );
+    QCOMPARE( cache.memory(), qulonglong( 0 ) );
+}
+
+QTEST_MAIN( CompressedPixmapCacheTest )
+#include "compressedpixmapcachetest.moc"
@@ -15,6 +15,7 @@
 #include <threadweaver/queue.h>
 
 #include "../core/annotations.h"
+#include "../core/form.h"
 #include "../core/document.h"
 #include "../core/document_p.h"
 #include "../core/generator.h"
@@ -31,6 +32,8 @@ class DocumentTest
     private slots:
         void testCloseDuringRotationJob();
         void testDocdataMigration();
+        void testReloadKeepsLinks();
+        void testSwapBackingFileOfLazyPages();
 };
 
 // Test that we don't crash if the document is closed while a RotationJob
@@ -129,5 +132,156 @@ void DocumentTest::testDocdataMigration()
     delete m_document;
 }
 
+// The points of a grid over the page that are on a link
+static QList< QPointF > linkPoints( const Okular::Page *page )
+{
+    QList< QPointF > points;
+    for ( int i = 0; i < 100; ++i )
+    {
+        for ( int j = 0; j < 100; ++j )
+        {
+            const QPointF point( ( j + 0.5 ) / 100, ( i + 0.5 ) / 100 );
+            if ( page->objectRect( Okular::ObjectRect::Action, point.x(), point.y(), page->width(), page->height() ) )
+                points << point;
+        }
+    }
+    return points;
+}
+
+// Test that the pages that did not change keep their pixmap and their links
+// when the document is reloaded, even if the first attempt to open it fails
+void DocumentTest::testReloadKeepsLinks()
+{
+    Okular::SettingsCore::instance( QStringLiteral("documenttest") );
+
+    const QString latexPath = QStandardPaths::findExecutable( QStringLiteral("latex") );
+    if ( latexPath.isEmpty() )
+        QSKIP( "latex executable not found, but needed for the test." );
+
+    const QTemporaryDir workDir;
+    QFile texFile( workDir.path() + QStringLiteral("/links.tex") );
+    QVERIFY( texFile.open( QIODevice::WriteOnly ) );
+    texFile.write( "\\documentclass{article}\n"
+                   "\\usepackage[hypertex]{hyperref}\n"
+                   "\\begin{document}\n"
+                   "\\href{https://okular.kde.org}{A link to the website of Okular}\n"
+                   "\\newpage\n"
+                   "The second page.\n"
+                   "\\end{document}\n" );
+    texFile.close();
+
+    QProcess process;
+    process.setWorkingDirectory( workDir.path() );
+    process.start( latexPath, QStringList() << QStringLiteral("-interaction=nonstopmode") << texFile.fileName() );
+    QVERIFY( process.waitForFinished() );
+    const QString dviPath = workDir.path() + QStringLiteral("/links.dvi");
+    QVERIFY( QFile::exists( dviPath ) );
+
+    Okular::Document *m_document = new Okular::Document( nullptr );
+    Okular::DocumentObserver *observer = new Okular::DocumentObserver();
+    m_document->addObserver( observer );
+    QMimeDatabase db;
+    const QMimeType mime = db.mimeTypeForFile( dviPath );
+    QCOMPARE( m_document->openDocument( dviPath, QUrl::fromLocalFile( dviPath ), mime ), Okular::Document::OpenSuccess );
+
+    // the DVI generator makes the links of a page when rendering it
+    const int width = 300;
+    const int height = qRound( width * m_document->page( 0 )->ratio() );
+    m_document->requestPixmaps( QLinkedList<Okular::PixmapRequest*>() << new Okular::PixmapRequest( observer, 0, width, height, 1, Okular::PixmapRequest::NoFeature ) );
+    QTRY_VERIFY( m_document->page( 0 )->hasPixmap( observer, width, height ) );
+    const QList< QPointF > links = linkPoints( m_document->page( 0 ) );
+    QVERIFY( !links.isEmpty() );
+
+    // the first attempt fails, as when the file is still being written
+    m_document->prepareReload();
+    m_document->closeDocument();
+    QVERIFY( QFile::rename( dviPath, dviPath + QStringLiteral(".moved") ) );
+    QCOMPARE( m_document->openDocument( dviPath, QUrl::fromLocalFile( dviPath ), mime ), Okular::Document::OpenError );
+
+    m_document->prepareReload();
+    QVERIFY( QFile::rename( dviPath + QStringLiteral(".moved"), dviPath ) );
+    QCOMPARE( m_document->openDocument( dviPath, QUrl::fromLocalFile( dviPath ), mime ), Okular::Document::OpenSuccess );
+
+    // nothing was rendered again
+    QVERIFY( m_document->page( 0 )->hasPixmap( observer, width, height ) );
+    QCOMPARE( linkPoints( m_document->page( 0 ) ), links );
+
+    delete m_document;
+    delete observer;
+}
+
+// Test that the pages of a big PDF file, whose contents are loaded lazily,
+// keep their annotations and forms when the file is saved somewhere else
+void DocumentTest::testSwapBackingFileOfLazyPages()
+{
+    Okular::SettingsCore::instance( QStringLiteral("documenttest") );
+
+    const QString pdflatexPath = QStandardPaths::findExecutable( QStringLiteral("pdflatex") );
+    if ( pdflatexPath.isEmpty() )
+        QSKIP( "pdflatex executable not found, but needed for the test." );
+
+    // more pages than the PDF generator loads right away, with a form on
+    // one of the last ones
+    const int pageCount = 60;
+    const int formPage = 55;
+    QByteArray tex = "\\documentclass{article}\n"
+                     "\\usepackage{hyperref}\n"
+                     "\\begin{document}\n";
+    for ( int i = 0; i < pageCount; ++i )
+    {
+        tex += "Page " + QByteArray::number( i + 1 ) + ".\n";
+        if ( i == formPage )
+            tex += "\\begin{Form}\\TextField[name=field,width=4cm]{Field}\\end{Form}\n";
+        tex += "\\newpage\n";
+    }
+    tex += "\\end{document}\n";
+
+    const QTemporaryDir workDir;
+    QFile texFile( workDir.path() + QStringLiteral("/lazy.tex") );
+    QVERIFY( texFile.open( QIODevice::WriteOnly ) );
+    texFile.write( tex );
+    texFile.close();
+
+    QProcess process;
+    process.setWorkingDirectory( workDir.path() );
+    process.start( pdflatexPath, QStringList() << QStringLiteral("-interaction=nonstopmode") << texFile.fileName() );
+    QVERIFY( process.waitForFinished() );
+    const QString pdfPath = workDir.path() + QStringLiteral("/lazy.pdf");
+    QVERIFY( QFile::exists( pdfPath ) );
+
+    Okular::Document *m_document = new Okular::Document( nullptr );
+    QMimeDatabase db;
+    const QMimeType mime = db.mimeTypeForFile( pdfPath );
+    QCOMPARE( m_document->openDocument( pdfPath, QUrl::fromLocalFile( pdfPath ), mime ), Okular::Document::OpenSuccess );
+    QCOMPARE( (int)m_document->pages(), pageCount );
+    QTRY_COMPARE( m_document->page( formPage )->formFields().count(), 1 );
+
+    Okular::Annotation *annotation = new Okular::TextAnnotation();
+    annotation->setBoundingRectangle( Okular::NormalizedRect( 0.1, 0.1, 0.15, 0.15 ) );
+    m_document->addPageAnnotation( formPage, annotation );
+    const QString annotationName = annotation->uniqueName();
+
+    const QString savedPath = workDir.path() + QStringLiteral("/saved.pdf");
+    QVERIFY( m_document->saveChanges( savedPath ) );
+    QVERIFY( m_document->swapBackingFile( savedPath, QUrl::fromLocalFile( savedPath ) ) );
+
+    // right away, and once nothing is left to load in the background
+    for ( int i = 0; i < 2; ++i )
+    {
+        const Okular::Page *page = m_document->page( formPage );
+        QCOMPARE( page->formFields().count(), 1 );
+        QCOMPARE( page->formFields().first()->name(), QStringLiteral("field") );
+        QCOMPARE( page->annotations().count(), 1 );
+        QVERIFY( page->annotation( annotationName ) );
+        QTest::qWait( 100 );
+    }
+
+    // the undo stack refers to the annotation of the new file
+    m_document->undo();
+    QCOMPARE( m_document->page( formPage )->annotations().count(), 0 );
+
+    delete m_document;
+}
+
 QTEST_MAIN( DocumentTest )
 #include "documenttest.moc"
@@ -0,0 +1,239 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include "../core/area.h"
+#include "../core/generator.h"
+#include "../core/observer.h"
+#include "../core/pixmaprequestqueue_p.h"
+
+class QueueTestObserver : public Okular::DocumentObserver
+{
+};
+
+class PixmapRequestQueueTest
+    : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void testPriorityOrder();
+        void testPriorityZeroOrder();
+        void testRemove();
+        void testTake();
+        void testMergeDuplicates();
+        void testMergeTiles();
+        void testMergeNeighbouringTiles();
+        void testRandomOperations();
+
+    private:
+        Okular::PixmapRequest *request( int page, int priority, Okular::DocumentObserver *observer = nullptr );
+        Okular::PixmapRequest *tileRequest( int page, const Okular::NormalizedRect &rect );
+
+        QueueTestObserver m_observer;
+        QueueTestObserver m_otherObserver;
+};
+
+Okular::PixmapRequest *PixmapRequestQueueTest::request( int page, int priority, Okular::DocumentObserver *observer )
+{
+    return new Okular::PixmapRequest( observer ? observer : &m_observer, page, 100, 100, priority, Okular::PixmapRequest::Asynchronous );
+}
+
+Okular::PixmapRequest *PixmapRequestQueueTest::tileRequest( int page, const Okular::NormalizedRect &rect )
+{
+    Okular::PixmapRequest *r = request( page, 1 );
+    r->setTile( true );
+    r->setNormalizedRect( rect );
+    return r;
+}
+
+void PixmapRequestQueueTest::testPriorityOrder()
+{
+    Okular::PixmapRequestQueue queue;
+    queue.push( request( 0, 4 ) );
+    queue.push( request( 1, 1 ) );
+    queue.push( request( 2, 2 ) );
+    queue.push( request( 3, 1 ) );
+    QCOMPARE( queue.count(), 4 );
+
+    // same priority: first come, first served
+    const int expectedPages[] = { 1, 3, 2, 0 };
+    for ( int page : expectedPages )
+    {
+        Okular::PixmapRequest *r = queue.pop();
+        QCOMPARE( r->pageNumber(), page );
+        delete r;
+    }
+    QVERIFY( queue.isEmpty() );
+    QVERIFY( !queue.pop() );
+}
+
+void PixmapRequestQueueTest::testPriorityZeroOrder()
+{
+    Okular::PixmapRequestQueue queue;
+    queue.push( request( 0, 1 ) );
+    queue.push( request( 1, 0 ) );
+    queue.push( request( 2, 0 ) );
+
+    // the latest priority 0 request goes first
+    QCOMPARE( queue.top()->pageNumber(), 2 );
+    qDeleteAll( queue.takeAll() );
+    QVERIFY( queue.isEmpty() );
+}
+
+void PixmapRequestQueueTest::testRemove()
+{
+    Okular::PixmapRequestQueue queue;
+    Okular::PixmapRequest *first = queue.push( request( 0, 1 ) );
+    Okular::PixmapRequest *middle = queue.push( request( 1, 2 ) );
+    Okular::PixmapRequest *last = queue.push( request( 2, 3 ) );
+
+    QVERIFY( queue.remove( middle ) );
+    QVERIFY( !queue.remove( middle ) );
+    delete middle;
+
+    QCOMPARE( queue.pop(), first );
+    QCOMPARE( queue.pop(), last );
+    QVERIFY( queue.isEmpty() );
+    delete first;
+    delete last;
+}
+
+void PixmapRequestQueueTest::testTake()
+{
+    Okular::PixmapRequestQueue queue;
+    queue.push( request( 0, 1 ) );
+    queue.push( request( 1, 1 ) );
+    queue.push( request( 1, 2, &m_otherObserver ) );
+    queue.push( request( 2, 3, &m_otherObserver ) );
+
+    QVector< Okular::PixmapRequest * > taken = queue.take( &m_observer, 1 );
+    QCOMPARE( taken.count(), 1 );
+    QCOMPARE( taken.first()->observer(), &m_observer );
+    QCOMPARE( taken.first()->pageNumber(), 1 );
+    qDeleteAll( taken );
+    QCOMPARE( queue.count(), 3 );
+
+    taken = queue.take( &m_otherObserver );
+    QCOMPARE( taken.count(), 2 );
+    qDeleteAll( taken );
+    QCOMPARE( queue.count(), 1 );
+    QCOMPARE( queue.top()->observer(), &m_observer );
+
+    QVERIFY( queue.take( &m_otherObserver ).isEmpty() );
+    qDeleteAll( queue.takeAll() );
+}
+
+void PixmapRequestQueueTest::testMergeDuplicates()
+{
+    Okular::PixmapRequestQueue queue;
+    queue.push( request( 5, 1 ) );
+    Okular::PixmapRequest *queued = queue.push( request( 0, 4 ) );
+
+    // the duplicate is merged, and takes over its better priority
+    QCOMPARE( queue.push( request( 0, 0 ) ), queued );
+    QCOMPARE( queue.count(), 2 );
+    QCOMPARE( queued->priority(), 0 );
+    QCOMPARE( queue.top(), queued );
+
+    // a different size is not a duplicate
+    queue.push( new Okular::PixmapRequest( &m_observer, 0, 200, 200, 4, Okular::PixmapRequest::Asynchronous ) );
+    QCOMPARE( queue.count(), 3 );
+
+    // nor is a synchronous request
+    queue.push( new Okular::PixmapRequest( &m_observer, 0, 100, 100, 0, Okular::PixmapRequest::NoFeature ) );
+    QCOMPARE( queue.count(), 4 );
+
+    qDeleteAll( queue.takeAll() );
+}
+
+void PixmapRequestQueueTest::testMergeTiles()
+{
+    Okular::PixmapRequestQueue queue;
+    Okular::PixmapRequest *queued = queue.push( tileRequest( 0, Okular::NormalizedRect( 0.0, 0.0, 0.5, 0.5 ) ) );
+
+    // a region covered by a queued one is merged into it
+    QCOMPARE( queue.push( tileRequest( 0, Okular::NormalizedRect( 0.0, 0.0, 0.5, 0.5 ) ) ), queued );
+    QCOMPARE( queue.push( tileRequest( 0, Okular::NormalizedRect( 0.25, 0.25, 0.5, 0.5 ) ) ), queued );
+    QCOMPARE( queue.count(), 1 );
+    QCOMPARE( queued->normalizedRect(), Okular::NormalizedRect( 0.0, 0.0, 0.5, 0.5 ) );
+
+    // overlapping regions and neighbouring tiles stay separate requests,
+    // nothing is rendered as part of a bigger region
+    queue.push( tileRequest( 0, Okular::NormalizedRect( 0.25, 0.25, 0.75, 0.75 ) ) );
+    queue.push( tileRequest( 0, Okular::NormalizedRect( 0.5, 0.0, 1.0, 0.5 ) ) );
+    QCOMPARE( queue.count(), 3 );
+    QCOMPARE( queued->normalizedRect(), Okular::NormalizedRect( 0.0, 0.0, 0.5, 0.5 ) );
+
+    qDeleteAll( queue.takeAll() );
+}
+
+void PixmapRequestQueueTest::testMergeNeighbouringTiles()
+{
+    // the tiles of a page share their edges, which count as an intersection:
+    // none of them may be merged into another, or the requests would grow
+    // until one of them covers the whole page
+    Okular::PixmapRequestQueue queue;
+    QList< Okular::PixmapRequest * > tiles;
+    for ( int row = 0; row < 4; ++row )
+    {
+        for ( int column = 0; column < 4; ++column )
+        {
+            const Okular::NormalizedRect rect( column * 0.25, row * 0.25, ( column + 1 ) * 0.25, ( row + 1 ) * 0.25 );
+            Okular::PixmapRequest *tile = queue.push( tileRequest( 0, rect ) );
+            QCOMPARE( tile->normalizedRect(), rect );
+            tiles.append( tile );
+        }
+    }
+    QCOMPARE( queue.count(), 16 );
+
+    // asking again for one of them merges into it
+    QCOMPARE( queue.push( tileRequest( 0, tiles.at( 5 )->normalizedRect() ) ), tiles.at( 5 ) );
+    QCOMPARE( queue.count(), 16 );
+
+    qDeleteAll( queue.takeAll() );
+}
+
+void PixmapRequestQueueTest::testRandomOperations()
+{
+    Okular::PixmapRequestQueue queue;
+    QList< Okular::PixmapRequest * > queued;
+    qsrand( 42 );
+    for ( int i = 0; i < 500; ++i )
+        queued << queue.push( request( i, qrand() % 6 ) );
+
+    for ( int i = 0; i < 150; ++i )
+    {
+        Okular::PixmapRequest *r = queued.takeAt( qrand() % queued.count() );
+        QVERIFY( queue.remove( r ) );
+        delete r;
+    }
+    QCOMPARE( queue.count(), queued.count() );
+
+    int lastPriority = -1;
+    int lastPage = -1;
+    while ( !queue.isEmpty() )
+    {
+        Okular::PixmapRequest *r = queue.pop();
+        QVERIFY( r->priority() >= lastPriority );
+        // pages were pushed in order, so they come out in order within a
+        // priority, apart from priority 0 which is the other way round
+        if ( r->priority() == lastPriority )
+            QVERIFY( r->priority() == 0 ? r->pageNumber() < lastPage : r->pageNumber() > lastPage );
+        lastPriority = r->priority();
+        lastPage = r->pageNumber();
+        QVERIFY( queued.removeOne( r ) );
+        delete r;
+    }
+    QVERIFY( queued.isEmpty() );
+}
+
+QTEST_MAIN( PixmapRequestQueueTest )
+#include "pixmaprequestqueuetest.moc"
@@ -0,0 +1,176 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <QFile>
+#include <QImage>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+#include "../core/pixmapstore_p.h"
+
+class PixmapStoreTest
+    : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void initTestCase();
+        void testRoundTrip();
+        void testLoadImage();
+        void testSizeMismatch();
+        void testRemoveImage();
+        void testInvalidatedByModification();
+
+    private:
+        QString writeDocument( const QByteArray &contents );
+        QImage testImage( int width, int height ) const;
+
+        QTemporaryDir m_dir;
+};
+
+void PixmapStoreTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled( true );
+    QVERIFY( m_dir.isValid() );
+}
+
+QString PixmapStoreTest::writeDocument( const QByteArray &contents )
+{
+    const QString fileName = m_dir.path() + QStringLiteral( "/document.pdf" );
+    QFile file( fileName );
+    file.open( QIODevice::WriteOnly | QIODevice::Truncate );
+    file.write( contents );
+    file.close();
+    return fileName;
+}
+
+QImage PixmapStoreTest::testImage( int width, int height ) const
+{
+    QImage image( width, height, QImage::Format_RGB32 );
+    image.fill( Qt::white );
+    for ( int y = 0; y < height; y += 2 )
+        image.setPixel( y % width, y, qRgb( 255, 0, 0 ) );
+    return image;
+}
+
+void PixmapStoreTest::testRoundTrip()
+{
+    const QString fileName = writeDocument( "first" );
+    const QUrl url = QUrl::fromLocalFile( fileName );
+    const QImage image = testImage( 60, 80 );
+
+    Okular::PixmapStore store;
+    store.open( url, fileName, 5 );
+    QVERIFY( store.isOpen() );
+    store.setImage( 3, image );
+    // compressed or not yet, it is there right away
+    QCOMPARE( store.image( 3, 60, 80 ), image );
+    store.close();
+    QVERIFY( QFile::exists( Okular::PixmapStore::storeFileName( url, 5 ) ) );
+
+    store.open( url, fileName, 5 );
+    QCOMPARE( store.image( 3, 60, 80 ).convertToFormat( QImage::Format_RGB32 ), image );
+    QVERIFY( store.image( 2, 60, 80 ).isNull() );
+    store.close();
+}
+
+void PixmapStoreTest::testLoadImage()
+{
+    const QString fileName = writeDocument( "fifth" );
+    const QUrl url = QUrl::fromLocalFile( fileName );
+    const QImage image = testImage( 60, 80 );
+
+    Okular::PixmapStore store;
+    store.open( url, fileName, 5 );
+    store.setImage( 4, image );
+    store.close();
+
+    store.open( url, fileName, 5 );
+    QVERIFY( store.hasImage( 4, 60, 80 ) );
+    QVERIFY( !store.hasImage( 4, 61, 80 ) );
+    QVERIFY( !store.hasImage( 5, 60, 80 ) );
+
+    // read in the thread of the store, the missing one comes back null
+    QSignalSpy spy( &store, &Okular::PixmapStore::imagesLoaded );
+    store.loadImage( 4, 60, 80 );
+    store.loadImage( 5, 60, 80 );
+    QTRY_COMPARE( spy.count(), 2 );
+
+    const QList< Okular::PixmapStore::LoadedImage > loaded = store.takeLoadedImages();
+    QCOMPARE( loaded.count(), 2 );
+    QCOMPARE( loaded.at( 0 ).page, 4 );
+    QCOMPARE( loaded.at( 0 ).image, image );
+    QCOMPARE( loaded.at( 1 ).page, 5 );
+    QVERIFY( loaded.at( 1 ).image.isNull() );
+    QVERIFY( store.takeLoadedImages().isEmpty() );
+    store.close();
+}
+
+void PixmapStoreTest::testSizeMismatch()
+{
+    const QString fileName = writeDocument( "second" );
+    const QUrl url = QUrl::fromLocalFile( fileName );
+
+    Okular::PixmapStore store;
+    store.open( url, fileName, 6 );
+    store.setImage( 0, testImage( 60, 80 ) );
+    store.close();
+
+    store.open( url, fileName, 6 );
+    QVERIFY( store.image( 0, 61, 80 ).isNull() );
+    QVERIFY( !store.image( 0, 60, 80 ).isNull() );
+    store.close();
+}
+
+void PixmapStoreTest::testRemoveImage()
+{
+    const QString fileName = writeDocument( "third!" );
+    const QUrl url = QUrl::fromLocalFile( fileName );
+
+    Okular::PixmapStore store;
+    store.open( url, fileName, 6 );
+    store.setImage( 0, testImage( 20, 20 ) );
+    store.setImage( 1, testImage( 20, 20 ) );
+    store.close();
+
+    store.open( url, fileName, 6 );
+    store.removeImage( 0 );
+    store.close();
+
+    store.open( url, fileName, 6 );
+    QVERIFY( store.image( 0, 20, 20 ).isNull() );
+    QVERIFY( !store.image( 1, 20, 20 ).isNull() );
+    store.close();
+}
+
+void PixmapStoreTest::testInvalidatedByModification()
+{
+    const QString fileName = writeDocument( "fourth" );
+    const QUrl url = QUrl::fromLocalFile( fileName );
+
+    Okular::PixmapStore store;
+    store.open( url, fileName, 6 );
+    store.setImage( 0, testImage( 20, 20 ) );
+    store.close();
+
+    // same size, different modification time
+    QTest::qWait( 1100 );
+    writeDocument( "FOURTH" );
+
+    store.open( url, fileName, 6 );
+    QVERIFY( store.image( 0, 20, 20 ).isNull() );
+    store.close();
+    QVERIFY( !QFile::exists( Okular::PixmapStore::storeFileName( url, 6 ) ) );
+}
+
+QTEST_MAIN( PixmapStoreTest )
+#include "pixmapstoretest.moc"
@@ -0,0 +1,192 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <QDirIterator>
+#include <QLibrary>
+#include <QMimeDatabase>
+#include <QTemporaryDir>
+
+#include "../core/document.h"
+#include "../core/generator.h"
+#include "../core/observer.h"
+#include "../core/page.h"
+#include "../settings_core.h"
+
+class RenderBenchmarkObserver : public Okular::DocumentObserver
+{
+};
+
+/*
+ * Rendering throughput of the generators on the sample documents.
+ *
+ * Every benchmark renders a single page per iteration, so the results read
+ * as time per page; pages per second is their inverse. Run with -csv or
+ * -o <file>,xml for output that can be tracked across releases.
+ */
+class RenderBenchmark
+    : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void initTestCase();
+        void cleanupTestCase();
+        void cleanup();
+        void benchmarkRender_data();
+        void benchmarkRender();
+        void benchmarkRenderWithEviction_data();
+        void benchmarkRenderWithEviction();
+        void benchmarkTextPage_data();
+        void benchmarkTextPage();
+
+    private:
+        void addDocumentRows();
+        bool openDocument();
+
+        Okular::Document *m_document;
+        RenderBenchmarkObserver m_observer;
+        QTemporaryDir m_pluginDir;
+};
+
+void RenderBenchmark::initTestCase()
+{
+    // measure the generators we build just now and not the system ones: the
+    // Document looks for them in okular/generators under the library paths,
+    // so they are linked from such a directory put in front of the others,
+    // which still provide the image format plugins
+    QVERIFY2( QDir( QStringLiteral( GENERATORS_BUILD_DIR ) ).exists(), GENERATORS_BUILD_DIR );
+    QVERIFY( m_pluginDir.isValid() );
+    const QString generatorsDir = m_pluginDir.path() + QStringLiteral( "/okular/generators" );
+    QVERIFY( QDir().mkpath( generatorsDir ) );
+    int generators = 0;
+    QDirIterator it( QStringLiteral( GENERATORS_BUILD_DIR ), QDir::Files | QDir::Executable, QDirIterator::Subdirectories );
+    while ( it.hasNext() )
+    {
+        it.next();
+        if ( !QLibrary::isLibrary( it.fileName() ) || it.fileName().startsWith( QLatin1String( "kio_" ) ) )
+            continue;
+        const QString link = generatorsDir + QLatin1Char( '/' ) + it.fileName();
+        QVERIFY2( QFile::exists( link ) || QFile::link( it.fileInfo().absoluteFilePath(), link ), qPrintable( it.filePath() ) );
+        ++generators;
+    }
+    QVERIFY( generators > 0 );
+    QStringList libPaths = QCoreApplication::libraryPaths();
+    libPaths.prepend( m_pluginDir.path() );
+    QCoreApplication::setLibraryPaths( libPaths );
+
+    Okular::SettingsCore::instance( QStringLiteral("renderbenchmark") );
+    m_document = new Okular::Document( nullptr );
+    m_document->addObserver( &m_observer );
+}
+
+void RenderBenchmark::cleanupTestCase()
+{
+    m_document->removeObserver( &m_observer );
+    delete m_document;
+}
+
+void RenderBenchmark::cleanup()
+{
+    m_document->closeDocument();
+    Okular::SettingsCore::setMemoryLevel( Okular::SettingsCore::EnumMemoryLevel::Normal );
+}
+
+void RenderBenchmark::addDocumentRows()
+{
+    // one row per generator
+    QTest::addColumn<QString>( "fileName" );
+
+    QTest::newRow( "pdf" ) << QStringLiteral( KDESRCDIR "data/file1.pdf" );
+    QTest::newRow( "image" ) << QStringLiteral( KDESRCDIR "data/potato.jpg" );
+    QTest::newRow( "epub" ) << QStringLiteral( KDESRCDIR "data/contents.epub" );
+}
+
+bool RenderBenchmark::openDocument()
+{
+    QFETCH( QString, fileName );
+
+    QMimeDatabase db;
+    const QMimeType mime = db.mimeTypeForFile( fileName );
+    if ( m_document->openDocument( fileName, QUrl::fromLocalFile( fileName ), mime ) != Okular::Document::OpenSuccess )
+        return false;
+    return m_document->pages() > 0;
+}
+
+static Okular::PixmapRequest *renderRequest( Okular::DocumentObserver *observer, int page )
+{
+    // synchronous, so that the benchmark measures the whole rendering
+    return new Okular::PixmapRequest( observer, page, 600, 800, 1, Okular::PixmapRequest::NoFeature );
+}
+
+void RenderBenchmark::benchmarkRender_data()
+{
+    addDocumentRows();
+}
+
+void RenderBenchmark::benchmarkRender()
+{
+    if ( !openDocument() )
+        QSKIP( "The generator for this document is not available" );
+
+    Okular::Page *page = const_cast< Okular::Page * >( m_document->page( 0 ) );
+    QBENCHMARK {
+        page->deletePixmap( &m_observer );
+        m_document->requestPixmaps( QLinkedList< Okular::PixmapRequest * >() << renderRequest( &m_observer, 0 ) );
+    }
+    QVERIFY( page->hasPixmap( &m_observer ) );
+}
+
+void RenderBenchmark::benchmarkRenderWithEviction_data()
+{
+    addDocumentRows();
+}
+
+void RenderBenchmark::benchmarkRenderWithEviction()
+{
+    // with the low memory profile every new pixmap evicts the previous one,
+    // the difference to benchmarkRender is the cost of the eviction
+    Okular::SettingsCore::setMemoryLevel( Okular::SettingsCore::EnumMemoryLevel::Low );
+    if ( !openDocument() )
+        QSKIP( "The generator for this document is not available" );
+    if ( m_document->pages() < 2 )
+        QSKIP( "The document has a single page" );
+
+    int pageNumber = 0;
+    QBENCHMARK {
+        pageNumber = 1 - pageNumber;
+        m_document->requestPixmaps( QLinkedList< Okular::PixmapRequest * >() << renderRequest( &m_observer, pageNumber ) );
+    }
+    QVERIFY( !m_document->page( 1 - pageNumber )->hasPixmap( &m_observer ) );
+}
+
+void RenderBenchmark::benchmarkTextPage_data()
+{
+    addDocumentRows();
+}
+
+void RenderBenchmark::benchmarkTextPage()
+{
+    if ( !openDocument() )
+        QSKIP( "The generator for this document is not available" );
+    if ( !m_document->supportsSearching() )
+        QSKIP( "The generator for this document does not extract text" );
+
+    // building the TextPage includes the text layout analysis
+    Okular::Page *page = const_cast< Okular::Page * >( m_document->page( 0 ) );
+    QBENCHMARK {
+        page->setTextPage( nullptr );
+        m_document->requestTextPage( 0 );
+    }
+    QVERIFY( page->hasTextPage() );
+}
+
+QTEST_MAIN( RenderBenchmark )
+#include "renderbenchmark.moc"
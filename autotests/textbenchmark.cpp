@@ -0,0 +1,120 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include "../core/area.h"
+#include "../core/page.h"
+#include "../core/textpage.h"
+
+/*
+ * Cost of the text layout analysis and of searching in a TextPage, on
+ * synthetic pages of two columns of text so that the results don't depend
+ * on any generator. Run with -csv or -o <file>,xml for output that can be
+ * tracked across releases.
+ */
+class TextBenchmark
+    : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void benchmarkLayout_data();
+        void benchmarkLayout();
+        void benchmarkFindText_data();
+        void benchmarkFindText();
+};
+
+static const char * const s_words[] = {
+    "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit",
+    "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore", "et"
+};
+
+// Fills a page with @p lines lines of text per column
+static Okular::TextPage *createTextPage( int lines )
+{
+    Okular::TextPage *textPage = new Okular::TextPage();
+    const double lineHeight = 1.0 / ( lines + 2 );
+    const double charWidth = 0.45 / 80;
+    int wordIndex = 0;
+    for ( int column = 0; column < 2; ++column )
+    {
+        const double left = 0.03 + column * 0.5;
+        for ( int line = 0; line < lines; ++line )
+        {
+            const double top = ( line + 1 ) * lineHeight;
+            double x = left;
+            while ( true )
+            {
+                const QString word = QString::fromLatin1( s_words[ wordIndex++ % 16 ] );
+                const double width = word.length() * charWidth;
+                if ( x + width > left + 0.45 )
+                    break;
+                textPage->append( word, new Okular::NormalizedRect( x, top, x + width, top + lineHeight * 0.8 ) );
+                x += width;
+                textPage->append( QStringLiteral( " " ), new Okular::NormalizedRect( x, top, x + charWidth, top + lineHeight * 0.8 ) );
+                x += charWidth;
+            }
+        }
+    }
+    return textPage;
+}
+
+void TextBenchmark::benchmarkLayout_data()
+{
+    QTest::addColumn<int>( "lines" );
+
+    QTest::newRow( "50 lines" ) << 50;
+    QTest::newRow( "200 lines" ) << 200;
+}
+
+void TextBenchmark::benchmarkLayout()
+{
+    QFETCH( int, lines );
+
+    // Page::setTextPage() runs the layout analysis (correctTextOrder)
+    QBENCHMARK {
+        Okular::Page page( 0, 1000, 1000, Okular::Rotation0 );
+        page.setTextPage( createTextPage( lines ) );
+    }
+}
+
+void TextBenchmark::benchmarkFindText_data()
+{
+    QTest::addColumn<int>( "lines" );
+    QTest::addColumn<QString>( "searchString" );
+
+    QTest::newRow( "50 lines, word" ) << 50 << QStringLiteral( "incididunt" );
+    QTest::newRow( "200 lines, word" ) << 200 << QStringLiteral( "incididunt" );
+    QTest::newRow( "200 lines, missing" ) << 200 << QStringLiteral( "okular" );
+}
+
+void TextBenchmark::benchmarkFindText()
+{
+    QFETCH( int, lines );
+    QFETCH( QString, searchString );
+
+    Okular::Page page( 0, 1000, 1000, Okular::Rotation0 );
+    Okular::TextPage *textPage = createTextPage( lines );
+    page.setTextPage( textPage );
+
+    // walk through all the matches of the page, as "find next" does
+    QBENCHMARK {
+        Okular::RegularAreaRect *match = textPage->findText( 0, searchString, Okular::FromTop, Qt::CaseInsensitive, nullptr );
+        while ( match )
+        {
+            Okular::RegularAreaRect *next = textPage->findText( 0, searchString, Okular::NextResult, Qt::CaseInsensitive, match );
+            delete match;
+            match = next;
+        }
+    }
+}
+
+QTEST_MAIN( TextBenchmark )
+#include "textbenchmark.moc"
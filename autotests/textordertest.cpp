@@ -0,0 +1,166 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <algorithm>
+
+#include "../core/area.h"
+#include "../core/page.h"
+#include "../core/textpage.h"
+#include "../settings_core.h"
+
+class TextOrderTest : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void initTestCase();
+        void testSingleColumn();
+        void testTwoColumns();
+        void testOverlappingBoxes();
+};
+
+// the same words on every platform
+class Random
+{
+    public:
+        explicit Random( quint32 seed ) : m_state( seed ) {}
+
+        int bounded( int max )
+        {
+            m_state = m_state * 1103515245 + 12345;
+            return ( m_state >> 16 ) % max;
+        }
+
+    private:
+        quint32 m_state;
+};
+
+struct Word
+{
+    QString text;
+    Okular::NormalizedRect rect;
+};
+
+/**
+ * Lays out @p lineCount justified lines of words between @p left and
+ * @p right, and returns the text of the column in reading order.
+ */
+static QString column( double left, double right, int lineCount, Random &random, QList< Word > *words )
+{
+    // at least 8 pixels between the words
+    const double minSpace = 0.008;
+
+    QString text;
+    for ( int line = 0; line < lineCount; ++line )
+    {
+        const double top = 0.02 + line * 0.018;
+        QStringList lineWords;
+        double width = 0;
+        while ( true )
+        {
+            const int length = 2 + random.bounded( 7 );
+            if ( left + width + lineWords.count() * minSpace + length * 0.01 > right )
+                break;
+
+            QString word;
+            for ( int i = 0; i < length; ++i )
+                word += QChar( 'a' + random.bounded( 26 ) );
+            lineWords << word;
+            width += length * 0.01;
+        }
+
+        // the last word ends on the right of the column
+        const double space = ( right - left - width ) / ( lineWords.count() - 1 );
+        double x = left;
+        for ( const QString &word : qAsConst( lineWords ) )
+        {
+            const double wordWidth = word.length() * 0.01;
+            const Word entry = { word, Okular::NormalizedRect( x, top, x + wordWidth, top + 0.012 ) };
+            words->append( entry );
+            x += wordWidth + space;
+        }
+        text += lineWords.join( QLatin1Char( ' ' ) );
+    }
+    return text;
+}
+
+/**
+ * The words appended in a random order, as some generators do, and laid
+ * out as the page does it.
+ */
+static QString pageText( QList< Word > words, Random &random )
+{
+    for ( int i = words.count() - 1; i > 0; --i )
+        words.swap( i, random.bounded( i + 1 ) );
+
+    Okular::TextPage *textPage = new Okular::TextPage();
+    for ( const Word &word : qAsConst( words ) )
+        textPage->append( word.text, new Okular::NormalizedRect( word.rect ) );
+
+    // the page orders the text when it gets it, and deletes it
+    Okular::Page page( 0, 100, 100, Okular::Rotation0 );
+    page.setTextPage( textPage );
+    return textPage->text();
+}
+
+void TextOrderTest::initTestCase()
+{
+    Okular::SettingsCore::instance( QStringLiteral( "textordertest" ) );
+}
+
+void TextOrderTest::testSingleColumn()
+{
+    Random random( 1 );
+    QList< Word > words;
+    const QString text = column( 0.05, 0.95, 50, random, &words );
+
+    QCOMPARE( pageText( words, random ), text );
+}
+
+void TextOrderTest::testTwoColumns()
+{
+    Random random( 2 );
+    QList< Word > words;
+    QString text = column( 0.05, 0.45, 50, random, &words );
+    text += column( 0.55, 0.95, 50, random, &words );
+
+    // the left column first, then the right one
+    QCOMPARE( pageText( words, random ), text );
+}
+
+void TextOrderTest::testOverlappingBoxes()
+{
+    // boxes of any size anywhere, lines can't be told apart: no text is
+    // lost nor duplicated
+    Random random( 3 );
+    QList< Word > words;
+    QString letters;
+    for ( int i = 0; i < 400; ++i )
+    {
+        const double left = random.bounded( 900 ) / 1000.0;
+        const double top = random.bounded( 950 ) / 1000.0;
+        const double width = ( 5 + random.bounded( 95 ) ) / 1000.0;
+        const double height = ( 5 + random.bounded( 45 ) ) / 1000.0;
+        const QString word( QChar( 'a' + i % 26 ) );
+        const Word entry = { word, Okular::NormalizedRect( left, top, left + width, top + height ) };
+        words.append( entry );
+        letters += word;
+    }
+
+    QString text = pageText( words, random );
+    text.remove( QLatin1Char( ' ' ) );
+    std::sort( text.begin(), text.end() );
+    std::sort( letters.begin(), letters.end() );
+    QCOMPARE( text, letters );
+}
+
+QTEST_MAIN( TextOrderTest )
+#include "textordertest.moc"
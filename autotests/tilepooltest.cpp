@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <QPixmap>
+
+#include "../core/tilepool_p.h"
+#include "../core/tilesmanager_p.h"
+
+class TilePoolTest
+    : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void testSizeClass();
+        void testReuse();
+        void testIdleLimit();
+        void testNodes();
+};
+
+void TilePoolTest::testSizeClass()
+{
+    QCOMPARE( Okular::TilePool::sizeClass( 1 ), qulonglong( 4096 ) );
+    QCOMPARE( Okular::TilePool::sizeClass( 4096 ), qulonglong( 4096 ) );
+    QCOMPARE( Okular::TilePool::sizeClass( 4097 ), qulonglong( 5120 ) );
+    QCOMPARE( Okular::TilePool::sizeClass( 1000000 ), qulonglong( 1048576 ) );
+
+    for ( qulonglong bytes = 1000; bytes < 100000000; bytes = bytes * 3 / 2 + 7 )
+    {
+        const qulonglong size = Okular::TilePool::sizeClass( bytes );
+        QVERIFY( size >= bytes );
+        QVERIFY( size <= 4096 || ( size - bytes ) * 5 < size );
+    }
+}
+
+void TilePoolTest::testReuse()
+{
+    Okular::TilePool *pool = Okular::TilePool::instance();
+    pool->resetStatistics();
+
+    const uchar *bits;
+    {
+        QImage image = pool->image( 300, 200, QImage::Format_RGB32 );
+        QVERIFY( !image.isNull() );
+        QCOMPARE( image.bytesPerLine(), 1200 );
+        image.fill( Qt::red );
+        bits = image.constBits();
+    }
+    QCOMPARE( pool->misses(), 1 );
+    const qulonglong idleMemory = pool->idleMemory();
+    QVERIFY( idleMemory >= 300 * 200 * 4 );
+
+    // another image of the same size class gets the same buffer
+    {
+        const QImage image = pool->image( 1200, 200, QImage::Format_Grayscale8 );
+        QCOMPARE( image.constBits(), bits );
+        QCOMPARE( pool->hits(), 1 );
+        QCOMPARE( pool->idleMemory(), idleMemory - Okular::TilePool::sizeClass( 300 * 200 * 4 ) );
+    }
+
+    // copies share the buffer, it goes back when the last one is gone
+    QImage image = pool->image( 300, 200, QImage::Format_RGB32 );
+    QPixmap *pixmap = new QPixmap( QPixmap::fromImage( image, Qt::NoFormatConversion ) );
+    image = QImage();
+    QCOMPARE( pool->idleMemory(), idleMemory - Okular::TilePool::sizeClass( 300 * 200 * 4 ) );
+    delete pixmap;
+    QCOMPARE( pool->idleMemory(), idleMemory );
+
+    QVERIFY( pool->image( 0, 10, QImage::Format_RGB32 ).isNull() );
+}
+
+void TilePoolTest::testIdleLimit()
+{
+    Okular::TilePool *pool = Okular::TilePool::instance();
+    QList< QImage > images;
+    for ( int i = 0; i < 100; ++i )
+        images << pool->image( 512, 512, QImage::Format_RGB32 );
+    images.clear();
+
+    // not everything is kept for later
+    QVERIFY( pool->idleMemory() <= 64 * 1024 * 1024 );
+    QVERIFY( pool->idleMemory() >= 32 * 1024 * 1024 );
+}
+
+void TilePoolTest::testNodes()
+{
+    Okular::TilePool *pool = Okular::TilePool::instance();
+    const int nodesInUse = pool->nodesInUse();
+
+    Okular::TileNode *nodes = pool->allocateNodes();
+    Okular::TileNode *otherNodes = pool->allocateNodes();
+    QVERIFY( nodes != otherNodes );
+    QCOMPARE( pool->nodesInUse(), nodesInUse + 8 );
+    QVERIFY( pool->allocatedNodes() >= pool->nodesInUse() );
+
+    nodes[ 2 ].nTiles = 4;
+    nodes[ 2 ].dirty = false;
+    pool->releaseNodes( nodes );
+    QCOMPARE( pool->nodesInUse(), nodesInUse + 4 );
+
+    // the nodes are reused, as new
+    QCOMPARE( pool->allocateNodes(), nodes );
+    QCOMPARE( nodes[ 2 ].nTiles, 0 );
+    QVERIFY( nodes[ 2 ].dirty );
+    QVERIFY( !nodes[ 2 ].pixmap );
+
+    pool->releaseNodes( nodes );
+    pool->releaseNodes( otherNodes );
+    QCOMPARE( pool->nodesInUse(), nodesInUse );
+}
+
+QTEST_MAIN( TilePoolTest )
+#include "tilepooltest.moc"
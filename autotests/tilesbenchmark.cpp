@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <QPixmap>
+
+#include "../core/area.h"
+#include "../core/tile.h"
+#include "../core/tilesmanager_p.h"
+
+/*
+ * Cost of the tile bookkeeping done for every paint and every request of a
+ * zoomed in page. Run with -csv or -o <file>,xml for output that can be
+ * tracked across releases.
+ */
+class TilesBenchmark
+    : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void benchmarkTilesAt_data();
+        void benchmarkTilesAt();
+        void benchmarkSetPixmap();
+        void benchmarkSetPixmapAndCleanup();
+};
+
+// a page zoomed in enough to be tiled
+static const int s_pageSize = 3000;
+
+static void addRectRows()
+{
+    QTest::addColumn<QRectF>( "rect" );
+
+    QTest::newRow( "viewport" ) << QRectF( 0.3, 0.3, 0.25, 0.15 );
+    QTest::newRow( "whole page" ) << QRectF( 0, 0, 1, 1 );
+}
+
+void TilesBenchmark::benchmarkTilesAt_data()
+{
+    addRectRows();
+}
+
+void TilesBenchmark::benchmarkTilesAt()
+{
+    QFETCH( QRectF, rect );
+
+    const Okular::NormalizedRect normalizedRect( rect.left(), rect.top(), rect.right(), rect.bottom() );
+    Okular::TilesManager tilesManager( 0, s_pageSize, s_pageSize );
+    QBENCHMARK {
+        const QList<Okular::Tile> tiles = tilesManager.tilesAt( normalizedRect, Okular::TilesManager::TerminalTile );
+        Q_UNUSED( tiles )
+    }
+}
+
+void TilesBenchmark::benchmarkSetPixmap()
+{
+    Okular::TilesManager tilesManager( 0, s_pageSize, s_pageSize );
+    const QPixmap pixmap( s_pageSize, s_pageSize );
+    const Okular::NormalizedRect wholePage( 0, 0, 1, 1 );
+
+    QBENCHMARK {
+        tilesManager.setRequest( wholePage, s_pageSize, s_pageSize );
+        tilesManager.setPixmap( &pixmap, wholePage, false );
+    }
+    QVERIFY( tilesManager.hasPixmap( wholePage ) );
+}
+
+void TilesBenchmark::benchmarkSetPixmapAndCleanup()
+{
+    // the difference to benchmarkSetPixmap is the cost of evicting the tiles
+    // out of the viewport
+    Okular::TilesManager tilesManager( 0, s_pageSize, s_pageSize );
+    const QPixmap pixmap( s_pageSize, s_pageSize );
+    const Okular::NormalizedRect wholePage( 0, 0, 1, 1 );
+    const Okular::NormalizedRect viewport( 0.3, 0.3, 0.55, 0.45 );
+
+    QBENCHMARK {
+        tilesManager.setRequest( wholePage, s_pageSize, s_pageSize );
+        tilesManager.setPixmap( &pixmap, wholePage, false );
+        tilesManager.cleanupPixmapMemory( tilesManager.totalMemory(), viewport, 0 );
+    }
+    QVERIFY( tilesManager.hasPixmap( viewport ) );
+}
+
+QTEST_MAIN( TilesBenchmark )
+#include "tilesbenchmark.moc"
@@ -0,0 +1,261 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <QPainter>
+#include <QPixmap>
+
+#include "../core/area.h"
+#include "../core/tile.h"
+#include "../core/tilesmanager_p.h"
+#include "../core/utils_p.h"
+
+class TilesManagerTest
+    : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void testSetPixmap_data();
+        void testSetPixmap();
+        void testPartialPixmap();
+        void testTilePixmap();
+        void testSeveralRequests();
+        void testDevicePixelRatio();
+        void testRotatedTiles_data();
+        void testRotatedTiles();
+};
+
+// 250 pixels wide tiles, so the 8 bit tiles don't all start aligned
+static const int s_pageSize = 1000;
+
+static QImage patternImage( int width, int height, QImage::Format format )
+{
+    QImage image( width, height, QImage::Format_ARGB32_Premultiplied );
+    image.fill( Qt::white );
+    QPainter painter( &image );
+    for ( int i = 0; i < width; i += 37 )
+        painter.fillRect( i, 0, 5, height, QColor( i % 256, 0, 0 ) );
+    for ( int i = 0; i < height; i += 23 )
+        painter.fillRect( 0, i, width, 3, QColor( 0, i % 256, 0 ) );
+    painter.end();
+    return image.convertToFormat( format );
+}
+
+void TilesManagerTest::testSetPixmap_data()
+{
+    QTest::addColumn< int >( "format" );
+
+    QTest::newRow( "RGB32" ) << int( QImage::Format_RGB32 );
+    QTest::newRow( "ARGB32_Premultiplied" ) << int( QImage::Format_ARGB32_Premultiplied );
+    QTest::newRow( "Grayscale8" ) << int( QImage::Format_Grayscale8 );
+}
+
+void TilesManagerTest::testSetPixmap()
+{
+    QFETCH( int, format );
+
+    const QImage image = patternImage( s_pageSize, s_pageSize, QImage::Format( format ) );
+    const Okular::NormalizedRect wholePage( 0, 0, 1, 1 );
+    Okular::TilesManager tilesManager( 0, s_pageSize, s_pageSize );
+    {
+        // the tiles outlive the pixmap they come from
+        const QPixmap pixmap = Okular::pixmapFromImage( image );
+        tilesManager.setPixmap( &pixmap, wholePage, false );
+    }
+    QVERIFY( tilesManager.hasPixmap( wholePage ) );
+
+    const QList< Okular::Tile > tiles = tilesManager.tilesAt( wholePage, Okular::TilesManager::PixmapTile );
+    QCOMPARE( tiles.count(), 16 );
+    qulonglong memory = 0;
+    for ( const Okular::Tile &tile : tiles )
+    {
+        const QRect rect = tile.rect().geometry( s_pageSize, s_pageSize ) & image.rect();
+        const QImage tileImage = tile.pixmap()->toImage();
+        QCOMPARE( tileImage.format(), image.format() );
+        QCOMPARE( tileImage, image.copy( rect ) );
+        memory += Okular::pixmapMemory( tile.pixmap() );
+    }
+    QCOMPARE( tilesManager.totalMemory(), memory );
+}
+
+void TilesManagerTest::testPartialPixmap()
+{
+    // a pixmap for the right half of the page only
+    const Okular::NormalizedRect rightHalf( 0.5, 0, 1, 1 );
+    const QRect pixmapRect = rightHalf.geometry( s_pageSize, s_pageSize );
+    const QImage image = patternImage( pixmapRect.width(), pixmapRect.height(), QImage::Format_RGB32 );
+    Okular::TilesManager tilesManager( 0, s_pageSize, s_pageSize );
+    tilesManager.setRequest( rightHalf, s_pageSize, s_pageSize );
+    const QPixmap pixmap = Okular::pixmapFromImage( image );
+    tilesManager.setPixmap( &pixmap, rightHalf, false );
+
+    QVERIFY( tilesManager.hasPixmap( rightHalf ) );
+    QVERIFY( !tilesManager.hasPixmap( Okular::NormalizedRect( 0, 0, 0.25, 1 ) ) );
+
+    const QList< Okular::Tile > tiles = tilesManager.tilesAt( rightHalf, Okular::TilesManager::PixmapTile );
+    QCOMPARE( tiles.count(), 8 );
+    for ( const Okular::Tile &tile : tiles )
+    {
+        const QRect rect = tile.rect().geometry( s_pageSize, s_pageSize ).translated( -pixmapRect.topLeft() ) & image.rect();
+        QCOMPARE( tile.pixmap()->toImage(), image.copy( rect ) );
+    }
+}
+
+void TilesManagerTest::testTilePixmap()
+{
+    const Okular::NormalizedRect wholePage( 0, 0, 1, 1 );
+    const QImage pageImage = patternImage( s_pageSize, s_pageSize, QImage::Format_RGB32 );
+    Okular::TilesManager tilesManager( 0, s_pageSize, s_pageSize );
+    {
+        const QPixmap pixmap = Okular::pixmapFromImage( pageImage );
+        tilesManager.setPixmap( &pixmap, wholePage, false );
+    }
+
+    // a pixmap rendered for one tile only, as the tiles are requested
+    const QList< Okular::Tile > tiles = tilesManager.tilesAt( wholePage, Okular::TilesManager::TerminalTile );
+    const Okular::NormalizedRect tileRect = tiles.at( 5 ).rect();
+    const QRect tileGeometry = tileRect.geometry( s_pageSize, s_pageSize );
+    QImage tileImage( tileGeometry.size(), QImage::Format_RGB32 );
+    tileImage.fill( Qt::blue );
+    tilesManager.setRequest( tileRect, s_pageSize, s_pageSize );
+    const QPixmap pixmap = Okular::pixmapFromImage( tileImage );
+    tilesManager.setPixmap( &pixmap, tileRect, false );
+    QVERIFY( tilesManager.hasPixmap( wholePage ) );
+
+    // the neighbours sharing an edge with it keep their pixmap
+    for ( const Okular::Tile &tile : tilesManager.tilesAt( wholePage, Okular::TilesManager::PixmapTile ) )
+    {
+        QVERIFY( tile.isValid() );
+        if ( tile.rect() == tileRect )
+        {
+            QCOMPARE( tile.pixmap()->toImage(), tileImage );
+        }
+        else
+        {
+            const QRect rect = tile.rect().geometry( s_pageSize, s_pageSize ) & pageImage.rect();
+            QCOMPARE( tile.pixmap()->toImage(), pageImage.copy( rect ) );
+        }
+    }
+}
+
+void TilesManagerTest::testSeveralRequests()
+{
+    const Okular::NormalizedRect wholePage( 0, 0, 1, 1 );
+    const QImage pageImage = patternImage( s_pageSize, s_pageSize, QImage::Format_RGB32 );
+    Okular::TilesManager tilesManager( 0, s_pageSize, s_pageSize );
+    {
+        const QPixmap pixmap = Okular::pixmapFromImage( pageImage );
+        tilesManager.setPixmap( &pixmap, wholePage, false );
+    }
+
+    // tiles rendered in parallel, one of them cancelled
+    const QList< Okular::Tile > tiles = tilesManager.tilesAt( wholePage, Okular::TilesManager::TerminalTile );
+    QVector< Okular::NormalizedRect > rects;
+    for ( int i = 0; i < 4; ++i )
+    {
+        rects << tiles.at( i ).rect();
+        tilesManager.setRequest( rects.at( i ), s_pageSize, s_pageSize );
+    }
+    for ( const Okular::NormalizedRect &rect : qAsConst( rects ) )
+        QVERIFY( tilesManager.isRequesting( rect, s_pageSize, s_pageSize ) );
+
+    tilesManager.setPixmap( nullptr, rects.at( 1 ), true );
+    QVERIFY( !tilesManager.isRequesting( rects.at( 1 ), s_pageSize, s_pageSize ) );
+
+    // the pixmaps arrive in any order, the one of a tile not requested is late
+    QImage tileImage( rects.at( 0 ).geometry( s_pageSize, s_pageSize ).size(), QImage::Format_RGB32 );
+    tileImage.fill( Qt::blue );
+    const QPixmap pixmap = Okular::pixmapFromImage( tileImage );
+    tilesManager.setPixmap( &pixmap, rects.at( 2 ), false );
+    tilesManager.setPixmap( &pixmap, rects.at( 1 ), false );
+    tilesManager.setPixmap( &pixmap, rects.at( 0 ), false );
+    QVERIFY( !tilesManager.isRequesting( rects.at( 0 ), s_pageSize, s_pageSize ) );
+    QVERIFY( !tilesManager.isRequesting( rects.at( 2 ), s_pageSize, s_pageSize ) );
+    QVERIFY( tilesManager.isRequesting( rects.at( 3 ), s_pageSize, s_pageSize ) );
+
+    for ( const Okular::Tile &tile : tilesManager.tilesAt( wholePage, Okular::TilesManager::PixmapTile ) )
+    {
+        if ( tile.rect() == rects.at( 0 ) || tile.rect() == rects.at( 2 ) )
+        {
+            QCOMPARE( tile.pixmap()->toImage(), tileImage );
+        }
+        else if ( !( tile.rect() == rects.at( 1 ) ) )
+        {
+            const QRect rect = tile.rect().geometry( s_pageSize, s_pageSize ) & pageImage.rect();
+            QCOMPARE( tile.pixmap()->toImage(), pageImage.copy( rect ) );
+        }
+    }
+
+    // requests for another size of the page replace the previous ones
+    tilesManager.setRequest( rects.at( 0 ), 2 * s_pageSize, 2 * s_pageSize );
+    QVERIFY( !tilesManager.isRequesting( rects.at( 3 ), s_pageSize, s_pageSize ) );
+    QVERIFY( tilesManager.isRequesting( rects.at( 0 ), 2 * s_pageSize, 2 * s_pageSize ) );
+}
+
+void TilesManagerTest::testDevicePixelRatio()
+{
+    const Okular::NormalizedRect wholePage( 0, 0, 1, 1 );
+    Okular::TilesManager tilesManager( 0, s_pageSize, s_pageSize );
+    const QPixmap pixmap = Okular::pixmapFromImage( patternImage( s_pageSize, s_pageSize, QImage::Format_RGB32 ) );
+    tilesManager.setPixmap( &pixmap, wholePage, false );
+
+    // the page painter sets it on every tile it paints, the tiles keep
+    // sharing the pixels of the rendered image
+    for ( const Okular::Tile &tile : tilesManager.tilesAt( wholePage, Okular::TilesManager::PixmapTile ) )
+    {
+        const uchar *bits = tile.pixmap()->toImage().constBits();
+        tile.pixmap()->setDevicePixelRatio( 2 );
+        QCOMPARE( tile.pixmap()->toImage().constBits(), bits );
+    }
+}
+
+void TilesManagerTest::testRotatedTiles_data()
+{
+    QTest::addColumn< int >( "format" );
+    QTest::addColumn< int >( "rotation" );
+
+    QTest::newRow( "RGB32 90" ) << int( QImage::Format_RGB32 ) << int( Okular::Rotation90 );
+    QTest::newRow( "RGB32 180" ) << int( QImage::Format_RGB32 ) << int( Okular::Rotation180 );
+    QTest::newRow( "RGB32 270" ) << int( QImage::Format_RGB32 ) << int( Okular::Rotation270 );
+    QTest::newRow( "Grayscale8 90" ) << int( QImage::Format_Grayscale8 ) << int( Okular::Rotation90 );
+    QTest::newRow( "Grayscale8 270" ) << int( QImage::Format_Grayscale8 ) << int( Okular::Rotation270 );
+}
+
+void TilesManagerTest::testRotatedTiles()
+{
+    QFETCH( int, format );
+    QFETCH( int, rotation );
+
+    const Okular::NormalizedRect wholePage( 0, 0, 1, 1 );
+    const QImage image = patternImage( s_pageSize, s_pageSize, QImage::Format( format ) );
+    Okular::TilesManager tilesManager( 0, s_pageSize, s_pageSize );
+    const QPixmap pixmap = Okular::pixmapFromImage( image );
+    tilesManager.setPixmap( &pixmap, wholePage, false );
+
+    // the tiles are rotated when they are used
+    tilesManager.setRotation( Okular::Rotation( rotation ) );
+    const QList< Okular::Tile > tiles = tilesManager.tilesAt( wholePage, Okular::TilesManager::PixmapTile );
+    QCOMPARE( tiles.count(), 16 );
+    qulonglong memory = 0;
+    for ( const Okular::Tile &tile : tiles )
+    {
+        const Okular::NormalizedRect rect = Okular::TilesManager::fromRotatedRect( tile.rect(), Okular::Rotation( rotation ) );
+        const QImage expected = image.copy( rect.geometry( s_pageSize, s_pageSize ) & image.rect() ).transformed( QTransform().rotate( rotation * 90 ) );
+        const QImage tileImage = tile.pixmap()->toImage();
+        QCOMPARE( tileImage.format(), image.format() );
+        QCOMPARE( tileImage.convertToFormat( QImage::Format_ARGB32 ), expected.convertToFormat( QImage::Format_ARGB32 ) );
+        memory += Okular::pixmapMemory( tile.pixmap() );
+    }
+    QCOMPARE( tilesManager.totalMemory(), memory );
+}
+
+QTEST_MAIN( TilesManagerTest )
+#include "tilesmanagertest.moc"
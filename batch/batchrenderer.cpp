@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "batchrenderer.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QLinkedList>
+#include <QMimeDatabase>
+#include <QPainter>
+#include <QUrl>
+
+#include <stdio.h>
+
+#include "core/area.h"
+#include "core/document.h"
+#include "core/generator.h"
+#include "core/page.h"
+#include "ui/pagepainter.h"
+
+BatchRenderer::BatchRenderer( const Options &options )
+    : m_options( options ), m_document( new Okular::Document( nullptr ) ), m_out( stdout ), m_err( stderr )
+{
+    m_document->addObserver( this );
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    m_document->removeObserver( this );
+    delete m_document;
+}
+
+bool BatchRenderer::renderDocument( const QString &fileName )
+{
+    const QString filePath = QFileInfo( fileName ).absoluteFilePath();
+    QMimeDatabase db;
+    const QMimeType mime = db.mimeTypeForFile( filePath );
+
+    // with a url that is not local the docdata of the user (annotations,
+    // rotation, ...) don't end up in the images, nor are they rewritten
+    QUrl url;
+    url.setScheme( QStringLiteral( "okularbatch" ) );
+    url.setPath( filePath );
+    if ( m_document->openDocument( filePath, url, mime ) != Okular::Document::OpenSuccess )
+    {
+        m_err << fileName << ": can't open the document" << endl;
+        return false;
+    }
+
+    const int pageCount = m_document->pages();
+    const int firstPage = qMax( 1, m_options.firstPage );
+    const int lastPage = m_options.lastPage < 0 ? pageCount : qMin( m_options.lastPage, pageCount );
+    bool allWritten = true;
+    for ( int page = firstPage; page <= lastPage; ++page )
+    {
+        if ( !renderPage( fileName, page - 1 ) )
+            allWritten = false;
+    }
+
+    m_document->closeDocument();
+    return allWritten;
+}
+
+bool BatchRenderer::renderPage( const QString &fileName, int pageNumber )
+{
+    const Okular::Page *page = m_document->page( pageNumber );
+
+    // pages without a physical size (images, ...) are rendered at their own size
+    const QSizeF inches = m_document->pageSizeInInches( pageNumber );
+    const int width = qMax( 1, qRound( inches.isValid() ? inches.width() * m_options.dpi : page->width() ) );
+    const int height = qMax( 1, qRound( inches.isValid() ? inches.height() * m_options.dpi : page->height() ) );
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // synchronous, and for the whole page so that the document can switch
+    // to tiles for big pages; PagePainter puts them together again
+    const Okular::NormalizedRect wholePage( 0, 0, 1, 1 );
+    Okular::PixmapRequest *request = new Okular::PixmapRequest( this, pageNumber, width, height, 1, Okular::PixmapRequest::NoFeature );
+    request->setNormalizedRect( wholePage );
+    m_document->requestPixmaps( QLinkedList< Okular::PixmapRequest * >() << request );
+    if ( !page->hasPixmap( this, width, height, wholePage ) )
+    {
+        m_err << fileName << ": can't render page " << pageNumber + 1 << endl;
+        return false;
+    }
+
+    QImage image( width, height, QImage::Format_ARGB32_Premultiplied );
+    image.fill( Qt::white );
+    QPainter painter( &image );
+    PagePainter::paintPageOnPainter( &painter, page, this, PagePainter::Annotations, width, height, QRect( 0, 0, width, height ) );
+    painter.end();
+    const qint64 renderTime = timer.elapsed();
+
+    const QString outputName = QDir( m_options.outputDirectory ).filePath( outputBaseName( fileName ) + QLatin1Char( '-' ) + QString::number( pageNumber + 1 ) );
+    bool written = writeImage( image, outputName + ( m_options.format == Png ? QStringLiteral( ".png" ) : QStringLiteral( ".rgba" ) ) );
+
+    qint64 textTime = -1;
+    if ( m_options.extractText )
+    {
+        timer.restart();
+        if ( !page->hasTextPage() )
+            m_document->requestTextPage( pageNumber );
+        const QString text = page->text();
+        textTime = timer.elapsed();
+
+        QFile textFile( outputName + QStringLiteral( ".txt" ) );
+        if ( textFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+            written = textFile.write( text.toUtf8() ) >= 0 && written;
+        else
+            written = false;
+    }
+
+    if ( !written )
+        m_err << fileName << ": can't write page " << pageNumber + 1 << " to " << m_options.outputDirectory << endl;
+
+    // one line per page, written at once so that the lines of parallel
+    // jobs don't get mixed up
+    m_out << fileName << '\t' << pageNumber + 1 << '\t' << width << '\t' << height << '\t' << renderTime << '\t' << textTime << endl;
+    return written;
+}
+
+QString BatchRenderer::outputBaseName( const QString &fileName )
+{
+    return QFileInfo( fileName ).completeBaseName();
+}
+
+bool BatchRenderer::writeImage( const QImage &image, const QString &outputFileName ) const
+{
+    if ( m_options.format == Png )
+        return image.save( outputFileName, "PNG" );
+
+    // tightly packed RGBA rows, the size is in the timings line
+    const QImage rgba = image.convertToFormat( QImage::Format_RGBA8888 );
+    QFile file( outputFileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+        return false;
+    const int rowLength = rgba.width() * 4;
+    for ( int y = 0; y < rgba.height(); ++y )
+    {
+        if ( file.write( reinterpret_cast< const char * >( rgba.constScanLine( y ) ), rowLength ) != rowLength )
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef OKULAR_BATCHRENDERER_H
+#define OKULAR_BATCHRENDERER_H
+
+#include <QString>
+#include <QTextStream>
+
+class QImage;
+
+#include "core/observer.h"
+
+namespace Okular {
+class Document;
+}
+
+/**
+ * Renders the pages of documents to image files without any user interface,
+ * one document after the other, and writes a line of timings per page.
+ */
+class BatchRenderer : public Okular::DocumentObserver
+{
+    public:
+        enum ImageFormat
+        {
+            Png,
+            RawRgba
+        };
+
+        struct Options
+        {
+            Options() : dpi( 150 ), firstPage( 1 ), lastPage( -1 ), format( Png ), extractText( false ) {}
+
+            QString outputDirectory;
+            double dpi;
+            int firstPage;  ///< 1-based
+            int lastPage;   ///< 1-based, -1 for the last page of the document
+            ImageFormat format;
+            bool extractText;
+        };
+
+        explicit BatchRenderer( const Options &options );
+        ~BatchRenderer();
+
+        /**
+         * Renders the selected pages of @p fileName and returns whether
+         * the document could be opened and all of them were written.
+         */
+        bool renderDocument( const QString &fileName );
+
+        /**
+         * The name the files written for the pages of @p fileName start with.
+         */
+        static QString outputBaseName( const QString &fileName );
+
+    private:
+        bool renderPage( const QString &fileName, int pageNumber );
+        bool writeImage( const QImage &image, const QString &outputFileName ) const;
+
+        Options m_options;
+        Okular::Document *m_document;
+        QTextStream m_out;
+        QTextStream m_err;
+};
+
+#endif
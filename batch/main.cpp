@@ -0,0 +1,175 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <KLocalizedString>
+#include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QHash>
+#include <QProcess>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+
+#include <stdio.h>
+
+#include "batchrenderer.h"
+#include "settings.h"
+
+// Splits the files between @p jobs copies of this program, each of them
+// renders its share with a single job; returns whether all of them succeeded
+static bool runWorkers( const QStringList &files, const QStringList &arguments, int jobs )
+{
+    QVector< QStringList > shares( qMin( jobs, files.count() ) );
+    for ( int i = 0; i < files.count(); ++i )
+        shares[ i % shares.count() ] << files.at( i );
+
+    QList< QProcess * > workers;
+    foreach ( const QStringList &share, shares )
+    {
+        QProcess *worker = new QProcess();
+        // the lines of timings of all the workers go to our stdout
+        worker->setProcessChannelMode( QProcess::ForwardedChannels );
+        worker->start( QCoreApplication::applicationFilePath(), QStringList() << arguments << QStringLiteral( "--jobs" ) << QStringLiteral( "1" ) << QStringLiteral( "--" ) << share );
+        workers << worker;
+    }
+
+    bool success = true;
+    foreach ( QProcess *worker, workers )
+    {
+        if ( !worker->waitForFinished( -1 ) || worker->exitStatus() != QProcess::NormalExit || worker->exitCode() != 0 )
+            success = false;
+        delete worker;
+    }
+    return success;
+}
+
+// The images are named after the documents: returns whether no two of
+// @p files would write to the same images, and reports the ones that would
+static bool checkOutputNames( const QStringList &files, QTextStream &err )
+{
+    bool unique = true;
+    QHash< QString, QString > fileOfName;
+    foreach ( const QString &file, files )
+    {
+        // case insensitive file systems would mix up the images too
+        const QString name = BatchRenderer::outputBaseName( file ).toCaseFolded();
+        const QHash< QString, QString >::const_iterator it = fileOfName.constFind( name );
+        if ( it != fileOfName.constEnd() )
+        {
+            err << i18n( "%1 and %2 would be written to the same images, rename one of them or render them separately", it.value(), file ) << endl;
+            unique = false;
+            continue;
+        }
+        fileOfName.insert( name, file );
+    }
+    return unique;
+}
+
+int main( int argc, char **argv )
+{
+    // no windows are ever shown
+    if ( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+        qputenv( "QT_QPA_PLATFORM", "offscreen" );
+
+    QApplication app( argc, argv );
+    KLocalizedString::setApplicationDomain( "okular" );
+    QCoreApplication::setApplicationName( QStringLiteral( "okularbatch" ) );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( i18n( "Renders the pages of documents to images without user interface.\n"
+                                            "For every page a line with the file name, the page number, the width and the height of the image, "
+                                            "the rendering time and the text extraction time in milliseconds, separated by tabs, is written to the standard output." ) );
+    parser.addHelpOption();
+
+    const QCommandLineOption outputOption( QStringList() << QStringLiteral( "o" ) << QStringLiteral( "output" ), i18n( "Directory the images are written to" ), QStringLiteral( "directory" ), QStringLiteral( "." ) );
+    const QCommandLineOption dpiOption( QStringList() << QStringLiteral( "r" ) << QStringLiteral( "dpi" ), i18n( "Resolution of the images" ), QStringLiteral( "dpi" ), QStringLiteral( "150" ) );
+    const QCommandLineOption firstOption( QStringList() << QStringLiteral( "f" ) << QStringLiteral( "first" ), i18n( "First page to render" ), QStringLiteral( "number" ), QStringLiteral( "1" ) );
+    const QCommandLineOption lastOption( QStringList() << QStringLiteral( "l" ) << QStringLiteral( "last" ), i18n( "Last page to render" ), QStringLiteral( "number" ) );
+    const QCommandLineOption formatOption( QStringList() << QStringLiteral( "format" ), i18n( "Format of the images: png, or rgba for raw RGBA rows" ), QStringLiteral( "format" ), QStringLiteral( "png" ) );
+    const QCommandLineOption textOption( QStringList() << QStringLiteral( "t" ) << QStringLiteral( "text" ), i18n( "Also write the text of the pages" ) );
+    const QCommandLineOption jobsOption( QStringList() << QStringLiteral( "j" ) << QStringLiteral( "jobs" ), i18n( "Number of documents rendered at the same time" ), QStringLiteral( "number" ), QString::number( QThread::idealThreadCount() ) );
+    parser.addOption( outputOption );
+    parser.addOption( dpiOption );
+    parser.addOption( firstOption );
+    parser.addOption( lastOption );
+    parser.addOption( formatOption );
+    parser.addOption( textOption );
+    parser.addOption( jobsOption );
+    parser.addPositionalArgument( QStringLiteral( "files" ), i18n( "Documents to render" ), QStringLiteral( "files..." ) );
+    parser.process( app );
+
+    QTextStream err( stderr );
+    const QStringList files = parser.positionalArguments();
+    if ( files.isEmpty() )
+    {
+        err << i18n( "No documents to render" ) << endl;
+        return 1;
+    }
+    if ( !checkOutputNames( files, err ) )
+        return 1;
+
+    BatchRenderer::Options options;
+    options.outputDirectory = parser.value( outputOption );
+    options.dpi = parser.value( dpiOption ).toDouble();
+    options.firstPage = parser.value( firstOption ).toInt();
+    if ( parser.isSet( lastOption ) )
+        options.lastPage = parser.value( lastOption ).toInt();
+    options.extractText = parser.isSet( textOption );
+    const QString format = parser.value( formatOption );
+    if ( format == QLatin1String( "rgba" ) )
+        options.format = BatchRenderer::RawRgba;
+    else if ( format != QLatin1String( "png" ) )
+    {
+        err << i18n( "Unknown image format %1", format ) << endl;
+        return 1;
+    }
+    if ( options.dpi <= 0 )
+    {
+        err << i18n( "Invalid resolution %1", parser.value( dpiOption ) ) << endl;
+        return 1;
+    }
+    if ( !QDir().mkpath( options.outputDirectory ) )
+    {
+        err << i18n( "Can't create the directory %1", options.outputDirectory ) << endl;
+        return 1;
+    }
+
+    // a Document and its generators are not meant to be used from several
+    // threads, so the documents are spread over processes instead
+    const int jobs = parser.value( jobsOption ).toInt();
+    if ( jobs > 1 && files.count() > 1 )
+    {
+        QStringList arguments;
+        arguments << QStringLiteral( "--output" ) << options.outputDirectory
+                  << QStringLiteral( "--dpi" ) << parser.value( dpiOption )
+                  << QStringLiteral( "--first" ) << parser.value( firstOption )
+                  << QStringLiteral( "--format" ) << format;
+        if ( parser.isSet( lastOption ) )
+            arguments << QStringLiteral( "--last" ) << parser.value( lastOption );
+        if ( options.extractText )
+            arguments << QStringLiteral( "--text" );
+        return runWorkers( files, arguments, jobs ) ? 0 : 1;
+    }
+
+    // own settings, not the ones of the user; with the low memory profile
+    // the pixmaps of a page are dropped as soon as the next one is rendered
+    Okular::Settings::instance( QStringLiteral( "okularbatchrc" ) );
+    Okular::Settings::setMemoryLevel( Okular::Settings::EnumMemoryLevel::Low );
+
+    BatchRenderer renderer( options );
+    bool success = true;
+    foreach ( const QString &file, files )
+    {
+        if ( !renderer.renderDocument( file ) )
+            success = false;
+    }
+    return success ? 0 : 1;
+}
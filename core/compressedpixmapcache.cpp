@@ -0,0 +1,433 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "compressedpixmapcache_p.h"
+
+// qt/kde includes
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThread>
+
+#include <zlib.h>
+
+// local includes
+#include "debug_p.h"
+
+using namespace Okular;
+
+// the images waiting for the compression, they were pixmaps in memory
+// anyway until just before
+static const qulonglong s_maxPendingMemory = 256 * 1024 * 1024;
+
+class CompressedPixmapCache::CompressionThread : public QThread
+{
+    public:
+        explicit CompressionThread( CompressedPixmapCache *cache )
+            : m_cache( cache )
+        {
+        }
+
+    protected:
+        void run() override
+        {
+            m_cache->run();
+        }
+
+    private:
+        CompressedPixmapCache *m_cache;
+};
+
+namespace Okular {
+
+uint qHash( const CompressedPixmapCache::Key &key, uint seed )
+{
+    return ::qHash( key.observer, seed ) ^ ::qHash( key.page, seed );
+}
+
+}
+
+CompressedPixmapCache::CompressedPixmapCache()
+    : m_thread( nullptr ), m_stopping( false ), m_nextId( 0 ), m_useCounter( 0 ),
+      m_memoryLimit( 0 ), m_diskLimit( 0 ), m_memory( 0 ), m_pendingMemory( 0 ), m_diskMemory( 0 ),
+      m_diskDirectory( nullptr )
+{
+}
+
+CompressedPixmapCache::~CompressedPixmapCache()
+{
+    if ( m_thread )
+    {
+        m_mutex.lock();
+        m_stopping = true;
+        m_wakeUp.wakeAll();
+        m_mutex.unlock();
+        m_thread->wait();
+        delete m_thread;
+    }
+
+    clear();
+    // removes the files left, if any
+    delete m_diskDirectory;
+}
+
+void CompressedPixmapCache::setLimits( qulonglong memoryLimit, qulonglong diskLimit )
+{
+    QMutexLocker locker( &m_mutex );
+    m_memoryLimit = memoryLimit;
+    m_diskLimit = diskLimit;
+
+    // no disk writing here, the new limits are only smaller than the old
+    // ones when the user changes them
+    enforceLimits();
+}
+
+void CompressedPixmapCache::insert( DocumentObserver *observer, int page, const QImage &image )
+{
+    // only the pixels are kept, not a color table
+    if ( image.isNull() || image.colorCount() > 0 )
+        return;
+
+    QMutexLocker locker( &m_mutex );
+    if ( m_memoryLimit == 0 )
+        return;
+
+    const Key key = { observer, page };
+    QHash< Key, Entry >::iterator it = m_entries.find( key );
+    if ( it != m_entries.end() )
+    {
+        // the pixmap came from here and didn't change since
+        if ( it->width == image.width() && it->height == image.height() )
+        {
+            touch( it );
+            return;
+        }
+        removeEntry( it );
+    }
+
+    const qulonglong imageMemory = image.byteCount();
+    if ( m_pendingMemory + imageMemory > s_maxPendingMemory )
+    {
+        qCDebug(OkularCoreDebug).nospace() << "Not keeping the pixmap of page " << page << ", the compression is behind";
+        return;
+    }
+
+    Entry entry;
+    entry.id = ++m_nextId;
+    entry.lastUse = ++m_useCounter;
+    entry.width = image.width();
+    entry.height = image.height();
+    entry.bytesPerLine = image.bytesPerLine();
+    entry.format = image.format();
+    entry.image = image;
+    m_entries.insert( key, entry );
+    m_pendingMemory += imageMemory;
+    m_pending.enqueue( qMakePair( key, entry.id ) );
+
+    if ( !m_thread )
+    {
+        m_thread = new CompressionThread( this );
+        m_thread->start( QThread::LowPriority );
+    }
+    m_wakeUp.wakeOne();
+}
+
+QImage CompressedPixmapCache::image( DocumentObserver *observer, int page, int width, int height )
+{
+    QMutexLocker locker( &m_mutex );
+    const Key key = { observer, page };
+    QHash< Key, Entry >::iterator it = m_entries.find( key );
+    if ( it == m_entries.end() || it->width != width || it->height != height )
+        return QImage();
+
+    touch( it );
+    if ( !it->image.isNull() )
+        return it->image;
+
+    // a copy, the entry may be dropped as soon as the lock is released
+    const Entry entry = *it;
+    locker.unlock();
+
+    QByteArray data = entry.data;
+    if ( data.isEmpty() )
+    {
+        QFile file( entry.fileName );
+        if ( file.open( QIODevice::ReadOnly ) )
+            data = file.readAll();
+    }
+
+    return decompress( data, entry );
+}
+
+void CompressedPixmapCache::removePage( int page )
+{
+    QMutexLocker locker( &m_mutex );
+    QHash< Key, Entry >::iterator it = m_entries.begin();
+    while ( it != m_entries.end() )
+    {
+        if ( it.key().page == page )
+            it = removeEntry( it );
+        else
+            ++it;
+    }
+}
+
+void CompressedPixmapCache::removeObserver( DocumentObserver *observer )
+{
+    QMutexLocker locker( &m_mutex );
+    QHash< Key, Entry >::iterator it = m_entries.begin();
+    while ( it != m_entries.end() )
+    {
+        if ( it.key().observer == observer )
+            it = removeEntry( it );
+        else
+            ++it;
+    }
+}
+
+void CompressedPixmapCache::clear()
+{
+    QMutexLocker locker( &m_mutex );
+    while ( !m_entries.isEmpty() )
+        removeEntry( m_entries.begin() );
+    m_pending.clear();
+}
+
+int CompressedPixmapCache::count() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_entries.count();
+}
+
+qulonglong CompressedPixmapCache::memory() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_memory + m_pendingMemory;
+}
+
+qulonglong CompressedPixmapCache::diskMemory() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_diskMemory;
+}
+
+QByteArray CompressedPixmapCache::compress( const QImage &image )
+{
+    // the fastest zlib level: rendered pages have long runs of the same
+    // color, it already takes them to a fraction of their size
+    const uLong sourceLength = image.byteCount();
+    uLongf length = compressBound( sourceLength );
+    QByteArray data( length, Qt::Uninitialized );
+    if ( ::compress2( reinterpret_cast< Bytef * >( data.data() ), &length, image.constBits(), sourceLength, Z_BEST_SPEED ) != Z_OK )
+        return QByteArray();
+
+    data.resize( length );
+    data.squeeze();
+    return data;
+}
+
+QImage CompressedPixmapCache::decompress( const QByteArray &data, const Entry &entry )
+{
+    if ( data.isEmpty() )
+        return QImage();
+
+    // straight into the pixels of the new image
+    QImage image( entry.width, entry.height, entry.format );
+    if ( image.isNull() || image.bytesPerLine() != entry.bytesPerLine )
+        return QImage();
+
+    uLongf length = image.byteCount();
+    if ( ::uncompress( image.bits(), &length, reinterpret_cast< const Bytef * >( data.constData() ), data.size() ) != Z_OK
+         || length != uLongf( image.byteCount() ) )
+        return QImage();
+
+    return image;
+}
+
+void CompressedPixmapCache::run()
+{
+    QMutexLocker locker( &m_mutex );
+    while ( true )
+    {
+        while ( m_pending.isEmpty() && m_obsoleteFiles.isEmpty() && !m_stopping )
+            m_wakeUp.wait( &m_mutex );
+        if ( m_stopping )
+            return;
+
+        removeObsoleteFiles( locker );
+        if ( m_pending.isEmpty() )
+            continue;
+
+        const QPair< Key, quint64 > job = m_pending.dequeue();
+        QHash< Key, Entry >::iterator it = m_entries.find( job.first );
+        // removed or replaced while waiting
+        if ( it == m_entries.end() || it->id != job.second || it->image.isNull() )
+            continue;
+
+        const QImage image = it->image;
+        locker.unlock();
+        const QByteArray data = compress( image );
+        locker.relock();
+
+        it = m_entries.find( job.first );
+        if ( it == m_entries.end() || it->id != job.second )
+            continue;
+
+        if ( data.isEmpty() )
+        {
+            removeEntry( it );
+            continue;
+        }
+
+        m_pendingMemory -= image.byteCount();
+        it->image = QImage();
+        it->data = data;
+        m_memory += data.size();
+        m_memoryLru.insert( it->lastUse, job.first );
+
+        moveToDisk( locker );
+        enforceLimits();
+    }
+}
+
+QHash< CompressedPixmapCache::Key, CompressedPixmapCache::Entry >::iterator CompressedPixmapCache::removeEntry( QHash< Key, Entry >::iterator it )
+{
+    if ( !it->image.isNull() )
+        m_pendingMemory -= it->image.byteCount();
+    if ( !it->data.isEmpty() )
+    {
+        m_memory -= it->data.size();
+        m_memoryLru.remove( it->lastUse );
+    }
+    if ( !it->fileName.isEmpty() )
+    {
+        m_diskMemory -= it->diskSize;
+        m_diskLru.remove( it->lastUse );
+        m_obsoleteFiles.append( it->fileName );
+        m_wakeUp.wakeOne();
+    }
+    return m_entries.erase( it );
+}
+
+void CompressedPixmapCache::touch( QHash< Key, Entry >::iterator it )
+{
+    const quint64 lastUse = ++m_useCounter;
+    if ( !it->data.isEmpty() )
+    {
+        m_memoryLru.remove( it->lastUse );
+        m_memoryLru.insert( lastUse, it.key() );
+    }
+    else if ( !it->fileName.isEmpty() )
+    {
+        m_diskLru.remove( it->lastUse );
+        m_diskLru.insert( lastUse, it.key() );
+    }
+    it->lastUse = lastUse;
+}
+
+void CompressedPixmapCache::enforceLimits()
+{
+    // the least recently used images that don't fit go away
+    while ( m_memory > m_memoryLimit && !m_memoryLru.isEmpty() )
+        removeEntry( m_entries.find( m_memoryLru.first() ) );
+
+    while ( m_diskMemory > m_diskLimit && !m_diskLru.isEmpty() )
+        removeEntry( m_entries.find( m_diskLru.first() ) );
+
+    // nothing can be kept, so nothing can be waiting either
+    if ( m_memoryLimit == 0 )
+    {
+        while ( !m_entries.isEmpty() )
+            removeEntry( m_entries.begin() );
+        m_pending.clear();
+    }
+}
+
+void CompressedPixmapCache::moveToDisk( QMutexLocker &locker )
+{
+    // the least recently used compressed images go to disk, or away when
+    // they don't fit there
+    while ( m_memory > m_memoryLimit && !m_memoryLru.isEmpty() && !m_stopping )
+    {
+        const Key key = m_memoryLru.first();
+        QHash< Key, Entry >::iterator it = m_entries.find( key );
+        if ( qulonglong( it->data.size() ) > m_diskLimit )
+        {
+            removeEntry( it );
+            continue;
+        }
+
+        const quint64 id = it->id;
+        const QByteArray data = it->data;
+        locker.unlock();
+        const QString fileName = writeToDisk( id, data );
+        locker.relock();
+
+        // it may have been used, replaced or dropped meanwhile
+        it = m_entries.find( key );
+        const bool unchanged = it != m_entries.end() && it->id == id && !it->data.isEmpty();
+        if ( fileName.isEmpty() )
+        {
+            if ( unchanged )
+                removeEntry( it );
+            continue;
+        }
+        if ( !unchanged )
+        {
+            m_obsoleteFiles.append( fileName );
+            continue;
+        }
+
+        m_memoryLru.remove( it->lastUse );
+        m_memory -= it->data.size();
+        it->data = QByteArray();
+        it->fileName = fileName;
+        it->diskSize = data.size();
+        m_diskMemory += it->diskSize;
+        m_diskLru.insert( it->lastUse, key );
+    }
+}
+
+QString CompressedPixmapCache::writeToDisk( quint64 id, const QByteArray &data )
+{
+    // only the thread gets here, the directory is not shared
+    if ( !m_diskDirectory )
+    {
+        const QString parent = QStandardPaths::writableLocation( QStandardPaths::GenericCacheLocation ) + QStringLiteral( "/okular" );
+        QDir().mkpath( parent );
+        m_diskDirectory = new QTemporaryDir( parent + QStringLiteral( "/pixmaps-XXXXXX" ) );
+        if ( !m_diskDirectory->isValid() )
+            qCWarning(OkularCoreDebug) << "Failed to create the directory for the compressed pixmaps in" << parent;
+    }
+    if ( !m_diskDirectory->isValid() )
+        return QString();
+
+    const QString fileName = m_diskDirectory->path() + QLatin1Char( '/' ) + QString::number( id );
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) || file.write( data ) != data.size() )
+    {
+        file.remove();
+        return QString();
+    }
+    return fileName;
+}
+
+void CompressedPixmapCache::removeObsoleteFiles( QMutexLocker &locker )
+{
+    if ( m_obsoleteFiles.isEmpty() )
+        return;
+
+    QStringList fileNames;
+    fileNames.swap( m_obsoleteFiles );
+    locker.unlock();
+    foreach ( const QString &fileName, fileNames )
+        QFile::remove( fileName );
+    locker.relock();
+}
@@ -0,0 +1,160 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_COMPRESSEDPIXMAPCACHE_P_H_
+#define _OKULAR_COMPRESSEDPIXMAPCACHE_P_H_
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QQueue>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QWaitCondition>
+#include <QtGui/QImage>
+
+class QTemporaryDir;
+
+namespace Okular {
+
+class DocumentObserver;
+
+/* Second level of the pixmap cache: the pixmaps evicted from memory are
+ * kept compressed, so that going back to their page costs a decompression
+ * instead of a new rendering.
+ *
+ * The compression runs in a thread of its own. The compressed images live
+ * in a pool of bounded size; when it is full the least recently used ones
+ * are moved to files in a temporary directory, as long as they fit in the
+ * disk budget, or dropped. There is one image per observer and page, the
+ * one of the size last evicted.
+ *
+ * The files are only written, read and removed without holding the lock. */
+class CompressedPixmapCache
+{
+    public:
+        CompressedPixmapCache();
+        ~CompressedPixmapCache();
+
+        /**
+         * Sets the bytes the compressed images may take in memory and on
+         * disk. With no memory nothing is kept, with no disk nothing is
+         * moved there.
+         */
+        void setLimits( qulonglong memoryLimit, qulonglong diskLimit );
+
+        /**
+         * Queues @p image, the pixmap of @p page for @p observer, for
+         * compression. It replaces the one kept before for the page.
+         */
+        void insert( DocumentObserver *observer, int page, const QImage &image );
+
+        /**
+         * Returns the kept image of @p page for @p observer if it is
+         * @p width x @p height, or a null image.
+         */
+        QImage image( DocumentObserver *observer, int page, int width, int height );
+
+        /**
+         * Forgets the images of @p page.
+         */
+        void removePage( int page );
+
+        /**
+         * Forgets the images of @p observer.
+         */
+        void removeObserver( DocumentObserver *observer );
+
+        /**
+         * Forgets all the images.
+         */
+        void clear();
+
+        /**
+         * The number of images kept, and the bytes they take in memory
+         * (counting the ones not compressed yet) and on disk.
+         */
+        int count() const;
+        qulonglong memory() const;
+        qulonglong diskMemory() const;
+
+    private:
+        class CompressionThread;
+        friend class CompressionThread;
+
+        struct Key
+        {
+            DocumentObserver *observer;
+            int page;
+
+            bool operator==( const Key &other ) const { return observer == other.observer && page == other.page; }
+        };
+        friend uint qHash( const Key &key, uint seed );
+
+        struct Entry
+        {
+            Entry() : id( 0 ), lastUse( 0 ), width( 0 ), height( 0 ), bytesPerLine( 0 ), format( QImage::Format_Invalid ), diskSize( 0 ) {}
+
+            quint64 id;
+            quint64 lastUse;
+            int width;
+            int height;
+            int bytesPerLine;
+            QImage::Format format;
+            // waiting for the compression
+            QImage image;
+            // compressed, in memory
+            QByteArray data;
+            // compressed, on disk
+            QString fileName;
+            qint64 diskSize;
+        };
+
+        static QByteArray compress( const QImage &image );
+        static QImage decompress( const QByteArray &data, const Entry &entry );
+
+        void run();
+        QHash< Key, Entry >::iterator removeEntry( QHash< Key, Entry >::iterator it );
+        void touch( QHash< Key, Entry >::iterator it );
+        void enforceLimits();
+        void moveToDisk( QMutexLocker &locker );
+        QString writeToDisk( quint64 id, const QByteArray &data );
+        void removeObsoleteFiles( QMutexLocker &locker );
+
+        mutable QMutex m_mutex;
+        QWaitCondition m_wakeUp;
+        CompressionThread *m_thread;
+        bool m_stopping;
+
+        QHash< Key, Entry > m_entries;
+        QQueue< QPair< Key, quint64 > > m_pending;
+        // the compressed images in memory and on disk by their last use,
+        // the least recently used first
+        QMap< quint64, Key > m_memoryLru;
+        QMap< quint64, Key > m_diskLru;
+        // of the images dropped, for the thread to remove
+        QStringList m_obsoleteFiles;
+        quint64 m_nextId;
+        quint64 m_useCounter;
+
+        qulonglong m_memoryLimit;
+        qulonglong m_diskLimit;
+        // compressed images in memory, images waiting for the compression
+        // and compressed images on disk
+        qulonglong m_memory;
+        qulonglong m_pendingMemory;
+        qulonglong m_diskMemory;
+        QTemporaryDir *m_diskDirectory;
+};
+
+}
+
+#endif
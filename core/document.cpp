@@ -29,16 +29,21 @@
 // qt/kde/system includes
 #include <QtCore/QtAlgorithms>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QMap>
+#include <QtCore/QSaveFile>
 #include <QtCore/qtemporaryfile.h>
 #include <QtCore/QTextStream>
 #include <QtCore/QTimer>
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QXmlStreamWriter>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QLabel>
 #include <QtPrintSupport/QPrinter>
 #include <QtPrintSupport/QPrintDialog>
+#include <QScopedPointer>
 #include <QStack>
 #include <QUndoCommand>
 #include <QMimeDatabase>
@@ -87,6 +92,7 @@
 #include "sourcereference_p.h"
 #include "texteditors_p.h"
 #include "tile.h"
+#include "tilepool_p.h"
 #include "tilesmanager_p.h"
 #include "utils_p.h"
 #include "view.h"
@@ -125,6 +131,27 @@ struct ArchiveData
     QTemporaryFile metadataFile;
 };
 
+struct ReloadData
+{
+    ReloadData()
+    {
+    }
+
+    ~ReloadData()
+    {
+        qDeleteAll( pages );
+        qDeleteAll( allocatedPixmaps );
+    }
+
+    QString generatorName;
+    QString docFileName;
+    QVariantList fingerprints;
+    // holders of the rendered contents, null for the pages that can't be reused
+    QVector< Page * > pages;
+    QLinkedList< AllocatedPixmap * > allocatedPixmaps;
+    QList< int > textPages;
+};
+
 struct RunningSearch
 {
     // store search properties
@@ -186,27 +213,30 @@ QString DocumentPrivate::namePaperSize(double inchesWidth, double inchesHeight)
     }
 }
 
-QString DocumentPrivate::localizedSize(const QSizeF &size) const
+QSizeF DocumentPrivate::sizeInInches(const QSizeF &size) const
 {
-    double inchesWidth = 0, inchesHeight = 0;
     switch (m_generator->pagesSizeMetric())
     {
         case Generator::Points:
-            inchesWidth = size.width() / 72.0;
-            inchesHeight = size.height() / 72.0;
-        break;
+            return QSizeF(size.width() / 72.0, size.height() / 72.0);
 
         case Generator::Pixels:
         {
             const QSizeF dpi = m_generator->dpi();
-            inchesWidth = size.width() / dpi.width();
-            inchesHeight = size.height() / dpi.height();
+            return QSizeF(size.width() / dpi.width(), size.height() / dpi.height());
         }
-        break;
 
         case Generator::None:
         break;
     }
+    return QSizeF();
+}
+
+QString DocumentPrivate::localizedSize(const QSizeF &size) const
+{
+    const QSizeF inchesSize = sizeInInches(size);
+    const double inchesWidth = inchesSize.isValid() ? inchesSize.width() : 0;
+    const double inchesHeight = inchesSize.isValid() ? inchesSize.height() : 0;
     if (QLocale::system().measurementSystem() == QLocale::ImperialSystem)
     {
         return i18nc("%1 is width, %2 is height, %3 is paper size name", "%1 x %2 in (%3)", inchesWidth, inchesHeight, namePaperSize(inchesWidth, inchesHeight));
@@ -270,6 +300,8 @@ void DocumentPrivate::cleanupPixmapMemory( qulonglong memoryToFree )
     if ( memoryToFree < 1 )
         return;
 
+    QElapsedTimer evictionTimer;
+    evictionTimer.start();
     const int currentViewportPage = (*m_viewportIterator).pageNumber;
 
     // Create a QMap of visible rects, indexed by page number
@@ -291,12 +323,16 @@ void DocumentPrivate::cleanupPixmapMemory( qulonglong memoryToFree )
         // m_allocatedPixmapsTotalMemory can't underflow because we always add or remove
         // the memory used by the AllocatedPixmap so at most it can reach zero
         m_allocatedPixmapsTotalMemory -= p->memory;
+        m_renderStatistics.evictedPixmaps++;
+        m_renderStatistics.evictedMemory += p->memory;
         // Make sure memoryToFree does not underflow
         if ( p->memory > memoryToFree )
             memoryToFree = 0;
         else
             memoryToFree -= p->memory;
         pagesFreed++;
+        // keep it compressed, coming back to the page is then much cheaper
+        keepCompressedPixmap( p->observer, p->page );
         // delete pixmap
         m_pagesVector.at( p->page )->deletePixmap( p->observer );
         // delete allocation descriptor
@@ -334,6 +370,7 @@ void DocumentPrivate::cleanupPixmapMemory( qulonglong memoryToFree )
                 memoryDiff -= p->memory;
                 memoryToFree = (memoryDiff < memoryToFree) ? (memoryToFree - memoryDiff) : 0;
                 m_allocatedPixmapsTotalMemory -= memoryDiff;
+                m_renderStatistics.evictedMemory += memoryDiff;
 
                 if ( p->memory > 0 )
                     pixmapsToKeep.append( p );
@@ -348,6 +385,7 @@ void DocumentPrivate::cleanupPixmapMemory( qulonglong memoryToFree )
     }
 
     m_allocatedPixmaps += pixmapsToKeep;
+    m_renderStatistics.evictionTime += evictionTimer.nsecsElapsed() / 1000;
     //p--rintf("freeMemory A:[%d -%d = %d] \n", m_allocatedPixmaps.count() + pagesFreed, pagesFreed, m_allocatedPixmaps.count() );
 }
 
@@ -545,42 +583,93 @@ bool DocumentPrivate::loadDocumentInfo( LoadDocumentInfoFlags loadWhat )
     return loadDocumentInfo( infoFile, loadWhat );
 }
 
+// Reads the element the reader is at, with all its children, into @p document
+static QDomElement readDomElement( QXmlStreamReader &reader, QDomDocument &document )
+{
+    QDomElement element = document.createElement( reader.qualifiedName().toString() );
+    foreach ( const QXmlStreamAttribute &attribute, reader.attributes() )
+        element.setAttribute( attribute.qualifiedName().toString(), attribute.value().toString() );
+
+    while ( !reader.atEnd() )
+    {
+        reader.readNext();
+        if ( reader.isStartElement() )
+            element.appendChild( readDomElement( reader, document ) );
+        else if ( reader.isCDATA() )
+            element.appendChild( document.createCDATASection( reader.text().toString() ) );
+        else if ( reader.isCharacters() && !reader.isWhitespace() )
+            element.appendChild( document.createTextNode( reader.text().toString() ) );
+        else if ( reader.isEndElement() )
+            break;
+    }
+    return element;
+}
+
+// Writes @p element, with all its children, to the writer
+static void writeDomElement( QXmlStreamWriter &writer, const QDomElement &element )
+{
+    writer.writeStartElement( element.tagName() );
+    const QDomNamedNodeMap attributes = element.attributes();
+    for ( int i = 0; i < attributes.count(); ++i )
+    {
+        const QDomAttr attribute = attributes.item( i ).toAttr();
+        writer.writeAttribute( attribute.name(), attribute.value() );
+    }
+
+    for ( QDomNode child = element.firstChild(); !child.isNull(); child = child.nextSibling() )
+    {
+        if ( child.isElement() )
+            writeDomElement( writer, child.toElement() );
+        else if ( child.isCDATASection() )
+            writer.writeCDATA( child.toCDATASection().data() );
+        else if ( child.isText() )
+            writer.writeCharacters( child.toText().data() );
+    }
+    writer.writeEndElement();
+}
+
 bool DocumentPrivate::loadDocumentInfo( QFile &infoFile, LoadDocumentInfoFlags loadWhat )
 {
     if ( !infoFile.exists() || !infoFile.open( QIODevice::ReadOnly ) )
         return false;
 
-    // Load DOM from XML file
-    QDomDocument doc( QStringLiteral("documentInfo") );
-    if ( !doc.setContent( &infoFile ) )
+    // Check the whole file first, so that a broken one loads nothing
     {
-        qCDebug(OkularCoreDebug) << "Can't load XML pair! Check for broken xml.";
-        infoFile.close();
-        return false;
+        QXmlStreamReader checker( &infoFile );
+        while ( !checker.atEnd() )
+            checker.readNext();
+        if ( checker.hasError() )
+        {
+            qCDebug(OkularCoreDebug) << "Can't load XML pair! Check for broken xml:" << checker.errorString();
+            infoFile.close();
+            return false;
+        }
     }
-    infoFile.close();
+    infoFile.seek( 0 );
 
-    QDomElement root = doc.documentElement();
-
-    if ( root.tagName() != QLatin1String("documentInfo") )
+    // The file is streamed: only one page (or the general info) is turned
+    // into DOM at a time
+    QXmlStreamReader reader( &infoFile );
+    reader.setNamespaceProcessing( false );
+    if ( !reader.readNextStartElement() || reader.qualifiedName() != QLatin1String("documentInfo") )
+    {
+        infoFile.close();
         return false;
+    }
 
-    QUrl documentUrl( root.attribute( "url" ) );
     bool loadedAnything = false; // set if something gets actually loaded
 
-    // Parse the DOM tree
-    QDomNode topLevelNode = root.firstChild();
-    while ( topLevelNode.isElement() )
+    while ( reader.readNextStartElement() )
     {
-        QString catName = topLevelNode.toElement().tagName();
+        const QStringRef catName = reader.qualifiedName();
 
-        // Restore page attributes (bookmark, annotations, ...) from the DOM
+        // Restore page attributes (bookmark, annotations, ...) one page at a time
         if ( catName == QLatin1String("pageList") && ( loadWhat & LoadPageInfo ) )
         {
-            QDomNode pageNode = topLevelNode.firstChild();
-            while ( pageNode.isElement() )
+            while ( reader.readNextStartElement() )
             {
-                QDomElement pageElement = pageNode.toElement();
+                QDomDocument pageDocument;
+                const QDomElement pageElement = readDomElement( reader, pageDocument );
                 if ( pageElement.hasAttribute( QStringLiteral("number") ) )
                 {
                     // get page number (node's attribute)
@@ -594,14 +683,15 @@ bool DocumentPrivate::loadDocumentInfo( QFile &infoFile, LoadDocumentInfoFlags l
                             loadedAnything = true;
                     }
                 }
-                pageNode = pageNode.nextSibling();
             }
         }
 
-        // Restore 'general info' from the DOM
+        // Restore 'general info' from the DOM, it is small
         else if ( catName == QLatin1String("generalInfo") && ( loadWhat & LoadGeneralInfo ) )
         {
-            QDomNode infoNode = topLevelNode.firstChild();
+            QDomDocument generalInfoDocument;
+            const QDomElement generalInfoElement = readDomElement( reader, generalInfoDocument );
+            QDomNode infoNode = generalInfoElement.firstChild();
             while ( infoNode.isElement() )
             {
                 QDomElement infoElement = infoNode.toElement();
@@ -665,10 +755,13 @@ bool DocumentPrivate::loadDocumentInfo( QFile &infoFile, LoadDocumentInfoFlags l
                 infoNode = infoNode.nextSibling();
             }
         }
-
-        topLevelNode = topLevelNode.nextSibling();
+        else
+        {
+            reader.skipCurrentElement();
+        }
     } // </documentInfo>
 
+    infoFile.close();
     return loadedAnything;
 }
 
@@ -705,27 +798,50 @@ void DocumentPrivate::loadViewsInfo( View *view, const QDomElement &e )
     }
 }
 
-void DocumentPrivate::saveViewsInfo( View *view, QDomElement &e ) const
+void DocumentPrivate::saveViewsInfo( View *view, QXmlStreamWriter &writer ) const
 {
     if ( view->supportsCapability( View::Zoom )
          && ( view->capabilityFlags( View::Zoom ) & ( View::CapabilityRead | View::CapabilitySerializable ) )
          && view->supportsCapability( View::ZoomModality )
          && ( view->capabilityFlags( View::ZoomModality ) & ( View::CapabilityRead | View::CapabilitySerializable ) ) )
     {
-        QDomElement zoomEl = e.ownerDocument().createElement( QStringLiteral("zoom") );
-        e.appendChild( zoomEl );
+        writer.writeStartElement( QStringLiteral("zoom") );
         bool ok = true;
         const double zoom = view->capability( View::Zoom ).toDouble( &ok );
         if ( ok && zoom != 0 )
         {
-            zoomEl.setAttribute( QStringLiteral("value"), QString::number(zoom) );
+            writer.writeAttribute( QStringLiteral("value"), QString::number(zoom) );
         }
         const int mode = view->capability( View::ZoomModality ).toInt( &ok );
         if ( ok )
         {
-            zoomEl.setAttribute( QStringLiteral("mode"), mode );
+            writer.writeAttribute( QStringLiteral("mode"), QString::number(mode) );
+        }
+        writer.writeEndElement();
+    }
+}
+
+void DocumentPrivate::savePageList( QXmlStreamWriter &writer, int what ) const
+{
+    // <page list><page number='x'>.... </page> save pages that hold data;
+    // each page is built in a scratch DOM and written out right away, so
+    // only one page is in memory at a time
+    writer.writeStartElement( QStringLiteral("pageList") );
+    QDomDocument pageDocument;
+    QDomElement pageList = pageDocument.createElement( QStringLiteral("pageList") );
+    pageDocument.appendChild( pageList );
+    QVector< Page * >::const_iterator pIt = m_pagesVector.constBegin(), pEnd = m_pagesVector.constEnd();
+    for ( ; pIt != pEnd; ++pIt )
+    {
+        (*pIt)->d->saveLocalContents( pageList, pageDocument, PageItems( what ) );
+        const QDomElement pageElement = pageList.firstChildElement();
+        if ( !pageElement.isNull() )
+        {
+            writeDomElement( writer, pageElement );
+            pageList.removeChild( pageElement );
         }
     }
+    writer.writeEndElement();
 }
 
 QUrl DocumentPrivate::giveAbsoluteUrl( const QString & fileName ) const
@@ -931,28 +1047,20 @@ bool DocumentPrivate::savePageDocumentInfo( QTemporaryFile *infoFile, int what )
 {
     if ( infoFile->open() )
     {
-        // 1. Create DOM
-        QDomDocument doc( QStringLiteral("documentInfo") );
-        QDomProcessingInstruction xmlPi = doc.createProcessingInstruction(
-                QStringLiteral( "xml" ), QStringLiteral( "version=\"1.0\" encoding=\"utf-8\"" ) );
-        doc.appendChild( xmlPi );
-        QDomElement root = doc.createElement( QStringLiteral("documentInfo") );
-        doc.appendChild( root );
-
-        // 2.1. Save page attributes (bookmark state, annotations, ... ) to DOM
-        QDomElement pageList = doc.createElement( QStringLiteral("pageList") );
-        root.appendChild( pageList );
-        // <page list><page number='x'>.... </page> save pages that hold data
-        QVector< Page * >::const_iterator pIt = m_pagesVector.constBegin(), pEnd = m_pagesVector.constEnd();
-        for ( ; pIt != pEnd; ++pIt )
-            (*pIt)->d->saveLocalContents( pageList, doc, PageItems( what ) );
-
-        // 3. Save DOM to XML file
-        QString xml = doc.toString();
-        QTextStream os( infoFile );
-        os.setCodec( "UTF-8" );
-        os << xml;
-        return true;
+        // 1. Stream the XML to the file
+        QXmlStreamWriter writer( infoFile );
+        writer.setAutoFormatting( true );
+        writer.setAutoFormattingIndent( 1 );
+        writer.writeStartDocument();
+        writer.writeDTD( QStringLiteral("<!DOCTYPE documentInfo>") );
+        writer.writeStartElement( QStringLiteral("documentInfo") );
+
+        // 2.1. Save page attributes (bookmark state, annotations, ... )
+        savePageList( writer, what );
+
+        writer.writeEndElement();
+        writer.writeEndDocument();
+        return !writer.hasError();
     }
     return false;
 }
@@ -1179,28 +1287,27 @@ void DocumentPrivate::saveDocumentInfo() const
     if ( m_xmlFileName.isEmpty() )
         return;
 
-    QFile infoFile( m_xmlFileName );
+    // the previous file is only replaced once the new one is complete
+    QSaveFile infoFile( m_xmlFileName );
     qCDebug(OkularCoreDebug) << "About to save document info to" << m_xmlFileName;
-    if (!infoFile.open( QIODevice::WriteOnly | QIODevice::Truncate))
+    if ( !infoFile.open( QIODevice::WriteOnly ) )
     {
         qCWarning(OkularCoreDebug) << "Failed to open docdata file" << m_xmlFileName;
         return;
     }
-    // 1. Create DOM
-    QDomDocument doc( QStringLiteral("documentInfo") );
-    QDomProcessingInstruction xmlPi = doc.createProcessingInstruction(
-            QStringLiteral( "xml" ), QStringLiteral( "version=\"1.0\" encoding=\"utf-8\"" ) );
-    doc.appendChild( xmlPi );
-    QDomElement root = doc.createElement( QStringLiteral("documentInfo") );
-    root.setAttribute( QStringLiteral("url"), m_url.toDisplayString(QUrl::PreferLocalFile) );
-    doc.appendChild( root );
+    // 1. Stream the XML to the file
+    QXmlStreamWriter writer( &infoFile );
+    writer.setAutoFormatting( true );
+    writer.setAutoFormattingIndent( 1 );
+    writer.writeStartDocument();
+    writer.writeDTD( QStringLiteral("<!DOCTYPE documentInfo>") );
+    writer.writeStartElement( QStringLiteral("documentInfo") );
+    writer.writeAttribute( QStringLiteral("url"), m_url.toDisplayString(QUrl::PreferLocalFile) );
 
-    // 2.1. Save page attributes (bookmark state, annotations, ... ) to DOM
+    // 2.1. Save page attributes (bookmark state, annotations, ... )
     //  -> do this if there are not-yet-migrated annots or forms in docdata/
     if ( m_docdataMigrationNeeded )
     {
-        QDomElement pageList = doc.createElement( "pageList" );
-        root.appendChild( pageList );
         // OriginalAnnotationPageItems and OriginalFormFieldPageItems tell to
         // store the same unmodified annotation list and form contents that we
         // read when we opened the file and ignore any change made by the user.
@@ -1208,21 +1315,15 @@ void DocumentPrivate::saveDocumentInfo() const
         // necessary to preserve annotations/forms that previous Okular version
         // had stored there.
         const PageItems saveWhat = AllPageItems | OriginalAnnotationPageItems | OriginalFormFieldPageItems;
-        // <page list><page number='x'>.... </page> save pages that hold data
-        QVector< Page * >::const_iterator pIt = m_pagesVector.constBegin(), pEnd = m_pagesVector.constEnd();
-        for ( ; pIt != pEnd; ++pIt )
-            (*pIt)->d->saveLocalContents( pageList, doc, saveWhat );
+        savePageList( writer, saveWhat );
     }
 
-    // 2.2. Save document info (current viewport, history, ... ) to DOM
-    QDomElement generalInfo = doc.createElement( QStringLiteral("generalInfo") );
-    root.appendChild( generalInfo );
+    // 2.2. Save document info (current viewport, history, ... )
+    writer.writeStartElement( QStringLiteral("generalInfo") );
     // create rotation node
     if ( m_rotation != Rotation0 )
     {
-        QDomElement rotationNode = doc.createElement( QStringLiteral("rotation") );
-        generalInfo.appendChild( rotationNode );
-        rotationNode.appendChild( doc.createTextNode( QString::number( (int)m_rotation ) ) );
+        writer.writeTextElement( QStringLiteral("rotation"), QString::number( (int)m_rotation ) );
     }
     // <general info><history> ... </history> save history up to OKULAR_HISTORY_SAVEDSTEPS viewports
     QLinkedList< DocumentViewport >::const_iterator backIterator = m_viewportIterator;
@@ -1234,8 +1335,7 @@ void DocumentPrivate::saveDocumentInfo() const
             --backIterator;
 
         // create history root node
-        QDomElement historyNode = doc.createElement( QStringLiteral("history") );
-        generalInfo.appendChild( historyNode );
+        writer.writeStartElement( QStringLiteral("history") );
 
         // add old[backIterator] and present[viewportIterator] items
         QLinkedList< DocumentViewport >::const_iterator endIt = m_viewportIterator;
@@ -1243,29 +1343,31 @@ void DocumentPrivate::saveDocumentInfo() const
         while ( backIterator != endIt )
         {
             QString name = (backIterator == m_viewportIterator) ? QStringLiteral ("current") : QStringLiteral ("oldPage");
-            QDomElement historyEntry = doc.createElement( name );
-            historyEntry.setAttribute( QStringLiteral("viewport"), (*backIterator).toString() );
-            historyNode.appendChild( historyEntry );
+            writer.writeStartElement( name );
+            writer.writeAttribute( QStringLiteral("viewport"), (*backIterator).toString() );
+            writer.writeEndElement();
             ++backIterator;
         }
+        writer.writeEndElement();
     }
     // create views root node
-    QDomElement viewsNode = doc.createElement( QStringLiteral("views") );
-    generalInfo.appendChild( viewsNode );
+    writer.writeStartElement( QStringLiteral("views") );
     Q_FOREACH ( View * view, m_views )
     {
-        QDomElement viewEntry = doc.createElement( QStringLiteral("view") );
-        viewEntry.setAttribute( QStringLiteral("name"), view->name() );
-        viewsNode.appendChild( viewEntry );
-        saveViewsInfo( view, viewEntry );
+        writer.writeStartElement( QStringLiteral("view") );
+        writer.writeAttribute( QStringLiteral("name"), view->name() );
+        saveViewsInfo( view, writer );
+        writer.writeEndElement();
     }
+    writer.writeEndElement(); // views
+    writer.writeEndElement(); // generalInfo
 
-    // 3. Save DOM to XML file
-    QString xml = doc.toString();
-    QTextStream os( &infoFile );
-    os.setCodec( "UTF-8" );
-    os << xml;
-    infoFile.close();
+    writer.writeEndElement(); // documentInfo
+    writer.writeEndDocument();
+
+    // 3. Replace the previous file
+    if ( writer.hasError() || !infoFile.commit() )
+        qCWarning(OkularCoreDebug) << "Failed to save docdata file" << m_xmlFileName;
 }
 
 void DocumentPrivate::slotTimedMemoryCheck()
@@ -1295,40 +1397,40 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
     // find a request
     PixmapRequest * request = nullptr;
     m_pixmapRequestsMutex.lock();
-    while ( !m_pixmapRequestsStack.isEmpty() && !request )
+    while ( !m_pixmapRequestsQueue.isEmpty() && !request )
     {
-        PixmapRequest * r = m_pixmapRequestsStack.last();
-        if (!r)
-        {
-            m_pixmapRequestsStack.pop_back();
-            continue;
-        }
-
+        PixmapRequest * r = m_pixmapRequestsQueue.top();
         QRect requestRect = r->isTile() ? r->normalizedRect().geometry( r->width(), r->height() ) : QRect( 0, 0, r->width(), r->height() );
         TilesManager *tilesManager = r->d->tilesManager();
 
         // If it's a preload but the generator is not threaded no point in trying to preload
         if ( r->preload() && !m_generator->hasFeature( Generator::Threaded ) )
         {
-            m_pixmapRequestsStack.pop_back();
+            m_pixmapRequestsQueue.pop();
             delete r;
         }
-        // request only if page isn't already present and request has valid id
-        else if ( ( !r->d->mForce && r->page()->hasPixmap( r->observer(), r->width(), r->height(), r->normalizedRect() ) ) || !m_observers.contains(r->observer()) )
+        // request only if page isn't already present and request has valid id;
+        // a preview is useless as soon as there is any pixmap
+        else if ( ( !r->d->mForce && r->page()->hasPixmap( r->observer(), r->width(), r->height(), r->normalizedRect() ) ) || !m_observers.contains(r->observer())
+                  || ( r->d->mPreview && ( tilesManager || r->page()->hasPixmap( r->observer() ) ) ) )
         {
-            m_pixmapRequestsStack.pop_back();
+            if ( m_observers.contains( r->observer() ) )
+                m_renderStatistics.cacheHits++;
+            m_pixmapRequestsQueue.pop();
             delete r;
         }
-        else if ( !r->d->mForce && r->preload() && qAbs( r->pageNumber() - currentViewportPage ) >= maxDistance )
+        // pages the observer won't let go of are never evicted, so they always fit
+        else if ( !r->d->mForce && r->preload() && qAbs( r->pageNumber() - currentViewportPage ) >= maxDistance
+                  && r->observer()->canUnloadPixmap( r->pageNumber() ) )
         {
-            m_pixmapRequestsStack.pop_back();
+            m_pixmapRequestsQueue.pop();
             //qCDebug(OkularCoreDebug) << "Ignoring request that doesn't fit in cache";
             delete r;
         }
         // Ignore requests for pixmaps that are already being generated
         else if ( tilesManager && tilesManager->isRequesting( r->normalizedRect(), r->width(), r->height() ) )
         {
-            m_pixmapRequestsStack.pop_back();
+            m_pixmapRequestsQueue.pop();
             delete r;
         }
         // If the requested area is above 8000000 pixels, switch on the tile manager
@@ -1351,39 +1453,18 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
                 // create new tiles manager
                 tilesManager = new TilesManager( r->pageNumber(), r->width(), r->height(), r->page()->rotation() );
             }
-            tilesManager->setRequest( r->normalizedRect(), r->width(), r->height() );
             r->page()->deletePixmap( r->observer() );
             r->page()->d->setTilesManager( r->observer(), tilesManager );
             r->setTile( true );
 
-            // Change normalizedRect to the smallest rect that contains all
-            // visible tiles.
-            if ( !r->normalizedRect().isNull() )
+            // Discard request if normalizedRect is null. This happens in
+            // preload requests issued by PageView if the requested page is
+            // not visible and the user has just switched from a non-tiled
+            // zoom level to a tiled one. Otherwise it stays in the queue,
+            // to be split in tiles
+            if ( r->normalizedRect().isNull() )
             {
-                NormalizedRect tilesRect;
-                const QList<Tile> tiles = tilesManager->tilesAt( r->normalizedRect(), TilesManager::TerminalTile );
-                QList<Tile>::const_iterator tIt = tiles.constBegin(), tEnd = tiles.constEnd();
-                while ( tIt != tEnd )
-                {
-                    Tile tile = *tIt;
-                    if ( tilesRect.isNull() )
-                        tilesRect = tile.rect();
-                    else
-                        tilesRect |= tile.rect();
-
-                    ++tIt;
-                }
-
-                r->setNormalizedRect( tilesRect );
-                request = r;
-            }
-            else
-            {
-                // Discard request if normalizedRect is null. This happens in
-                // preload requests issued by PageView if the requested page is
-                // not visible and the user has just switched from a non-tiled
-                // zoom level to a tiled one
-                m_pixmapRequestsStack.pop_back();
+                m_pixmapRequestsQueue.pop();
                 delete r;
             }
         }
@@ -1399,9 +1480,17 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
 
             request = r;
         }
+        // Render the tiles one by one, the visible ones first, and never the
+        // valid ones again as part of a bigger region
+        else if ( tilesManager && r->isTile() && !r->normalizedRect().isNull() && !isSingleTileRequest( r ) )
+        {
+            m_pixmapRequestsQueue.pop();
+            queueTileRequests( r );
+            delete r;
+        }
         else if ( (long)requestRect.width() * (long)requestRect.height() > 200000000L && (SettingsCore::memoryLevel() != SettingsCore::EnumMemoryLevel::Greedy ) )
         {
-            m_pixmapRequestsStack.pop_back();
+            m_pixmapRequestsQueue.pop();
             if ( !m_warnedOutOfMemory )
             {
                 qCWarning(OkularCoreDebug).nospace() << "Running out of memory on page " << r->pageNumber()
@@ -1440,7 +1529,7 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
     {
         QRect requestRect = !request->isTile() ? QRect(0, 0, request->width(), request->height() ) : request->normalizedRect().geometry( request->width(), request->height() );
         qCDebug(OkularCoreDebug).nospace() << "sending request observer=" << request->observer() << " " <<requestRect.width() << "x" << requestRect.height() << "@" << request->pageNumber() << " async == " << request->asynchronous() << " isTile == " << request->isTile();
-        m_pixmapRequestsStack.removeAll ( request );
+        m_pixmapRequestsQueue.remove( request );
 
         if ( tm )
             tm->setRequest( request->normalizedRect(), request->width(), request->height() );
@@ -1462,8 +1551,23 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
         // a sync generation would end with requestDone() -> deadlock, and
         // we can not really know if the generator can do async requests
         m_executingPixmapRequests.push_back( request );
+        m_renderStatistics.cacheMisses++;
+        request->d->mQueueTime = request->d->mTimer.nsecsElapsed() / 1000;
+        request->d->mTimer.restart();
+        const bool isTile = request->isTile();
         m_pixmapRequestsMutex.unlock();
         m_generator->generatePixmap( request );
+
+        // generators rendering tiles in parallel can take the next tile
+        // right away, without waiting for this one to be done
+        if ( isTile && m_generator->hasFeature( Generator::ParallelTileRendering ) && m_generator->canGeneratePixmap() )
+        {
+            m_pixmapRequestsMutex.lock();
+            const bool hasPixmaps = !m_pixmapRequestsQueue.isEmpty();
+            m_pixmapRequestsMutex.unlock();
+            if ( hasPixmaps )
+                QTimer::singleShot( 0, m_parent, SLOT(sendGeneratorPixmapRequest()) );
+        }
     }
     else
     {
@@ -1535,6 +1639,7 @@ void DocumentPrivate::slotGeneratorConfigChanged( const QString& )
         qDeleteAll( m_allocatedPixmaps );
         m_allocatedPixmaps.clear();
         m_allocatedPixmapsTotalMemory = 0;
+        m_compressedPixmapCache.clear();
 
         // send reload signals to observers
         foreachObserverD( notifyContentsCleared( DocumentObserver::Pixmap ) );
@@ -1552,6 +1657,10 @@ void DocumentPrivate::refreshPixmaps( int pageNumber )
     if ( !page )
         return;
 
+    // the stored and compressed pixmaps show the old contents too
+    m_pixmapStore.removeImage( pageNumber );
+    m_compressedPixmapCache.removePage( pageNumber );
+
     QMap< DocumentObserver*, PagePrivate::PixmapObject >::ConstIterator it = page->d->m_pixmaps.constBegin(), itEnd = page->d->m_pixmaps.constEnd();
     QVector< Okular::PixmapRequest * > pixmapsToRequest;
     for ( ; it != itEnd; ++it )
@@ -2172,12 +2281,10 @@ void DocumentPrivate::loadSyncFile( const QString & filePath )
 void DocumentPrivate::clearAndWaitForRequests()
 {
     m_pixmapRequestsMutex.lock();
-    QLinkedList< PixmapRequest * >::const_iterator sIt = m_pixmapRequestsStack.constBegin();
-    QLinkedList< PixmapRequest * >::const_iterator sEnd = m_pixmapRequestsStack.constEnd();
-    for ( ; sIt != sEnd; ++sIt )
-        delete *sIt;
-    m_pixmapRequestsStack.clear();
+    qDeleteAll( m_pixmapRequestsQueue.takeAll() );
     m_pixmapRequestsMutex.unlock();
+    qDeleteAll( m_storedPixmapRequests );
+    m_storedPixmapRequests.clear();
 
     QEventLoop loop;
     bool startEventLoop = false;
@@ -2218,6 +2325,8 @@ Document::Document( QWidget *widget )
     connect(d->m_undoStack, &QUndoStack::canUndoChanged, this, &Document::canUndoChanged);
     connect(d->m_undoStack, &QUndoStack::canRedoChanged, this, &Document::canRedoChanged);
     connect(d->m_undoStack, &QUndoStack::cleanChanged, this, &Document::undoHistoryCleanChanged);
+    // emitted from the thread of the store
+    connect( &d->m_pixmapStore, SIGNAL(imagesLoaded()), this, SLOT(storedPixmapsLoaded()), Qt::QueuedConnection );
 
     qRegisterMetaType<Okular::FontInfo>();
 }
@@ -2226,6 +2335,7 @@ Document::~Document()
 {
     // delete generator, pages, and related stuff
     closeDocument();
+    delete d->m_reloadData;
 
     QSet< View * >::const_iterator viewIt = d->m_views.constBegin(), viewEnd = d->m_views.constEnd();
     for ( ; viewIt != viewEnd; ++viewIt )
@@ -2363,6 +2473,13 @@ KPluginMetaData DocumentPrivate::generatorForMimeType(const QMimeType& type, QWi
 
 Document::OpenResult Document::openDocument(const QString & docFile, const QUrl &url, const QMimeType &_mime, const QString & password )
 {
+    // contents kept by prepareReload() are only for the same file
+    if ( d->m_reloadData && d->m_reloadData->docFileName != docFile )
+    {
+        delete d->m_reloadData;
+        d->m_reloadData = nullptr;
+    }
+
     QMimeDatabase db;
     QMimeType mime = _mime;
     QByteArray filedata;
@@ -2516,6 +2633,13 @@ Document::OpenResult Document::openDocument(const QString & docFile, const QUrl
     foreach ( Page * p, d->m_pagesVector )
         p->d->m_doc = d;
 
+    // they are kept through the failed attempts, the file may have been
+    // opened while still being written
+    QScopedPointer< ReloadData > reloadData( d->m_reloadData );
+    d->m_reloadData = nullptr;
+    if ( reloadData && reloadData->generatorName == d->m_generatorName && !fromFileDescriptor )
+        d->adoptReloadedPages( reloadData.data() );
+
     d->m_metadataLoadingCompleted = false;
     d->m_docdataMigrationNeeded = false;
 
@@ -2537,6 +2661,10 @@ Document::OpenResult Document::openDocument(const QString & docFile, const QUrl
     d->m_metadataLoadingCompleted = true;
     d->m_bookmarkManager->setUrl( d->m_url );
 
+    // the thumbnails of an unpacked archive would be discarded every time
+    if ( !fromFileDescriptor && !d->m_archiveData )
+        d->m_pixmapStore.open( d->m_url, docFile, d->m_docSize );
+
     // 3. setup observers inernal lists and data
     foreachObserver( notifySetup( d->m_pagesVector, DocumentObserver::DocumentChanged | DocumentObserver::UrlChanged ) );
 
@@ -2617,6 +2745,115 @@ bool DocumentPrivate::updateMetadataXmlNameAndDocSize()
 }
 
 
+void Document::prepareReload()
+{
+    // another attempt after the document failed to open again: what was
+    // kept on the first close is still there
+    if ( !d->m_generator )
+        return;
+
+    delete d->m_reloadData;
+    d->m_reloadData = nullptr;
+
+    // rotated pixmaps would be thrown away anyway when the rotation is restored
+    if ( d->m_docFileName.isEmpty() || d->m_rotation != Rotation0 )
+        return;
+
+    const QVariantList fingerprints = d->m_generator->metaData( QStringLiteral("PageFingerprints"), QVariant() ).toList();
+    if ( fingerprints.count() != d->m_pagesVector.count() )
+        return;
+
+    d->m_reloadData = new ReloadData();
+    d->m_reloadData->generatorName = d->m_generatorName;
+    d->m_reloadData->docFileName = d->m_docFileName;
+    d->m_reloadData->fingerprints = fingerprints;
+}
+
+void DocumentPrivate::stashPagesForReload()
+{
+    if ( !m_reloadData->pages.isEmpty() || m_reloadData->fingerprints.count() != m_pagesVector.count() )
+        return;
+
+    QSet< int > keptPages;
+    for ( int i = 0; i < m_pagesVector.count(); ++i )
+    {
+        Page *page = m_pagesVector.at( i );
+        Page *holder = nullptr;
+        if ( !m_reloadData->fingerprints.at( i ).toByteArray().isEmpty() )
+        {
+            holder = new Page( i, page->width(), page->height(), page->orientation() );
+            holder->d->adoptRenderedContents( page->d );
+            keptPages.insert( i );
+        }
+        m_reloadData->pages.append( holder );
+    }
+
+    // move the memory descriptors of the kept pixmaps, preserving their order
+    QLinkedList< AllocatedPixmap * >::iterator aIt = m_allocatedPixmaps.begin();
+    while ( aIt != m_allocatedPixmaps.end() )
+    {
+        if ( keptPages.contains( (*aIt)->page ) )
+        {
+            m_reloadData->allocatedPixmaps.append( *aIt );
+            aIt = m_allocatedPixmaps.erase( aIt );
+        }
+        else
+            ++aIt;
+    }
+
+    foreach ( int page, m_allocatedTextPagesFifo )
+    {
+        if ( keptPages.contains( page ) )
+            m_reloadData->textPages.append( page );
+    }
+}
+
+void DocumentPrivate::adoptReloadedPages( ReloadData *reloadData )
+{
+    const QVariantList fingerprints = m_generator->metaData( QStringLiteral("PageFingerprints"), QVariant() ).toList();
+    const int count = qMin( qMin( fingerprints.count(), reloadData->pages.count() ), m_pagesVector.count() );
+
+    QSet< int > adoptedPages;
+    for ( int i = 0; i < count; ++i )
+    {
+        Page *holder = reloadData->pages.at( i );
+        const QByteArray fingerprint = fingerprints.at( i ).toByteArray();
+        if ( !holder || fingerprint.isEmpty() || fingerprint != reloadData->fingerprints.at( i ).toByteArray() )
+            continue;
+
+        Page *page = m_pagesVector.at( i );
+        if ( page->width() != holder->width() || page->height() != holder->height() || page->orientation() != holder->orientation() )
+            continue;
+
+        page->d->adoptRenderedContents( holder->d );
+        adoptedPages.insert( i );
+    }
+
+    foreach ( AllocatedPixmap *p, reloadData->allocatedPixmaps )
+    {
+        if ( adoptedPages.contains( p->page ) && m_observers.contains( p->observer ) )
+        {
+            m_allocatedPixmaps.append( p );
+            m_allocatedPixmapsTotalMemory += p->memory;
+        }
+        else
+        {
+            if ( adoptedPages.contains( p->page ) )
+                m_pagesVector[ p->page ]->deletePixmap( p->observer );
+            delete p;
+        }
+    }
+    reloadData->allocatedPixmaps.clear();
+
+    foreach ( int page, reloadData->textPages )
+    {
+        if ( adoptedPages.contains( page ) && m_pagesVector.at( page )->hasTextPage() )
+            m_allocatedTextPagesFifo.append( page );
+    }
+
+    qCDebug(OkularCoreDebug) << "Reused the rendered contents of" << adoptedPages.count() << "of" << m_pagesVector.count() << "pages";
+}
+
 KXMLGUIClient* Document::guiClient()
 {
     if ( d->m_generator )
@@ -2643,6 +2880,8 @@ void Document::closeDocument()
      // remove requests left in queue
     d->clearAndWaitForRequests();
 
+    d->m_pixmapStore.close();
+
     if ( d->m_fontThread )
     {
         disconnect( d->m_fontThread, nullptr, this, nullptr );
@@ -2704,6 +2943,10 @@ void Document::closeDocument()
     // send an empty list to observers (to free their data)
     foreachObserver( notifySetup( QVector< Page * >(), DocumentObserver::DocumentChanged | DocumentObserver::UrlChanged ) );
 
+    // keep what can be reused when the same document is opened again
+    if ( d->m_reloadData )
+        d->stashPagesForReload();
+
     // delete pages and clear 'd->m_pagesVector' container
     QVector< Page * >::const_iterator pIt = d->m_pagesVector.constBegin();
     QVector< Page * >::const_iterator pEnd = d->m_pagesVector.constEnd();
@@ -2714,6 +2957,7 @@ void Document::closeDocument()
     // clear 'memory allocation' descriptors
     qDeleteAll( d->m_allocatedPixmaps );
     d->m_allocatedPixmaps.clear();
+    d->m_compressedPixmapCache.clear();
 
     // clear 'running searches' descriptors
     QMap< int, RunningSearch * >::const_iterator rIt = d->m_searches.constBegin();
@@ -2737,6 +2981,7 @@ void Document::closeDocument()
     d->m_viewportIterator = d->m_viewportHistory.begin();
     d->m_allocatedPixmapsTotalMemory = 0;
     d->m_allocatedTextPagesFifo.clear();
+    d->m_renderStatistics = RenderStatisticsPrivate();
     d->m_pageSize = PageSize();
     d->m_pageSizes.clear();
 
@@ -2794,6 +3039,24 @@ void Document::removeObserver( DocumentObserver * pObserver )
                 ++aIt;
         }
 
+        d->m_compressedPixmapCache.removeObserver( pObserver );
+
+        d->m_pixmapRequestsMutex.lock();
+        qDeleteAll( d->m_pixmapRequestsQueue.take( pObserver ) );
+        d->m_pixmapRequestsMutex.unlock();
+
+        QLinkedList< PixmapRequest * >::iterator sIt = d->m_storedPixmapRequests.begin();
+        while ( sIt != d->m_storedPixmapRequests.end() )
+        {
+            if ( (*sIt)->observer() == pObserver )
+            {
+                delete *sIt;
+                sIt = d->m_storedPixmapRequests.erase( sIt );
+            }
+            else
+                ++sIt;
+        }
+
         for ( PixmapRequest *executingRequest : qAsConst( d->m_executingPixmapRequests ) )
         {
             if ( executingRequest->observer() == pObserver ) {
@@ -2828,6 +3091,7 @@ void Document::reparseConfig()
         qDeleteAll( d->m_allocatedPixmaps );
         d->m_allocatedPixmaps.clear();
         d->m_allocatedPixmapsTotalMemory = 0;
+        d->m_compressedPixmapCache.clear();
 
         // send reload signals to observers
         foreachObserver( notifyContentsCleared( DocumentObserver::Pixmap ) );
@@ -3094,6 +3358,40 @@ bool Document::historyAtEnd() const
 
 QVariant Document::metaData( const QString & key, const QVariant & option ) const
 {
+    if ( key == QLatin1String("RenderStatistics") )
+    {
+        const RenderStatistics statistics = renderStatistics();
+        QVariantMap map;
+        map.insert( QStringLiteral("renderedPixmaps"), statistics.renderedPixmaps() );
+        map.insert( QStringLiteral("cancelledPixmaps"), statistics.cancelledPixmaps() );
+        map.insert( QStringLiteral("cacheHits"), statistics.cacheHits() );
+        map.insert( QStringLiteral("cacheMisses"), statistics.cacheMisses() );
+        map.insert( QStringLiteral("queueTime"), statistics.queueTime() );
+        map.insert( QStringLiteral("generationTime"), statistics.generationTime() );
+        map.insert( QStringLiteral("conversionTime"), statistics.conversionTime() );
+        map.insert( QStringLiteral("tilingTime"), statistics.tilingTime() );
+        map.insert( QStringLiteral("notificationTime"), statistics.notificationTime() );
+        map.insert( QStringLiteral("textPages"), statistics.textPages() );
+        map.insert( QStringLiteral("textPageTime"), statistics.textPageTime() );
+        map.insert( QStringLiteral("evictedPixmaps"), statistics.evictedPixmaps() );
+        map.insert( QStringLiteral("evictedMemory"), statistics.evictedMemory() );
+        map.insert( QStringLiteral("evictionTime"), statistics.evictionTime() );
+        map.insert( QStringLiteral("allocatedPixmaps"), statistics.allocatedPixmaps() );
+        map.insert( QStringLiteral("allocatedMemory"), statistics.allocatedMemory() );
+        map.insert( QStringLiteral("compressedCacheHits"), statistics.compressedCacheHits() );
+        map.insert( QStringLiteral("compressedCacheMisses"), statistics.compressedCacheMisses() );
+        map.insert( QStringLiteral("decompressionTime"), statistics.decompressionTime() );
+        map.insert( QStringLiteral("compressedPixmaps"), statistics.compressedPixmaps() );
+        map.insert( QStringLiteral("compressedMemory"), statistics.compressedMemory() );
+        map.insert( QStringLiteral("compressedDiskMemory"), statistics.compressedDiskMemory() );
+        map.insert( QStringLiteral("tilePoolHits"), statistics.tilePoolHits() );
+        map.insert( QStringLiteral("tilePoolMisses"), statistics.tilePoolMisses() );
+        map.insert( QStringLiteral("tilePoolMemory"), statistics.tilePoolMemory() );
+        map.insert( QStringLiteral("tileNodes"), statistics.tileNodes() );
+        map.insert( QStringLiteral("allocatedTileNodes"), statistics.allocatedTileNodes() );
+        return map;
+    }
+
     // if option starts with "src:" assume that we are handling a
     // source reference
     if ( key == QLatin1String("NamedViewport")
@@ -3195,6 +3493,40 @@ QString Document::pageSizeString(int page) const
     return QString();
 }
 
+QSizeF Document::pageSizeInInches(int page) const
+{
+    if (!d->m_generator || page < 0 || page >= d->m_pagesVector.count())
+        return QSizeF();
+
+    const Page *p = d->m_pagesVector.at( page );
+    return d->sizeInInches(QSizeF(p->width(), p->height()));
+}
+
+RenderStatistics Document::renderStatistics() const
+{
+    RenderStatistics statistics;
+    RenderStatisticsPrivate *s = statistics.d;
+    *s = d->m_renderStatistics;
+    s->allocatedPixmaps = d->m_allocatedPixmaps.count();
+    s->allocatedMemory = d->m_allocatedPixmapsTotalMemory;
+    s->compressedPixmaps = d->m_compressedPixmapCache.count();
+    s->compressedMemory = d->m_compressedPixmapCache.memory();
+    s->compressedDiskMemory = d->m_compressedPixmapCache.diskMemory();
+    const TilePool *tilePool = TilePool::instance();
+    s->tilePoolHits = tilePool->hits();
+    s->tilePoolMisses = tilePool->misses();
+    s->tilePoolMemory = tilePool->idleMemory();
+    s->tileNodes = tilePool->nodesInUse();
+    s->allocatedTileNodes = tilePool->allocatedNodes();
+    return statistics;
+}
+
+void Document::resetRenderStatistics()
+{
+    d->m_renderStatistics = RenderStatisticsPrivate();
+    TilePool::instance()->resetStatistics();
+}
+
 static bool shouldCancelRenderingBecauseOf( const PixmapRequest & executingRequest, const PixmapRequest & otherRequest )
 {
     // New request has higher priority -> cancel
@@ -3228,11 +3560,12 @@ static bool shouldCancelRenderingBecauseOf( const PixmapRequest & executingReque
     if ( executingRequest.isTile() != otherRequest.isTile() )
         return true;
 
-    // Same priority, observer, page, different tiling -> cancel
+    // Same priority, observer, page, the tile is out of the new region -> cancel
+    // (tiles are rendered one by one, the rest of the region gets its own requests)
     if ( executingRequest.isTile() )
     {
-        const NormalizedRect bothRequestsRect = executingRequest.normalizedRect() | otherRequest.normalizedRect();
-        if ( !( bothRequestsRect == executingRequest.normalizedRect() ) )
+        const NormalizedRect commonRect = executingRequest.normalizedRect() & otherRequest.normalizedRect();
+        if ( commonRect.width() <= 0 || commonRect.height() <= 0 )
             return true;
     }
 
@@ -3249,12 +3582,11 @@ bool DocumentPrivate::cancelRenderingBecauseOf( PixmapRequest *executingRequest,
         newRequest->setPartialUpdatesWanted( true );
     }
 
+    // this forgets the request of the tiles manager, the other tiles of the
+    // page may still be rendering
     TilesManager *tm = executingRequest->d->tilesManager();
     if ( tm )
-    {
         tm->setPixmap( nullptr, executingRequest->normalizedRect(), true /*isPartialPixmap*/ );
-        tm->setRequest( NormalizedRect(), 0, 0 );
-    }
     PagePrivate::PixmapObject object = executingRequest->page()->d->m_pixmaps.take( executingRequest->observer() );
     delete object.m_pixmap;
 
@@ -3306,18 +3638,14 @@ void Document::requestPixmaps( const QLinkedList< PixmapRequest * > & requests,
     }
     const bool removeAllPrevious = reqOptions & RemoveAllPrevious;
     d->m_pixmapRequestsMutex.lock();
-    QLinkedList< PixmapRequest * >::iterator sIt = d->m_pixmapRequestsStack.begin(), sEnd = d->m_pixmapRequestsStack.end();
-    while ( sIt != sEnd )
+    if ( removeAllPrevious )
     {
-        if ( (*sIt)->observer() == requesterObserver
-             && ( removeAllPrevious || requestedPages.contains( (*sIt)->pageNumber() ) ) )
-        {
-            // delete request and remove it from stack
-            delete *sIt;
-            sIt = d->m_pixmapRequestsStack.erase( sIt );
-        }
-        else
-            ++sIt;
+        qDeleteAll( d->m_pixmapRequestsQueue.take( requesterObserver ) );
+    }
+    else
+    {
+        for ( int page : qAsConst( requestedPages ) )
+            qDeleteAll( d->m_pixmapRequestsQueue.take( requesterObserver, page ) );
     }
 
     // 1.B [PREPROCESS REQUESTS] tweak some values of the requests
@@ -3396,21 +3724,47 @@ void Document::requestPixmaps( const QLinkedList< PixmapRequest * > & requests,
     }
 
     // 2. [ADD TO STACK] add requests to stack
+    QList< int > storedPixmapPages;
+    QLinkedList< PixmapRequest * > queuedRequests;
     for ( PixmapRequest *request : requests )
     {
-        // add request to the 'stack' at the right place
-        if ( !request->priority() )
-            // add priority zero requests to the top of the stack
-            d->m_pixmapRequestsStack.append( request );
-        else
+        // the pixmaps kept on disk from a previous session are read in the
+        // thread of the store, the request waits for them there
+        if ( d->loadStoredPixmap( request ) )
+            continue;
+
+        // serve the pixmaps compressed after their eviction right away
+        if ( d->loadCompressedPixmap( request ) )
         {
-            // insert in stack sorted by priority
-            sIt = d->m_pixmapRequestsStack.begin();
-            sEnd = d->m_pixmapRequestsStack.end();
-            while ( sIt != sEnd && (*sIt)->priority() > request->priority() )
-                ++sIt;
-            d->m_pixmapRequestsStack.insert( sIt, request );
+            d->m_renderStatistics.cacheHits++;
+            storedPixmapPages << request->pageNumber();
+            delete request;
+            continue;
         }
+
+        queuedRequests.append( request );
+    }
+
+    // the previews go before all the requests of this batch, so that every
+    // page shows something before the first one is rendered sharp
+    for ( PixmapRequest *request : qAsConst( queuedRequests ) )
+    {
+        PixmapRequest *preview = d->previewRequest( request );
+        if ( preview )
+        {
+            preview->d->mTimer.start();
+            d->m_pixmapRequestsQueue.push( preview );
+        }
+    }
+
+    for ( PixmapRequest *request : qAsConst( queuedRequests ) )
+    {
+        // the time it spends in the queue starts now
+        request->d->mTimer.start();
+
+        // queue the request by priority, duplicates of a queued request
+        // are merged into it
+        d->m_pixmapRequestsQueue.push( request );
     }
     d->m_pixmapRequestsMutex.unlock();
 
@@ -3423,6 +3777,9 @@ void Document::requestPixmaps( const QLinkedList< PixmapRequest * > & requests,
 
     for ( DocumentObserver *o : qAsConst( observersPixmapCleared ) )
         o->notifyContentsCleared( Okular::DocumentObserver::Pixmap );
+
+    for ( int page : qAsConst( storedPixmapPages ) )
+        requesterObserver->notifyPageChanged( page, DocumentObserver::Pixmap );
 }
 
 void Document::requestTextPage( uint page )
@@ -3433,7 +3790,11 @@ void Document::requestTextPage( uint page )
 
     // Memory management for TextPages
 
+    QElapsedTimer timer;
+    timer.start();
     d->m_generator->generateTextPage( kp );
+    if ( kp->hasTextPage() )
+        d->recordTextPage( timer.nsecsElapsed() / 1000 );
 }
 
 void DocumentPrivate::notifyAnnotationChanges( int page )
@@ -4635,6 +4996,8 @@ bool Document::swapBackingFile( const QString &newFileName, const QUrl &url )
         d->m_docFileName = newFileName;
         d->updateMetadataXmlNameAndDocSize();
         d->m_bookmarkManager->setUrl( d->m_url );
+        if ( d->m_pixmapStore.isOpen() )
+            d->m_pixmapStore.open( d->m_url, newFileName, d->m_docSize );
 
         if ( d->m_synctex_scanner )
         {
@@ -5081,41 +5444,47 @@ void DocumentPrivate::requestDone( PixmapRequest * req )
 
     if ( !req->shouldAbortRender() )
     {
-        // [MEM] 1.1 find and remove a previous entry for the same page and id
-        QLinkedList< AllocatedPixmap * >::iterator aIt = m_allocatedPixmaps.begin();
-        QLinkedList< AllocatedPixmap * >::iterator aEnd = m_allocatedPixmaps.end();
-        for ( ; aIt != aEnd; ++aIt )
-            if ( (*aIt)->page == req->pageNumber() && (*aIt)->observer == req->observer() )
-            {
-                AllocatedPixmap * p = *aIt;
-                m_allocatedPixmaps.erase( aIt );
-                m_allocatedPixmapsTotalMemory -= p->memory;
-                delete p;
-                break;
-            }
-
         DocumentObserver *observer = req->observer();
         if ( m_observers.contains(observer) )
         {
-            // [MEM] 1.2 append memory allocation descriptor to the FIFO
+            // [MEM] 1. update the memory allocation descriptor of the pixmap
             qulonglong memoryBytes = 0;
             const TilesManager *tm = req->d->tilesManager();
+            const QPixmap *pixmap = req->page()->d->m_pixmaps.value( observer ).m_pixmap;
             if ( tm )
                 memoryBytes = tm->totalMemory();
+            else if ( pixmap && pixmap->width() == req->width() && pixmap->height() == req->height() )
+                memoryBytes = pixmapMemory( pixmap );
             else
+                // not there yet when it is being rotated
                 memoryBytes = 4 * req->width() * req->height();
 
-            AllocatedPixmap * memoryPage = new AllocatedPixmap( req->observer(), req->pageNumber(), memoryBytes );
-            m_allocatedPixmaps.append( memoryPage );
-            m_allocatedPixmapsTotalMemory += memoryBytes;
+            registerAllocatedPixmap( observer, req->pageNumber(), memoryBytes );
+
+            // keep the pixmap for the next time the document is opened
+            if ( req->persistent() && !tm && m_rotation == Rotation0 && m_pixmapStore.isOpen() )
+            {
+                if ( pixmap && pixmap->width() == req->width() && pixmap->height() == req->height() )
+                    m_pixmapStore.setImage( req->pageNumber(), pixmap->toImage() );
+            }
 
             // 2. notify an observer that its pixmap changed
+            QElapsedTimer notificationTimer;
+            notificationTimer.start();
             observer->notifyPageChanged( req->pageNumber(), DocumentObserver::Pixmap );
+            recordRequestTimings( req, notificationTimer.nsecsElapsed() / 1000 );
         }
-#ifndef NDEBUG
         else
+        {
+            registerAllocatedPixmap( observer, req->pageNumber(), 0 );
+#ifndef NDEBUG
             qCWarning(OkularCoreDebug) << "Receiving a done request for the defunct observer" << observer;
 #endif
+        }
+    }
+    else
+    {
+        m_renderStatistics.cancelledPixmaps++;
     }
 
     // 3. delete request
@@ -5126,12 +5495,305 @@ void DocumentPrivate::requestDone( PixmapRequest * req )
 
     // 4. start a new generation if some is pending
     m_pixmapRequestsMutex.lock();
-    bool hasPixmaps = !m_pixmapRequestsStack.isEmpty();
+    bool hasPixmaps = !m_pixmapRequestsQueue.isEmpty();
     m_pixmapRequestsMutex.unlock();
     if ( hasPixmaps )
         sendGeneratorPixmapRequest();
 }
 
+void DocumentPrivate::recordRequestTimings( PixmapRequest *req, qint64 notificationTime )
+{
+    const PixmapRequestPrivate *rd = req->d;
+    // generators doing the work in their own generatePixmap() don't time
+    // the single steps, count everything since the submission as rendering
+    const qint64 generationTime = rd->mGenerationTime >= 0 ? rd->mGenerationTime : rd->mTimer.nsecsElapsed() / 1000 - notificationTime;
+
+    m_renderStatistics.renderedPixmaps++;
+    m_renderStatistics.queueTime += rd->mQueueTime;
+    m_renderStatistics.generationTime += generationTime;
+    m_renderStatistics.conversionTime += rd->mConversionTime;
+    m_renderStatistics.tilingTime += rd->mTilingTime;
+    m_renderStatistics.notificationTime += notificationTime;
+
+    qCDebug(OkularCoreDebug).nospace() << "request done observer=" << req->observer() << " page=" << req->pageNumber()
+        << " queue=" << rd->mQueueTime << "us generation=" << generationTime << "us conversion=" << rd->mConversionTime
+        << "us tiling=" << rd->mTilingTime << "us notification=" << notificationTime << "us";
+}
+
+void DocumentPrivate::recordTextPage( qint64 generationTime )
+{
+    m_renderStatistics.textPages++;
+    m_renderStatistics.textPageTime += generationTime;
+}
+
+void DocumentPrivate::registerAllocatedPixmap( DocumentObserver *observer, int page, qulonglong memory )
+{
+    // find and remove a previous entry for the same page and id
+    QLinkedList< AllocatedPixmap * >::iterator aIt = m_allocatedPixmaps.begin();
+    QLinkedList< AllocatedPixmap * >::iterator aEnd = m_allocatedPixmaps.end();
+    for ( ; aIt != aEnd; ++aIt )
+        if ( (*aIt)->page == page && (*aIt)->observer == observer )
+        {
+            AllocatedPixmap * p = *aIt;
+            m_allocatedPixmaps.erase( aIt );
+            m_allocatedPixmapsTotalMemory -= p->memory;
+            delete p;
+            break;
+        }
+
+    // append memory allocation descriptor to the FIFO
+    if ( memory > 0 )
+    {
+        m_allocatedPixmaps.append( new AllocatedPixmap( observer, page, memory ) );
+        m_allocatedPixmapsTotalMemory += memory;
+    }
+}
+
+bool DocumentPrivate::loadStoredPixmap( PixmapRequest *request )
+{
+    if ( !request->persistent() || request->isTile() || request->d->mForce || m_rotation != Rotation0 || !m_pixmapStore.isOpen() )
+        return false;
+
+    Page *page = request->page();
+    if ( page->hasPixmap( request->observer(), request->width(), request->height() ) )
+        return false;
+
+    if ( !m_pixmapStore.hasImage( request->pageNumber(), request->width(), request->height() ) )
+        return false;
+
+    // the newest request of the observer for the page replaces the older one
+    QLinkedList< PixmapRequest * >::iterator it = m_storedPixmapRequests.begin(), itEnd = m_storedPixmapRequests.end();
+    for ( ; it != itEnd; ++it )
+    {
+        if ( (*it)->observer() == request->observer() && (*it)->pageNumber() == request->pageNumber() )
+        {
+            delete *it;
+            m_storedPixmapRequests.erase( it );
+            break;
+        }
+    }
+
+    m_storedPixmapRequests.append( request );
+    m_pixmapStore.loadImage( request->pageNumber(), request->width(), request->height() );
+    return true;
+}
+
+void DocumentPrivate::storedPixmapsLoaded()
+{
+    bool hasQueuedRequests = false;
+    const QList< PixmapStore::LoadedImage > images = m_pixmapStore.takeLoadedImages();
+    for ( const PixmapStore::LoadedImage &loaded : images )
+    {
+        QLinkedList< PixmapRequest * >::iterator it = m_storedPixmapRequests.begin();
+        while ( it != m_storedPixmapRequests.end() )
+        {
+            PixmapRequest *request = *it;
+            if ( request->pageNumber() != loaded.page || request->width() != loaded.width || request->height() != loaded.height )
+            {
+                ++it;
+                continue;
+            }
+            it = m_storedPixmapRequests.erase( it );
+
+            Page *page = request->page();
+            if ( page->hasPixmap( request->observer(), request->width(), request->height() ) )
+            {
+                delete request;
+                continue;
+            }
+
+            // not readable, or the document was rotated meanwhile: render it
+            if ( loaded.image.isNull() || m_rotation != Rotation0 )
+            {
+                request->d->mTimer.start();
+                m_pixmapRequestsMutex.lock();
+                m_pixmapRequestsQueue.push( request );
+                m_pixmapRequestsMutex.unlock();
+                hasQueuedRequests = true;
+                continue;
+            }
+
+            QPixmap *pixmap = new QPixmap( pixmapFromImage( pixmapImage( loaded.image ) ) );
+            const qulonglong memory = pixmapMemory( pixmap );
+            page->d->setPixmap( request->observer(), pixmap, NormalizedRect(), false /*isPartialPixmap*/ );
+            registerAllocatedPixmap( request->observer(), request->pageNumber(), memory );
+            m_renderStatistics.cacheHits++;
+            request->observer()->notifyPageChanged( request->pageNumber(), DocumentObserver::Pixmap );
+            delete request;
+        }
+    }
+
+    if ( hasQueuedRequests )
+        sendGeneratorPixmapRequest();
+}
+
+void DocumentPrivate::keepCompressedPixmap( DocumentObserver *observer, int pageNumber )
+{
+    // the settings may have changed since the last time
+    const qulonglong memoryLimit = qulonglong( SettingsCore::compressedCacheSize() ) * 1024 * 1024;
+    const qulonglong diskLimit = qulonglong( SettingsCore::compressedCacheDiskSize() ) * 1024 * 1024;
+    m_compressedPixmapCache.setLimits( memoryLimit, diskLimit );
+    if ( memoryLimit == 0 || m_rotation != Rotation0 )
+        return;
+
+    // tiles are evicted one by one, not with the page
+    const Page *page = m_pagesVector.at( pageNumber );
+    if ( page->d->tilesManager( observer ) )
+        return;
+
+    QMap< DocumentObserver*, PagePrivate::PixmapObject >::const_iterator it = page->d->m_pixmaps.constFind( observer );
+    if ( it == page->d->m_pixmaps.constEnd() || !it.value().m_pixmap || it.value().m_rotation != Rotation0 )
+        return;
+
+    // the image shares the data of the pixmap, that can go right after
+    m_compressedPixmapCache.insert( observer, pageNumber, it.value().m_pixmap->toImage() );
+}
+
+bool DocumentPrivate::loadCompressedPixmap( PixmapRequest *request )
+{
+    if ( SettingsCore::compressedCacheSize() == 0 || request->isTile() || request->d->mForce || m_rotation != Rotation0 )
+        return false;
+
+    Page *page = request->page();
+    if ( page->d->tilesManager( request->observer() ) || page->hasPixmap( request->observer(), request->width(), request->height() ) )
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+    const QImage image = m_compressedPixmapCache.image( request->observer(), request->pageNumber(), request->width(), request->height() );
+    if ( image.isNull() )
+    {
+        m_renderStatistics.compressedCacheMisses++;
+        return false;
+    }
+
+    QPixmap *pixmap = new QPixmap( pixmapFromImage( image ) );
+    const qulonglong memory = pixmapMemory( pixmap );
+    page->d->setPixmap( request->observer(), pixmap, NormalizedRect(), false /*isPartialPixmap*/ );
+    registerAllocatedPixmap( request->observer(), request->pageNumber(), memory );
+
+    m_renderStatistics.compressedCacheHits++;
+    m_renderStatistics.decompressionTime += timer.nsecsElapsed() / 1000;
+    return true;
+}
+
+PixmapRequest *DocumentPrivate::previewRequest( PixmapRequest *request ) const
+{
+    // a preview has a quarter of the width and height, so it takes about a
+    // sixteenth of the time; not worth it for small pixmaps
+    static const int previewDivisor = 4;
+    static const long minimumPixels = 1000000L;
+    // keeps the preview itself well below the size that switches on tiles
+    static const long maximumPixels = 64000000L;
+
+    if ( !SettingsCore::previewRendering() || !m_generator->hasFeature( Generator::Threaded ) )
+        return nullptr;
+
+    // tiles have their own way of showing the previous zoom level, with
+    // any pixmap at all PagePainter already shows something scaled, and
+    // priority 0 requests are served newest first, so the preview wouldn't
+    // come before the request
+    if ( !request->asynchronous() || request->preload() || !request->priority() || request->isTile() || request->d->tilesManager()
+         || (long)request->width() * (long)request->height() < minimumPixels
+         || (long)request->width() * (long)request->height() > maximumPixels
+         || request->page()->hasPixmap( request->observer() ) )
+        return nullptr;
+
+    // the size is set afterwards as it is in device pixels already
+    PixmapRequest *preview = new PixmapRequest( request->observer(), request->pageNumber(), 1, 1, request->priority(), PixmapRequest::Asynchronous );
+    preview->d->mWidth = qMax( 1, request->width() / previewDivisor );
+    preview->d->mHeight = qMax( 1, request->height() / previewDivisor );
+    preview->d->mPage = request->page();
+    preview->d->mPreview = true;
+    return preview;
+}
+
+// the tiles covering some of @p rect, not only touching it
+static QList< Tile > tilesCovering( TilesManager *tilesManager, const NormalizedRect &rect )
+{
+    QList< Tile > tiles = tilesManager->tilesAt( rect, TilesManager::TerminalTile );
+    QList< Tile >::iterator it = tiles.begin();
+    while ( it != tiles.end() )
+    {
+        const NormalizedRect commonRect = it->rect() & rect;
+        if ( commonRect.width() <= 0 || commonRect.height() <= 0 )
+            it = tiles.erase( it );
+        else
+            ++it;
+    }
+    return tiles;
+}
+
+bool DocumentPrivate::isSingleTileRequest( PixmapRequest *request ) const
+{
+    const QList< Tile > tiles = tilesCovering( request->d->tilesManager(), request->normalizedRect() );
+    return tiles.count() == 1 && tiles.first().rect() == request->normalizedRect();
+}
+
+void DocumentPrivate::queueTileRequests( PixmapRequest *request )
+{
+    struct TileToRender
+    {
+        NormalizedRect rect;
+        bool visible;
+        double distance;
+    };
+
+    // the tiles in the visible part of the page go first, then the ones
+    // closest to its center
+    NormalizedRect visibleRect = request->normalizedRect();
+    for ( const VisiblePageRect *vRect : qAsConst( m_pageRects ) )
+    {
+        if ( vRect->pageNumber == request->pageNumber() )
+        {
+            visibleRect = vRect->rect;
+            break;
+        }
+    }
+    const double centerX = ( visibleRect.left + visibleRect.right ) / 2;
+    const double centerY = ( visibleRect.top + visibleRect.bottom ) / 2;
+
+    QVector< TileToRender > tilesToRender;
+    const QList< Tile > tiles = tilesCovering( request->d->tilesManager(), request->normalizedRect() );
+    for ( const Tile &tile : tiles )
+    {
+        if ( tile.isValid() && !request->d->mForce )
+            continue;
+
+        const NormalizedRect visiblePart = tile.rect() & visibleRect;
+        const double dx = ( tile.rect().left + tile.rect().right ) / 2 - centerX;
+        const double dy = ( tile.rect().top + tile.rect().bottom ) / 2 - centerY;
+        const TileToRender tileToRender = { tile.rect(), visiblePart.width() > 0 && visiblePart.height() > 0, dx * dx + dy * dy };
+        tilesToRender.append( tileToRender );
+    }
+    std::sort( tilesToRender.begin(), tilesToRender.end(), []( const TileToRender &a, const TileToRender &b ) {
+        if ( a.visible != b.visible )
+            return a.visible;
+        return a.distance < b.distance;
+    } );
+
+    // priority 0 requests are served newest first
+    if ( request->priority() == 0 )
+        std::reverse( tilesToRender.begin(), tilesToRender.end() );
+
+    for ( const TileToRender &tileToRender : qAsConst( tilesToRender ) )
+    {
+        // the size is set afterwards as it is in device pixels already
+        PixmapRequest *tileRequest = new PixmapRequest( request->observer(), request->pageNumber(), 1, 1, request->priority(), PixmapRequest::NoFeature );
+        tileRequest->d->mWidth = request->width();
+        tileRequest->d->mHeight = request->height();
+        tileRequest->d->mFeatures = request->d->mFeatures;
+        tileRequest->d->mForce = request->d->mForce;
+        tileRequest->d->mPartialUpdatesWanted = request->d->mPartialUpdatesWanted;
+        tileRequest->d->mPage = request->page();
+        // the time in the queue counts from the original request
+        tileRequest->d->mTimer = request->d->mTimer;
+        tileRequest->setTile( true );
+        tileRequest->setNormalizedRect( tileToRender.rect );
+        m_pixmapRequestsQueue.push( tileRequest );
+    }
+}
+
 void DocumentPrivate::setPageBoundingBox( int page, const NormalizedRect& boundingBox )
 {
     Page * kp = m_pagesVector[ page ];
@@ -5193,6 +5855,14 @@ void DocumentPrivate::textGenerationDone( Page *page )
     m_allocatedTextPagesFifo.append( page->number() );
 }
 
+void DocumentPrivate::pageContentsLoaded( int page )
+{
+    if ( page < 0 || page >= m_pagesVector.count() )
+        return;
+
+    foreachObserverD( notifyPageChanged( page, DocumentObserver::Annotations | DocumentObserver::PageContents ) );
+}
+
 void Document::setRotation( int r )
 {
     d->setRotationInternal( r, true );
@@ -5245,6 +5915,7 @@ void Document::setPageSize( const PageSize &size )
     qDeleteAll( d->m_allocatedPixmaps );
     d->m_allocatedPixmaps.clear();
     d->m_allocatedPixmapsTotalMemory = 0;
+    d->m_compressedPixmapCache.clear();
     // notify the generator that the current page size has changed
     d->m_generator->pageSizeChanged( size, d->m_pageSize );
     // set the new page size
@@ -5609,6 +6280,174 @@ VisiblePageRect::VisiblePageRect( int page, const NormalizedRect &rectangle )
 {
 }
 
+RenderStatisticsPrivate::RenderStatisticsPrivate()
+    : renderedPixmaps( 0 ), cancelledPixmaps( 0 ), cacheHits( 0 ), cacheMisses( 0 ),
+      queueTime( 0 ), generationTime( 0 ), conversionTime( 0 ), tilingTime( 0 ), notificationTime( 0 ),
+      textPages( 0 ), textPageTime( 0 ),
+      evictedPixmaps( 0 ), evictedMemory( 0 ), evictionTime( 0 ),
+      allocatedPixmaps( 0 ), allocatedMemory( 0 ),
+      compressedCacheHits( 0 ), compressedCacheMisses( 0 ), decompressionTime( 0 ),
+      compressedPixmaps( 0 ), compressedMemory( 0 ), compressedDiskMemory( 0 ),
+      tilePoolHits( 0 ), tilePoolMisses( 0 ), tilePoolMemory( 0 ), tileNodes( 0 ), allocatedTileNodes( 0 )
+{
+}
+
+RenderStatistics::RenderStatistics()
+    : d( new RenderStatisticsPrivate() )
+{
+}
+
+RenderStatistics::RenderStatistics( const RenderStatistics &statistics )
+    : d( new RenderStatisticsPrivate( *statistics.d ) )
+{
+}
+
+RenderStatistics& RenderStatistics::operator=( const RenderStatistics &statistics )
+{
+    *d = *statistics.d;
+    return *this;
+}
+
+RenderStatistics::~RenderStatistics()
+{
+    delete d;
+}
+
+int RenderStatistics::renderedPixmaps() const
+{
+    return d->renderedPixmaps;
+}
+
+int RenderStatistics::cancelledPixmaps() const
+{
+    return d->cancelledPixmaps;
+}
+
+int RenderStatistics::cacheHits() const
+{
+    return d->cacheHits;
+}
+
+int RenderStatistics::cacheMisses() const
+{
+    return d->cacheMisses;
+}
+
+qint64 RenderStatistics::queueTime() const
+{
+    return d->queueTime;
+}
+
+qint64 RenderStatistics::generationTime() const
+{
+    return d->generationTime;
+}
+
+qint64 RenderStatistics::conversionTime() const
+{
+    return d->conversionTime;
+}
+
+qint64 RenderStatistics::tilingTime() const
+{
+    return d->tilingTime;
+}
+
+qint64 RenderStatistics::notificationTime() const
+{
+    return d->notificationTime;
+}
+
+int RenderStatistics::textPages() const
+{
+    return d->textPages;
+}
+
+qint64 RenderStatistics::textPageTime() const
+{
+    return d->textPageTime;
+}
+
+int RenderStatistics::evictedPixmaps() const
+{
+    return d->evictedPixmaps;
+}
+
+qulonglong RenderStatistics::evictedMemory() const
+{
+    return d->evictedMemory;
+}
+
+qint64 RenderStatistics::evictionTime() const
+{
+    return d->evictionTime;
+}
+
+int RenderStatistics::allocatedPixmaps() const
+{
+    return d->allocatedPixmaps;
+}
+
+qulonglong RenderStatistics::allocatedMemory() const
+{
+    return d->allocatedMemory;
+}
+
+int RenderStatistics::compressedCacheHits() const
+{
+    return d->compressedCacheHits;
+}
+
+int RenderStatistics::compressedCacheMisses() const
+{
+    return d->compressedCacheMisses;
+}
+
+qint64 RenderStatistics::decompressionTime() const
+{
+    return d->decompressionTime;
+}
+
+int RenderStatistics::compressedPixmaps() const
+{
+    return d->compressedPixmaps;
+}
+
+qulonglong RenderStatistics::compressedMemory() const
+{
+    return d->compressedMemory;
+}
+
+qulonglong RenderStatistics::compressedDiskMemory() const
+{
+    return d->compressedDiskMemory;
+}
+
+int RenderStatistics::tilePoolHits() const
+{
+    return d->tilePoolHits;
+}
+
+int RenderStatistics::tilePoolMisses() const
+{
+    return d->tilePoolMisses;
+}
+
+qulonglong RenderStatistics::tilePoolMemory() const
+{
+    return d->tilePoolMemory;
+}
+
+int RenderStatistics::tileNodes() const
+{
+    return d->tileNodes;
+}
+
+int RenderStatistics::allocatedTileNodes() const
+{
+    return d->allocatedTileNodes;
+}
+
 #undef foreachObserver
 #undef foreachObserverD
 
@@ -57,6 +57,8 @@ class Action;
 class MovieAction;
 class Page;
 class PixmapRequest;
+class RenderStatistics;
+class RenderStatisticsPrivate;
 class RenditionAction;
 class SourceReference;
 class View;
@@ -227,6 +229,19 @@ class OKULARCORE_EXPORT Document : public QObject
          */
         void closeDocument();
 
+        /**
+         * Keeps the rendered contents (pixmaps, text, links and bounding boxes)
+         * of the pages of the current document when it is closed, so that opening
+         * the same file again reuses them for the pages that did not change.
+         * They are kept until the file opens again, or another file is opened.
+         *
+         * This has no effect if the generator does not report page
+         * fingerprints through the "PageFingerprints" metadata key.
+         *
+         * @since 1.5
+         */
+        void prepareReload();
+
         /**
          * Registers a new @p observer for the document.
          */
@@ -392,6 +407,8 @@ class OKULARCORE_EXPORT Document : public QObject
         /**
          * Returns the meta data for the given @p key and @p option or an empty variant
          * if the key doesn't exists.
+         *
+         * The "RenderStatistics" key returns renderStatistics() as a QVariantMap.
          */
         QVariant metaData( const QString & key, const QVariant & option = QVariant() ) const;
 
@@ -412,6 +429,31 @@ class OKULARCORE_EXPORT Document : public QObject
          */
         QString pageSizeString( int page ) const;
 
+        /**
+         * Returns the physical size of the given @p page in inches, or an
+         * invalid size if the page is out of range or the generator does
+         * not know the physical size of its pages.
+         *
+         * @since 1.5
+         */
+        QSizeF pageSizeInInches( int page ) const;
+
+        /**
+         * Returns the counters and timings of the pixmap and text page
+         * generation since the document was opened, or since the last
+         * resetRenderStatistics().
+         *
+         * @since 1.5
+         */
+        RenderStatistics renderStatistics() const;
+
+        /**
+         * Sets all the counters and timings of renderStatistics() back to zero.
+         *
+         * @since 1.5
+         */
+        void resetRenderStatistics();
+
         /**
          * Returns the gui client of the generator, if it provides one.
          */
@@ -1222,6 +1264,7 @@ class OKULARCORE_EXPORT Document : public QObject
         Q_PRIVATE_SLOT( d, void fontReadingGotFont( const Okular::FontInfo& font ) )
         Q_PRIVATE_SLOT( d, void slotGeneratorConfigChanged( const QString& ) )
         Q_PRIVATE_SLOT( d, void refreshPixmaps( int ) )
+        Q_PRIVATE_SLOT( d, void storedPixmapsLoaded() )
         Q_PRIVATE_SLOT( d, void _o_configChanged() )
 
         // search thread simulators
@@ -1420,6 +1463,140 @@ class OKULARCORE_EXPORT VisiblePageRect
         NormalizedRect rect;
 };
 
+/**
+ * @short Counters and timings of the rendering of a document
+ *
+ * The times are in microseconds and summed over all the requests, divide
+ * them by the matching count for the averages.
+ *
+ * @since 1.5
+ */
+class OKULARCORE_EXPORT RenderStatistics
+{
+    friend class Document;
+
+    public:
+        /**
+         * Creates statistics with all the values set to zero.
+         */
+        RenderStatistics();
+
+        /**
+         * Creates a copy of the given @p statistics.
+         */
+        RenderStatistics( const RenderStatistics &statistics );
+
+        /**
+         * Destroys the statistics.
+         */
+        ~RenderStatistics();
+
+        RenderStatistics& operator=( const RenderStatistics &statistics );
+
+        /**
+         * The number of pixmap requests the generator finished.
+         */
+        int renderedPixmaps() const;
+
+        /**
+         * The number of pixmap requests cancelled while being rendered.
+         */
+        int cancelledPixmaps() const;
+
+        /**
+         * The number of pixmap requests served without rendering, because
+         * the pixmap was already in memory, kept compressed or stored on disk.
+         */
+        int cacheHits() const;
+
+        /**
+         * The number of pixmap requests sent to the generator.
+         */
+        int cacheMisses() const;
+
+        /**
+         * The time pixmap requests waited in the queue before being
+         * sent to the generator.
+         */
+        qint64 queueTime() const;
+
+        /**
+         * The time the generator took to render the images.
+         */
+        qint64 generationTime() const;
+
+        /**
+         * The time spent converting the images of the generator to pixmaps.
+         */
+        qint64 conversionTime() const;
+
+        /**
+         * The time spent splitting the pixmaps of tiled pages into tiles.
+         */
+        qint64 tilingTime() const;
+
+        /**
+         * The time the observers took to handle the new pixmaps.
+         */
+        qint64 notificationTime() const;
+
+        /**
+         * The number of text pages generated, and the time it took.
+         */
+        int textPages() const;
+        qint64 textPageTime() const;
+
+        /**
+         * The number of pixmaps evicted from the cache, the memory they used
+         * (including the one of single tiles) and the time the eviction took.
+         */
+        int evictedPixmaps() const;
+        qulonglong evictedMemory() const;
+        qint64 evictionTime() const;
+
+        /**
+         * The number of pixmaps currently in the cache and the memory they use.
+         */
+        int allocatedPixmaps() const;
+        qulonglong allocatedMemory() const;
+
+        /**
+         * The number of pixmap requests served from the compressed pixmaps
+         * evicted before, the number of them not found there, and the time
+         * the decompression took.
+         */
+        int compressedCacheHits() const;
+        int compressedCacheMisses() const;
+        qint64 decompressionTime() const;
+
+        /**
+         * The number of evicted pixmaps kept compressed, and the memory they
+         * take in memory and on disk.
+         */
+        int compressedPixmaps() const;
+        qulonglong compressedMemory() const;
+        qulonglong compressedDiskMemory() const;
+
+        /**
+         * The number of tile pixmaps made in a reused buffer of the tile
+         * pool and in a new one, and the memory of the buffers waiting to
+         * be reused. These are shared by all the documents.
+         */
+        int tilePoolHits() const;
+        int tilePoolMisses() const;
+        qulonglong tilePoolMemory() const;
+
+        /**
+         * The number of tile nodes in use and allocated, for all the
+         * documents.
+         */
+        int tileNodes() const;
+        int allocatedTileNodes() const;
+
+    private:
+        RenderStatisticsPrivate *d;
+};
+
 }
 
 Q_DECLARE_METATYPE( Okular::DocumentInfo::Key )
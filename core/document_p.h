@@ -26,17 +26,22 @@
 
 // local includes
 #include "fontinfo.h"
+#include "compressedpixmapcache_p.h"
 #include "generator.h"
+#include "pixmaprequestqueue_p.h"
+#include "pixmapstore_p.h"
 
 class QUndoStack;
 class QEventLoop;
 class QFile;
 class QTimer;
 class QTemporaryFile;
+class QXmlStreamWriter;
 class KPluginMetaData;
 
 struct AllocatedPixmap;
 struct ArchiveData;
+struct ReloadData;
 struct RunningSearch;
 
 namespace Okular {
@@ -83,6 +88,41 @@ enum LoadDocumentInfoFlag
 };
 Q_DECLARE_FLAGS(LoadDocumentInfoFlags, LoadDocumentInfoFlag)
 
+// the values of RenderStatistics, see there; times in microseconds
+class RenderStatisticsPrivate
+{
+    public:
+        RenderStatisticsPrivate();
+
+        int renderedPixmaps;
+        int cancelledPixmaps;
+        int cacheHits;
+        int cacheMisses;
+        qint64 queueTime;
+        qint64 generationTime;
+        qint64 conversionTime;
+        qint64 tilingTime;
+        qint64 notificationTime;
+        int textPages;
+        qint64 textPageTime;
+        int evictedPixmaps;
+        qulonglong evictedMemory;
+        qint64 evictionTime;
+        int allocatedPixmaps;
+        qulonglong allocatedMemory;
+        int compressedCacheHits;
+        int compressedCacheMisses;
+        qint64 decompressionTime;
+        int compressedPixmaps;
+        qulonglong compressedMemory;
+        qulonglong compressedDiskMemory;
+        int tilePoolHits;
+        int tilePoolMisses;
+        qulonglong tilePoolMemory;
+        int tileNodes;
+        int allocatedTileNodes;
+};
+
 class DocumentPrivate
 {
     public:
@@ -105,6 +145,7 @@ class DocumentPrivate
             m_closingLoop( nullptr ),
             m_scripter( nullptr ),
             m_archiveData( nullptr ),
+            m_reloadData( nullptr ),
             m_fontsCached( false ),
             m_annotationEditingEnabled ( true ),
             m_annotationBeingModified( false ),
@@ -119,6 +160,7 @@ class DocumentPrivate
         QString pagesSizeString() const;
         QString namePaperSize(double inchesWidth, double inchesHeight) const;
         QString localizedSize(const QSizeF &size) const;
+        QSizeF sizeInInches(const QSizeF &size) const;
         qulonglong calculateMemoryToFree();
         void cleanupPixmapMemory();
         void cleanupPixmapMemory( qulonglong memoryToFree );
@@ -129,7 +171,8 @@ class DocumentPrivate
         bool loadDocumentInfo( LoadDocumentInfoFlags loadWhat );
         bool loadDocumentInfo( QFile &infoFile, LoadDocumentInfoFlags loadWhat );
         void loadViewsInfo( View *view, const QDomElement &e );
-        void saveViewsInfo( View *view, QDomElement &e ) const;
+        void saveViewsInfo( View *view, QXmlStreamWriter &writer ) const;
+        void savePageList( QXmlStreamWriter &writer, int what ) const;
         QUrl giveAbsoluteUrl( const QString & fileName ) const;
         bool openRelativeFile( const QString & fileName );
         Generator * loadGeneratorLibrary( const KPluginMetaData& service );
@@ -142,6 +185,16 @@ class DocumentPrivate
         SaveInterface* generatorSave( GeneratorInfo& info );
         Document::OpenResult openDocumentInternal( const KPluginMetaData& offer, bool isstdin, const QString& docFile, const QByteArray& filedata, const QString& password );
         static ArchiveData *unpackDocumentArchive( const QString &archivePath );
+        void stashPagesForReload();
+        void registerAllocatedPixmap( DocumentObserver *observer, int page, qulonglong memory );
+        void recordRequestTimings( PixmapRequest *request, qint64 notificationTime );
+        bool loadStoredPixmap( PixmapRequest *request );
+        void keepCompressedPixmap( DocumentObserver *observer, int page );
+        bool loadCompressedPixmap( PixmapRequest *request );
+        PixmapRequest *previewRequest( PixmapRequest *request ) const;
+        bool isSingleTileRequest( PixmapRequest *request ) const;
+        void queueTileRequests( PixmapRequest *request );
+        void adoptReloadedPages( ReloadData *reloadData );
         bool savePageDocumentInfo( QTemporaryFile *infoFile, int what ) const;
         DocumentViewport nextDocumentViewport() const;
         void notifyAnnotationChanges( int page );
@@ -169,6 +222,7 @@ class DocumentPrivate
         void fontReadingGotFont( const Okular::FontInfo& font );
         void slotGeneratorConfigChanged( const QString& );
         void refreshPixmaps( int );
+        void storedPixmapsLoaded();
         void _o_configChanged();
         void doContinueDirectionMatchSearch(void *doContinueDirectionMatchSearchStruct);
         void doContinueAllDocumentSearch(void *pagesToNotifySet, void *pageMatchesMap, int currentPage, int searchID);
@@ -183,6 +237,11 @@ class DocumentPrivate
          */
         void requestDone( PixmapRequest * request );
         void textGenerationDone( Page *page );
+        void pageContentsLoaded( int page );
+        /**
+         * Adds a text page that took @p generationTime microseconds to the statistics.
+         */
+        void recordTextPage( qint64 generationTime );
         /**
          * Sets the bounding box of the given @p page (in terms of upright orientation, i.e., Rotation0).
          */
@@ -231,14 +290,17 @@ class DocumentPrivate
 
         // observers / requests / allocator stuff
         QSet< DocumentObserver * > m_observers;
-        QLinkedList< PixmapRequest * > m_pixmapRequestsStack;
+        PixmapRequestQueue m_pixmapRequestsQueue;
         QLinkedList< PixmapRequest * > m_executingPixmapRequests;
+        // waiting for their pixmap to be read from the pixmap store
+        QLinkedList< PixmapRequest * > m_storedPixmapRequests;
         QMutex m_pixmapRequestsMutex;
         QLinkedList< AllocatedPixmap * > m_allocatedPixmaps;
         qulonglong m_allocatedPixmapsTotalMemory;
         QList< int > m_allocatedTextPagesFifo;
         int m_maxAllocatedTextPages;
         bool m_warnedOutOfMemory;
+        RenderStatisticsPrivate m_renderStatistics;
 
         // the rotation applied to the document
         Rotation m_rotation;
@@ -279,6 +341,15 @@ class DocumentPrivate
         ArchiveData *m_archiveData;
         QString m_archivedFileName;
 
+        // rendered contents kept between closing and reopening the document
+        ReloadData *m_reloadData;
+
+        // pixmaps of persistent requests, kept on disk across sessions
+        PixmapStore m_pixmapStore;
+
+        // evicted pixmaps, kept compressed
+        CompressedPixmapCache m_compressedPixmapCache;
+
         QPointer< FontExtractionThread > m_fontThread;
         bool m_fontsCached;
         QSet<DocumentInfo::Key> m_documentInfoAskedKeys;
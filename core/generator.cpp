@@ -22,6 +22,7 @@
 #include <QtCore/QDebug>
 #include <QIcon>
 #include <QMimeDatabase>
+#include <QThreadPool>
 #include <QTimer>
 #include <KLocalizedString>
 
@@ -35,12 +36,14 @@
 #include "page_p.h"
 #include "textpage.h"
 #include "utils.h"
+#include "utils_p.h"
 
 using namespace Okular;
 
 GeneratorPrivate::GeneratorPrivate()
     : m_document( nullptr ),
       mPixmapGenerationThread( nullptr ), mTextPageGenerationThread( nullptr ),
+      mTilesThreadPool( nullptr ), mRunningTiles( 0 ),
       m_mutex( nullptr ), m_threadsMutex( nullptr ), mPixmapReady( true ), mTextPageReady( true ),
       m_closing( false ), m_closingLoop( nullptr ),
       m_dpi(72.0, 72.0)
@@ -60,6 +63,12 @@ GeneratorPrivate::~GeneratorPrivate()
 
     delete mTextPageGenerationThread;
 
+    if ( mTilesThreadPool )
+        mTilesThreadPool->waitForDone();
+
+    delete mTilesThreadPool;
+    qDeleteAll( mFinishedTiles );
+
     delete m_mutex;
     delete m_threadsMutex;
 }
@@ -90,6 +99,28 @@ TextPageGenerationThread* GeneratorPrivate::textPageGenerationThread()
     return mTextPageGenerationThread;
 }
 
+QThreadPool* GeneratorPrivate::tilesThreadPool()
+{
+    if ( mTilesThreadPool )
+        return mTilesThreadPool;
+
+    // the jobs use the mutexes, create them before they can race for it
+    Q_Q( Generator );
+    q->userMutex();
+    threadsLock();
+
+    // more threads than that mostly compete for the memory bandwidth
+    mTilesThreadPool = new QThreadPool();
+    mTilesThreadPool->setMaxThreadCount( qBound( 1, QThread::idealThreadCount(), 4 ) );
+
+    return mTilesThreadPool;
+}
+
+bool GeneratorPrivate::isIdle() const
+{
+    return mPixmapReady && mTextPageReady && mRunningTiles == 0;
+}
+
 void GeneratorPrivate::pixmapGenerationFinished()
 {
     Q_Q( Generator );
@@ -103,7 +134,7 @@ void GeneratorPrivate::pixmapGenerationFinished()
     {
         mPixmapReady = true;
         delete request;
-        if ( mTextPageReady )
+        if ( isIdle() )
         {
             locker.unlock();
             m_closingLoop->quit();
@@ -114,7 +145,7 @@ void GeneratorPrivate::pixmapGenerationFinished()
 
     if ( !request->shouldAbortRender() )
     {
-        request->page()->setPixmap( request->observer(), new QPixmap( QPixmap::fromImage( img ) ), request->normalizedRect() );
+        setRequestPixmap( request, img );
         const int pageNumber = request->page()->number();
 
         if ( mPixmapGenerationThread->calcBoundingBox() )
@@ -145,7 +176,7 @@ void GeneratorPrivate::textpageGenerationFinished()
     if ( m_closing )
     {
         delete mTextPageGenerationThread->textPage();
-        if ( mPixmapReady )
+        if ( isIdle() )
         {
             locker.unlock();
             m_closingLoop->quit();
@@ -156,11 +187,58 @@ void GeneratorPrivate::textpageGenerationFinished()
     if ( mTextPageGenerationThread->textPage() )
     {
         TextPage *tp = mTextPageGenerationThread->textPage();
+        if ( m_document )
+            m_document->recordTextPage( mTextPageGenerationThread->generationTime() );
         page->setTextPage( tp );
         q->signalTextGenerationDone( page, tp );
     }
 }
 
+void GeneratorPrivate::tileGenerationFinished()
+{
+    Q_Q( Generator );
+    QMutexLocker locker( threadsLock() );
+    const QList< PixmapRequest * > finishedTiles = mFinishedTiles;
+    mFinishedTiles.clear();
+    mRunningTiles -= finishedTiles.count();
+
+    if ( m_closing )
+    {
+        qDeleteAll( finishedTiles );
+        if ( !finishedTiles.isEmpty() && isIdle() )
+        {
+            locker.unlock();
+            m_closingLoop->quit();
+        }
+        return;
+    }
+
+    locker.unlock();
+
+    for ( PixmapRequest *request : finishedTiles )
+    {
+        if ( !request->shouldAbortRender() )
+            setRequestPixmap( request, PixmapRequestPrivate::get( request )->mResultImage );
+
+        q->signalPixmapRequestDone( request );
+    }
+}
+
+void GeneratorPrivate::setRequestPixmap( PixmapRequest *request, const QImage &image )
+{
+    PixmapRequestPrivate *requestPrivate = PixmapRequestPrivate::get( request );
+    QElapsedTimer timer;
+    timer.start();
+    QPixmap *pixmap = new QPixmap( pixmapFromImage( image ) );
+    requestPrivate->mConversionTime = timer.nsecsElapsed() / 1000;
+
+    // for tiled pages this is where the pixmap gets split into the tiles
+    timer.restart();
+    request->page()->setPixmap( request->observer(), pixmap, request->normalizedRect() );
+    if ( request->isTile() )
+        requestPrivate->mTilingTime = timer.nsecsElapsed() / 1000;
+}
+
 QMutex* GeneratorPrivate::threadsLock()
 {
     if ( !m_threadsMutex )
@@ -232,7 +310,7 @@ bool Generator::closeDocument()
     d->m_closing = true;
 
     d->threadsLock()->lock();
-    if ( !( d->mPixmapReady && d->mTextPageReady ) )
+    if ( !d->isIdle() )
     {
         QEventLoop loop;
         d->m_closingLoop = &loop;
@@ -258,12 +336,35 @@ bool Generator::closeDocument()
 bool Generator::canGeneratePixmap() const
 {
     Q_D( const Generator );
+    if ( d->mTilesThreadPool )
+        return d->mPixmapReady && d->mRunningTiles < d->mTilesThreadPool->maxThreadCount();
+
     return d->mPixmapReady;
 }
 
 void Generator::generatePixmap( PixmapRequest *request )
 {
     Q_D( Generator );
+
+    // the tiles get a thread each, while the whole pages keep going
+    // through the pixmap generation thread
+    if ( request->isTile() && request->asynchronous() && hasFeature( Threaded ) && hasFeature( ParallelTileRendering ) )
+    {
+        QThreadPool *threadPool = d->tilesThreadPool();
+        d->threadsLock()->lock();
+        ++d->mRunningTiles;
+        d->threadsLock()->unlock();
+        threadPool->start( new TileGenerationJob( this, request ) );
+
+        if ( hasFeature( TextExtraction ) && !request->page()->hasTextPage() && canGenerateTextPage() && !d->m_closing ) {
+            d->mTextPageReady = false;
+            d->textPageGenerationThread()->setPage( request->page() );
+            d->textPageGenerationThread()->startGeneration();
+        }
+
+        return;
+    }
+
     d->mPixmapReady = false;
 
     const bool calcBoundingBox = !request->isTile() && !request->page()->isBoundingBoxKnown();
@@ -301,8 +402,11 @@ void Generator::generatePixmap( PixmapRequest *request )
         return;
     }
 
-    const QImage& img = image( request );
-    request->page()->setPixmap( request->observer(), new QPixmap( QPixmap::fromImage( img ) ), request->normalizedRect() );
+    QElapsedTimer timer;
+    timer.start();
+    const QImage img = pixmapImage( image( request ) );
+    PixmapRequestPrivate::get( request )->mGenerationTime = timer.nsecsElapsed() / 1000;
+    d->setRequestPixmap( request, img );
     const int pageNumber = request->page()->number();
 
     d->mPixmapReady = true;
@@ -459,6 +563,13 @@ void Generator::signalPartialPixmapRequest( PixmapRequest *request, const QImage
     request->observer()->notifyPageChanged( pageNumber, Okular::DocumentObserver::Pixmap );
 }
 
+void Generator::signalPageContentsLoaded( int page )
+{
+    Q_D( Generator );
+    if ( d->m_document )
+        d->m_document->pageContentsLoaded( page );
+}
+
 const Document * Generator::document() const
 {
     Q_D( const Generator );
@@ -591,7 +702,12 @@ PixmapRequest::PixmapRequest( DocumentObserver *observer, int pageNumber, int wi
     d->mTile = false;
     d->mNormalizedRect = NormalizedRect();
     d->mPartialUpdatesWanted = false;
+    d->mPreview = false;
     d->mShouldAbortRender = 0;
+    d->mQueueTime = 0;
+    d->mGenerationTime = -1;
+    d->mConversionTime = 0;
+    d->mTilingTime = 0;
 }
 
 PixmapRequest::~PixmapRequest()
@@ -634,6 +750,11 @@ bool PixmapRequest::preload() const
     return d->mFeatures & Preload;
 }
 
+bool PixmapRequest::persistent() const
+{
+    return d->mFeatures & Persistent;
+}
+
 Page* PixmapRequest::page() const
 {
     return d->mPage;
@@ -810,6 +931,7 @@ QDebug operator<<( QDebug str, const Okular::PixmapRequest &req )
     str << "- tile:" << ( req.isTile() ? "true" : "false" );
     str << "- rect:" << req.normalizedRect();
     str << "- preload:" << ( req.preload() ? "true" : "false" );
+    str << "- persistent:" << ( req.persistent() ? "true" : "false" );
     str << "- partialUpdates:" << ( req.partialUpdatesWanted() ? "true" : "false" );
     str << "- shouldAbort:" << ( req.shouldAbortRender() ? "true" : "false" );
     str << "- force:" << ( reqPriv->mForce ? "true" : "false" );
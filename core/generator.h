@@ -194,6 +194,7 @@ class OKULARCORE_EXPORT Generator : public QObject
     /// @cond PRIVATE
     friend class PixmapGenerationThread;
     friend class TextPageGenerationThread;
+    friend class TileGenerationJob;
     /// @endcond
 
     Q_OBJECT
@@ -215,7 +216,8 @@ class OKULARCORE_EXPORT Generator : public QObject
             PrintToFile,       ///< Whether the Generator supports export to PDF & PS through the Print Dialog
             TiledRendering,    ///< Whether the Generator can render tiles @since 0.16 (KDE 4.10)
             SwapBackingFile,   ///< Whether the Generator can hot-swap the file it's reading from @since 1.3
-            SupportsCancelling ///< Whether the Generator can cancel requests @since 1.4
+            SupportsCancelling, ///< Whether the Generator can cancel requests @since 1.4
+            ParallelTileRendering ///< Whether the Generator can render several tiles at the same time, from different threads @since 1.5
         };
 
         /**
@@ -524,7 +526,9 @@ class OKULARCORE_EXPORT Generator : public QObject
          * Must return a null image if the request was cancelled and the generator supports cancelling
          *
          * @warning this method may be executed in its own separated thread if the
-         * @ref Threaded is enabled!
+         * @ref Threaded is enabled! With @ref ParallelTileRendering it may be
+         * executed for several tiles at the same time, hold userMutex() only
+         * while using what the other calls can change.
          */
         virtual QImage image( PixmapRequest *page );
 
@@ -615,6 +619,15 @@ class OKULARCORE_EXPORT Generator : public QObject
          */
         void signalPartialPixmapRequest( Okular::PixmapRequest *request, const QImage &image );
 
+        /**
+         * This method can be called by generators that fill in the annotations,
+         * form fields, transition or actions of the page @p page only after
+         * loading the document, so that the observers pick them up.
+         * Make sure you call it in the main thread.
+         * @since 1.5
+         */
+        void signalPageContentsLoaded( int page );
+
     protected:
         /// @cond PRIVATE
         Generator(GeneratorPrivate &dd, QObject *parent, const QVariantList &args);
@@ -630,6 +643,7 @@ class OKULARCORE_EXPORT Generator : public QObject
 
         Q_PRIVATE_SLOT( d_func(), void pixmapGenerationFinished() )
         Q_PRIVATE_SLOT( d_func(), void textpageGenerationFinished() )
+        Q_PRIVATE_SLOT( d_func(), void tileGenerationFinished() )
 };
 
 /**
@@ -639,13 +653,15 @@ class OKULARCORE_EXPORT PixmapRequest
 {
     friend class Document;
     friend class DocumentPrivate;
+    friend class PixmapRequestQueue;
 
     public:
         enum PixmapRequestFeature
         {
             NoFeature = 0,
             Asynchronous = 1,
-            Preload = 2
+            Preload = 2,
+            Persistent = 4 ///< The pixmap can be stored on disk and reused when the document is opened again @since 1.5
         };
         Q_DECLARE_FLAGS( PixmapRequestFeatures, PixmapRequestFeature )
 
@@ -707,6 +723,15 @@ class OKULARCORE_EXPORT PixmapRequest
          */
         bool preload() const;
 
+        /**
+         * Returns whether the generated pixmap can be stored on disk and
+         * reused when the same document is opened again, instead of being
+         * generated again.
+         *
+         * @since 1.5
+         */
+        bool persistent() const;
+
         /**
          * Returns a pointer to the page where the pixmap shall be generated for.
          */
@@ -10,10 +10,12 @@
 #include "generator_p.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QMutexLocker>
 
 #include "fontinfo.h"
 #include "generator.h"
 #include "utils.h"
+#include "utils_p.h"
 
 using namespace Okular;
 
@@ -59,7 +61,13 @@ void PixmapGenerationThread::run()
 {
     if ( mRequest )
     {
-        PixmapRequestPrivate::get(mRequest)->mResultImage = mGenerator->image( mRequest );
+        QElapsedTimer timer;
+        timer.start();
+        // the pixmap cache keeps gray pages in a compact format, and the
+        // others in the format of the pixmaps; convert here rather than in
+        // the GUI thread, where the pixmap then just shares the image
+        PixmapRequestPrivate::get(mRequest)->mResultImage = pixmapImage( mGenerator->image( mRequest ) );
+        PixmapRequestPrivate::get(mRequest)->mGenerationTime = timer.nsecsElapsed() / 1000;
 
         if ( mCalcBoundingBox )
             mBoundingBox = Utils::imageBoundingBox( &PixmapRequestPrivate::get(mRequest)->mResultImage );
@@ -67,8 +75,31 @@ void PixmapGenerationThread::run()
 }
 
 
+TileGenerationJob::TileGenerationJob( Generator *generator, PixmapRequest *request )
+    : mGenerator( generator ), mRequest( request )
+{
+}
+
+void TileGenerationJob::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+    PixmapRequestPrivate::get(mRequest)->mResultImage = pixmapImage( mGenerator->image( mRequest ) );
+    PixmapRequestPrivate::get(mRequest)->mGenerationTime = timer.nsecsElapsed() / 1000;
+
+    GeneratorPrivate *generatorPrivate = mGenerator->d_func();
+    QMutexLocker locker( generatorPrivate->threadsLock() );
+    generatorPrivate->mFinishedTiles.append( mRequest );
+    locker.unlock();
+
+    // several jobs may finish before the GUI thread gets to it, the first
+    // call hands over all the tiles finished so far
+    QMetaObject::invokeMethod( mGenerator, "tileGenerationFinished", Qt::QueuedConnection );
+}
+
+
 TextPageGenerationThread::TextPageGenerationThread( Generator *generator )
-    : mGenerator( generator ), mTextPage( nullptr )
+    : mGenerator( generator ), mTextPage( nullptr ), mGenerationTime( 0 )
 {
     TextRequestPrivate *treqPriv = TextRequestPrivate::get( &mTextRequest );
     treqPriv->mPage = nullptr;
@@ -107,6 +138,11 @@ TextPage* TextPageGenerationThread::textPage() const
     return mTextPage;
 }
 
+qint64 TextPageGenerationThread::generationTime() const
+{
+    return mGenerationTime;
+}
+
 void TextPageGenerationThread::abortExtraction()
 {
     // If extraction already finished no point in aborting
@@ -128,7 +164,10 @@ void TextPageGenerationThread::run()
 
     Q_ASSERT ( page() );
 
+    QElapsedTimer timer;
+    timer.start();
     mTextPage = mGenerator->textPage( &mTextRequest );
+    mGenerationTime = timer.nsecsElapsed() / 1000;
 
     if ( mTextRequest.shouldAbortExtraction() )
     {
@@ -15,12 +15,15 @@
 
 #include "area.h"
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QRunnable>
 #include <QtCore/QSet>
 #include <QtCore/QThread>
 #include <QtGui/QImage>
 
 class QEventLoop;
 class QMutex;
+class QThreadPool;
 
 #include "generator.h"
 #include "page.h"
@@ -50,9 +53,17 @@ class GeneratorPrivate
 
         PixmapGenerationThread* pixmapGenerationThread();
         TextPageGenerationThread* textPageGenerationThread();
+        QThreadPool* tilesThreadPool();
 
         void pixmapGenerationFinished();
         void textpageGenerationFinished();
+        void tileGenerationFinished();
+
+        // whether nothing is being generated anymore
+        bool isIdle() const;
+
+        // converts the image of @p request to a pixmap and hands it to the page
+        void setRequestPixmap( PixmapRequest *request, const QImage &image );
 
         QMutex* threadsLock();
 
@@ -65,6 +76,12 @@ class GeneratorPrivate
         QSet< int > m_features;
         PixmapGenerationThread *mPixmapGenerationThread;
         TextPageGenerationThread *mTextPageGenerationThread;
+        // the tiles rendered in parallel, see ParallelTileRendering;
+        // mFinishedTiles are those done but not handed to the pages yet,
+        // they are guarded by threadsLock()
+        QThreadPool *mTilesThreadPool;
+        int mRunningTiles;
+        QList< PixmapRequest * > mFinishedTiles;
         mutable QMutex *m_mutex;
         QMutex *m_threadsMutex;
         bool mPixmapReady : 1;
@@ -92,10 +109,19 @@ class PixmapRequestPrivate
         bool mForce : 1;
         bool mTile : 1;
         bool mPartialUpdatesWanted : 1;
+        bool mPreview : 1; // a low resolution request queued by the Document
         Page *mPage;
         NormalizedRect mNormalizedRect;
         QAtomicInt mShouldAbortRender;
         QImage mResultImage;
+
+        // timings in microseconds, see RenderStatistics; mTimer measures
+        // the time in the queue and then the time since the submission
+        QElapsedTimer mTimer;
+        qint64 mQueueTime;
+        qint64 mGenerationTime; // -1 if the generator didn't go through image()
+        qint64 mConversionTime;
+        qint64 mTilingTime;
 };
 
 
@@ -137,6 +163,20 @@ class PixmapGenerationThread : public QThread
 };
 
 
+class TileGenerationJob : public QRunnable
+{
+    public:
+        TileGenerationJob( Generator *generator, PixmapRequest *request );
+
+    protected:
+        void run() override;
+
+    private:
+        Generator *mGenerator;
+        PixmapRequest *mRequest;
+};
+
+
 class TextPageGenerationThread : public QThread
 {
     Q_OBJECT
@@ -150,6 +190,7 @@ class TextPageGenerationThread : public QThread
         Page *page() const;
 
         TextPage* textPage() const;
+        qint64 generationTime() const;
 
         void abortExtraction();
         bool shouldAbortExtraction() const;
@@ -164,6 +205,7 @@ class TextPageGenerationThread : public QThread
         Generator *mGenerator;
         TextPage *mTextPage;
         TextRequest mTextRequest;
+        qint64 mGenerationTime;
 };
 
 class FontExtractionThread : public QThread
@@ -48,7 +48,8 @@ class OKULARCORE_EXPORT DocumentObserver
             TextSelection = 8,    ///< Text selection has been changed
             Annotations = 16,     ///< Annotations have been changed
             BoundingBox = 32,     ///< Bounding boxes have been changed
-            NeedSaveAs = 64       ///< Set when "Save" is needed or annotation/form changes will be lost @since 0.15 (KDE 4.9) @deprecated
+            NeedSaveAs = 64,      ///< Set when "Save" is needed or annotation/form changes will be lost @since 0.15 (KDE 4.9) @deprecated
+            PageContents = 128    ///< The annotations, form fields, transition or actions of the page have been loaded after the setup @since 1.5
         };
 
         /**
@@ -101,6 +102,9 @@ class OKULARCORE_EXPORT DocumentObserver
          * Returns whether the observer agrees that all pixmaps for the given
          * @p page can be unloaded to improve memory usage.
          *
+         * Preload requests for pages that can't be unloaded are never
+         * discarded for lack of memory.
+         *
          * Returns true per default.
          */
         virtual bool canUnloadPixmap( int page ) const;
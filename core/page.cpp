@@ -104,7 +104,7 @@ void PagePrivate::imageRotationDone( RotationJob * job )
     TilesManager *tm = tilesManager( job->observer() );
     if ( tm )
     {
-        QPixmap *pixmap = new QPixmap( QPixmap::fromImage( job->image() ) );
+        QPixmap *pixmap = new QPixmap( pixmapFromImage( job->image() ) );
         tm->setPixmap( pixmap, job->rect(), job->isPartialUpdate() );
         delete pixmap;
         return;
@@ -114,11 +114,11 @@ void PagePrivate::imageRotationDone( RotationJob * job )
     if ( it != m_pixmaps.end() )
     {
         PixmapObject &object = it.value();
-        (*object.m_pixmap) = QPixmap::fromImage( job->image() );
+        (*object.m_pixmap) = pixmapFromImage( job->image() );
         object.m_rotation = job->rotation();
     } else {
         PixmapObject object;
-        object.m_pixmap = new QPixmap( QPixmap::fromImage( job->image() ) );
+        object.m_pixmap = new QPixmap( pixmapFromImage( job->image() ) );
         object.m_rotation = job->rotation();
 
         m_pixmaps.insert( job->observer(), object );
@@ -1094,6 +1094,41 @@ void PagePrivate::adoptGeneratedContents( PagePrivate *oldPage )
     restoredFormFieldList = oldPage->restoredFormFieldList;
 }
 
+void PagePrivate::adoptRenderedContents( PagePrivate *oldPage )
+{
+    m_pixmaps = oldPage->m_pixmaps;
+    oldPage->m_pixmaps.clear();
+
+    m_tilesManagers = oldPage->m_tilesManagers;
+    oldPage->m_tilesManagers.clear();
+
+    m_boundingBox = oldPage->m_boundingBox;
+    m_isBoundingBoxKnown = oldPage->m_isBoundingBoxKnown;
+
+    delete m_text;
+    m_text = oldPage->m_text;
+    oldPage->m_text = nullptr;
+    if ( m_text )
+        m_text->d->m_page = m_page;
+
+    // the links and images come with the rendering, the source references
+    // and annotations are set again by the loading of the document
+    QSet<ObjectRect::ObjectType> which;
+    which << ObjectRect::Action << ObjectRect::Image;
+    deleteObjectRects( m_page->m_rects, which );
+    QLinkedList< ObjectRect * >::iterator it = oldPage->m_page->m_rects.begin();
+    while ( it != oldPage->m_page->m_rects.end() )
+    {
+        if ( which.contains( (*it)->objectType() ) )
+        {
+            m_page->m_rects.append( *it );
+            it = oldPage->m_page->m_rects.erase( it );
+        }
+        else
+            ++it;
+    }
+}
+
 FormField *PagePrivate::findEquivalentForm( const Page *p, FormField *oldField )
 {
     // given how id is not very good of id (at least for pdf) we do a few passes
@@ -129,6 +129,12 @@ class PagePrivate
          */
         void adoptGeneratedContents( PagePrivate *oldPage );
 
+        /**
+         * Moves the rendered contents (pixmaps, text, links and bounding box) of oldPage
+         * to this, used to keep them for the unchanged pages of a reloaded document.
+         */
+        void adoptRenderedContents( PagePrivate *oldPage );
+
         /*
          * Tries to find an equivalent form field to oldField by looking into the rect, type and name
          */
@@ -0,0 +1,216 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "pixmaprequestqueue_p.h"
+
+#include "area.h"
+#include "generator.h"
+#include "generator_p.h"
+
+using namespace Okular;
+
+PixmapRequestQueue::PixmapRequestQueue()
+    : m_nextSequence( 0 )
+{
+}
+
+bool PixmapRequestQueue::isEmpty() const
+{
+    return m_heap.isEmpty();
+}
+
+int PixmapRequestQueue::count() const
+{
+    return m_heap.count();
+}
+
+PixmapRequest *PixmapRequestQueue::push( PixmapRequest *request )
+{
+    Q_ASSERT( request );
+
+    PixmapRequest *queued = mergeTarget( request );
+    if ( queued )
+    {
+        queued->d->mForce = queued->d->mForce || request->d->mForce;
+        if ( request->priority() < queued->priority() )
+        {
+            queued->d->mPriority = request->priority();
+            siftUp( m_positions.value( queued ) );
+        }
+        delete request;
+        return queued;
+    }
+
+    Entry entry;
+    entry.request = request;
+    entry.sequence = m_nextSequence++;
+    m_heap.append( entry );
+    m_positions.insert( request, m_heap.count() - 1 );
+    m_index[ request->observer() ].insert( request->pageNumber(), request );
+    siftUp( m_heap.count() - 1 );
+    return request;
+}
+
+PixmapRequest *PixmapRequestQueue::top() const
+{
+    return m_heap.isEmpty() ? nullptr : m_heap.first().request;
+}
+
+PixmapRequest *PixmapRequestQueue::pop()
+{
+    if ( m_heap.isEmpty() )
+        return nullptr;
+
+    PixmapRequest *request = m_heap.first().request;
+    removeAt( 0 );
+    return request;
+}
+
+bool PixmapRequestQueue::remove( PixmapRequest *request )
+{
+    const QHash< PixmapRequest *, int >::const_iterator it = m_positions.constFind( request );
+    if ( it == m_positions.constEnd() )
+        return false;
+
+    removeAt( it.value() );
+    return true;
+}
+
+QVector< PixmapRequest * > PixmapRequestQueue::take( DocumentObserver *observer )
+{
+    // a copy, removeAt() changes the index
+    const QList< PixmapRequest * > requests = m_index.value( observer ).values();
+    for ( PixmapRequest *request : requests )
+        removeAt( m_positions.value( request ) );
+    return requests.toVector();
+}
+
+QVector< PixmapRequest * > PixmapRequestQueue::take( DocumentObserver *observer, int page )
+{
+    const QList< PixmapRequest * > requests = m_index.value( observer ).values( page );
+    for ( PixmapRequest *request : requests )
+        removeAt( m_positions.value( request ) );
+    return requests.toVector();
+}
+
+QVector< PixmapRequest * > PixmapRequestQueue::takeAll()
+{
+    QVector< PixmapRequest * > requests;
+    requests.reserve( m_heap.count() );
+    for ( const Entry &entry : qAsConst( m_heap ) )
+        requests.append( entry.request );
+
+    m_heap.clear();
+    m_positions.clear();
+    m_index.clear();
+    return requests;
+}
+
+bool PixmapRequestQueue::isBefore( const Entry &a, const Entry &b ) const
+{
+    const int aPriority = a.request->priority();
+    const int bPriority = b.request->priority();
+    if ( aPriority != bPriority )
+        return aPriority < bPriority;
+
+    // priority 0 is for synchronous requests and the current presentation
+    // page, the latest one is what is waited for
+    if ( aPriority == 0 )
+        return a.sequence > b.sequence;
+    return a.sequence < b.sequence;
+}
+
+void PixmapRequestQueue::place( int position, const Entry &entry )
+{
+    m_heap[ position ] = entry;
+    m_positions[ entry.request ] = position;
+}
+
+void PixmapRequestQueue::siftUp( int position )
+{
+    const Entry entry = m_heap.at( position );
+    while ( position > 0 )
+    {
+        const int parent = ( position - 1 ) / 2;
+        if ( !isBefore( entry, m_heap.at( parent ) ) )
+            break;
+        place( position, m_heap.at( parent ) );
+        position = parent;
+    }
+    place( position, entry );
+}
+
+void PixmapRequestQueue::siftDown( int position )
+{
+    const Entry entry = m_heap.at( position );
+    const int size = m_heap.count();
+    while ( true )
+    {
+        int child = 2 * position + 1;
+        if ( child >= size )
+            break;
+        if ( child + 1 < size && isBefore( m_heap.at( child + 1 ), m_heap.at( child ) ) )
+            ++child;
+        if ( !isBefore( m_heap.at( child ), entry ) )
+            break;
+        place( position, m_heap.at( child ) );
+        position = child;
+    }
+    place( position, entry );
+}
+
+void PixmapRequestQueue::removeAt( int position )
+{
+    PixmapRequest *request = m_heap.at( position ).request;
+    m_positions.remove( request );
+
+    QHash< DocumentObserver *, QMultiHash< int, PixmapRequest * > >::iterator it = m_index.find( request->observer() );
+    it->remove( request->pageNumber(), request );
+    if ( it->isEmpty() )
+        m_index.erase( it );
+
+    // fill the hole with the last entry, which then moves to its place
+    const Entry last = m_heap.takeLast();
+    if ( position == m_heap.count() )
+        return;
+
+    place( position, last );
+    if ( position > 0 && isBefore( last, m_heap.at( ( position - 1 ) / 2 ) ) )
+        siftUp( position );
+    else
+        siftDown( position );
+}
+
+PixmapRequest *PixmapRequestQueue::mergeTarget( PixmapRequest *request ) const
+{
+    const QHash< DocumentObserver *, QMultiHash< int, PixmapRequest * > >::const_iterator it = m_index.constFind( request->observer() );
+    if ( it == m_index.constEnd() )
+        return nullptr;
+
+    QMultiHash< int, PixmapRequest * >::const_iterator pIt = it->constFind( request->pageNumber() );
+    for ( ; pIt != it->constEnd() && pIt.key() == request->pageNumber(); ++pIt )
+    {
+        PixmapRequest *queued = pIt.value();
+        // a different size is a different zoom level, and a synchronous
+        // request must not end up waiting for an asynchronous one
+        if ( queued->width() != request->width() || queued->height() != request->height()
+             || queued->isTile() != request->isTile() || queued->d->mFeatures != request->d->mFeatures )
+            continue;
+
+        if ( !request->isTile() )
+            return queued;
+
+        // tiles are merged only into a region that covers them already,
+        // they are rendered one by one and never as part of a bigger region
+        if ( !queued->normalizedRect().isNull() && !request->normalizedRect().isNull()
+             && ( queued->normalizedRect() & request->normalizedRect() ) == request->normalizedRect() )
+            return queued;
+    }
+    return nullptr;
+}
@@ -0,0 +1,103 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_PIXMAPREQUESTQUEUE_P_H_
+#define _OKULAR_PIXMAPREQUESTQUEUE_P_H_
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+
+namespace Okular {
+
+class DocumentObserver;
+class PixmapRequest;
+
+/* The pixmap requests waiting to be sent to the generator.
+ *
+ * A binary heap ordered by priority (the lowest value first), indexed by
+ * request and by observer and page, so that adding, taking the first and
+ * removing any request are O(log n). Requests with the same priority are
+ * served in the order they were added, except the priority 0 ones, that
+ * are served newest first.
+ *
+ * The queue doesn't own the requests, whoever takes them out of it is
+ * responsible for deleting them. */
+class PixmapRequestQueue
+{
+    public:
+        PixmapRequestQueue();
+
+        bool isEmpty() const;
+        int count() const;
+
+        /**
+         * Adds @p request to the queue.
+         *
+         * If a request of the same observer for the same page and size is
+         * queued already (for tiles: one whose region covers it), @p request
+         * is merged into it and deleted. Returns the request that is in the
+         * queue afterwards.
+         */
+        PixmapRequest *push( PixmapRequest *request );
+
+        /**
+         * Returns the request to serve next, or 0 if the queue is empty.
+         */
+        PixmapRequest *top() const;
+
+        /**
+         * Removes the request to serve next from the queue and returns it.
+         */
+        PixmapRequest *pop();
+
+        /**
+         * Removes @p request from the queue, returns whether it was queued.
+         */
+        bool remove( PixmapRequest *request );
+
+        /**
+         * Removes all the requests of @p observer from the queue and returns
+         * them.
+         */
+        QVector< PixmapRequest * > take( DocumentObserver *observer );
+
+        /**
+         * Removes the requests of @p observer for @p page from the queue and
+         * returns them.
+         */
+        QVector< PixmapRequest * > take( DocumentObserver *observer, int page );
+
+        /**
+         * Empties the queue and returns all the requests that were in it.
+         */
+        QVector< PixmapRequest * > takeAll();
+
+    private:
+        struct Entry
+        {
+            PixmapRequest *request;
+            quint64 sequence;
+        };
+
+        bool isBefore( const Entry &a, const Entry &b ) const;
+        void place( int position, const Entry &entry );
+        void siftUp( int position );
+        void siftDown( int position );
+        void removeAt( int position );
+        PixmapRequest *mergeTarget( PixmapRequest *request ) const;
+
+        QVector< Entry > m_heap;
+        QHash< PixmapRequest *, int > m_positions;
+        QHash< DocumentObserver *, QMultiHash< int, PixmapRequest * > > m_index;
+        quint64 m_nextSequence;
+};
+
+}
+
+#endif
@@ -0,0 +1,430 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "pixmapstore_p.h"
+
+// qt/kde includes
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QThread>
+
+#include <algorithm>
+
+#include <zlib.h>
+
+// local includes
+#include "debug_p.h"
+
+using namespace Okular;
+
+static const quint32 s_storeMagic = 0x4f4b5058; // "OKPX"
+static const quint32 s_storeVersion = 2;
+
+// page, width, height, format, bytes per line, offset and length of an index entry
+static const int s_indexEntrySize = 4 + 4 + 4 + 4 + 4 + 8 + 4;
+
+// all the stores together
+static const qint64 s_maxStoreDirSize = 64 * 1024 * 1024;
+
+static QString storeDirectory()
+{
+    return QStandardPaths::writableLocation( QStandardPaths::GenericCacheLocation ) + QStringLiteral( "/okular/thumbnails" );
+}
+
+class PixmapStore::StoreThread : public QThread
+{
+    public:
+        explicit StoreThread( PixmapStore *store )
+            : m_store( store )
+        {
+        }
+
+    protected:
+        void run() override
+        {
+            m_store->run();
+        }
+
+    private:
+        PixmapStore *m_store;
+};
+
+PixmapStore::PixmapStore()
+    : m_thread( nullptr ), m_stopping( false ), m_busy( false ),
+      m_docSize( -1 ), m_docModified( 0 ), m_nextId( 0 ), m_dirty( false )
+{
+}
+
+PixmapStore::~PixmapStore()
+{
+    close();
+
+    if ( m_thread )
+    {
+        m_mutex.lock();
+        m_stopping = true;
+        m_wakeUp.wakeAll();
+        m_mutex.unlock();
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+QString PixmapStore::storeFileName( const QUrl &url, qint64 docSize )
+{
+    // like the docdata files, but the url is hashed in to tell apart
+    // documents with the same name and size
+    const QByteArray urlHash = QCryptographicHash::hash( url.toEncoded(), QCryptographicHash::Md5 ).toHex().left( 8 );
+    return storeDirectory() + QLatin1Char( '/' ) + QString::number( docSize ) + QLatin1Char( '.' ) + url.fileName()
+           + QLatin1Char( '.' ) + QString::fromLatin1( urlHash ) + QStringLiteral( ".thumbs" );
+}
+
+void PixmapStore::open( const QUrl &url, const QString &docFileName, qint64 docSize )
+{
+    close();
+
+    if ( !url.isLocalFile() || docSize < 0 )
+        return;
+
+    QMutexLocker locker( &m_mutex );
+    m_url = url;
+    m_docSize = docSize;
+    m_docModified = QFileInfo( docFileName ).lastModified().toMSecsSinceEpoch();
+    m_fileName = storeFileName( url, docSize );
+
+    QFile file( m_fileName );
+    if ( !file.open( QIODevice::ReadOnly ) )
+        return;
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_0 );
+    quint32 magic, version, count;
+    QString storedUrl;
+    qint64 storedSize, storedModified;
+    stream >> magic >> version;
+    if ( magic != s_storeMagic || version != s_storeVersion )
+        return;
+
+    stream >> storedUrl >> storedSize >> storedModified >> count;
+    if ( stream.status() != QDataStream::Ok )
+        return;
+
+    // the document changed since the store was written
+    if ( storedUrl != url.toString() || storedSize != docSize || storedModified != m_docModified )
+    {
+        qCDebug(OkularCoreDebug) << "Discarding outdated thumbnail store" << m_fileName;
+        file.close();
+        QFile::remove( m_fileName );
+        return;
+    }
+
+    for ( quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i )
+    {
+        qint32 page;
+        Entry entry;
+        stream >> page >> entry.width >> entry.height >> entry.format >> entry.bytesPerLine >> entry.offset >> entry.length;
+        if ( entry.offset < 0 || entry.length <= 0 || entry.offset + entry.length > file.size() )
+            continue;
+        if ( entry.format <= QImage::Format_Invalid || entry.format >= QImage::NImageFormats )
+            continue;
+        m_entries.insert( page, entry );
+    }
+    if ( stream.status() != QDataStream::Ok )
+        m_entries.clear();
+}
+
+void PixmapStore::close()
+{
+    QMutexLocker locker( &m_mutex );
+
+    // the images still waiting for the compression are compressed by write()
+    m_pendingLoads.clear();
+    m_pendingImages.clear();
+    while ( m_busy )
+        m_idle.wait( &m_mutex );
+    m_loadedImages.clear();
+
+    if ( m_dirty )
+        write();
+
+    m_url = QUrl();
+    m_fileName = QString();
+    m_docSize = -1;
+    m_docModified = 0;
+    m_entries.clear();
+    m_dirty = false;
+}
+
+bool PixmapStore::isOpen() const
+{
+    QMutexLocker locker( &m_mutex );
+    return !m_fileName.isEmpty();
+}
+
+bool PixmapStore::hasImage( int page, int width, int height ) const
+{
+    QMutexLocker locker( &m_mutex );
+    QHash< int, Entry >::const_iterator it = m_entries.constFind( page );
+    return it != m_entries.constEnd() && it->width == width && it->height == height;
+}
+
+QImage PixmapStore::image( int page, int width, int height ) const
+{
+    QMutexLocker locker( &m_mutex );
+    QHash< int, Entry >::const_iterator it = m_entries.constFind( page );
+    if ( it == m_entries.constEnd() || it->width != width || it->height != height )
+        return QImage();
+
+    if ( !it->image.isNull() )
+        return it->image;
+
+    // copies, the entry may be dropped as soon as the lock is released
+    const Entry entry = *it;
+    const QString fileName = m_fileName;
+    locker.unlock();
+
+    return decompress( readData( entry, fileName ), entry );
+}
+
+void PixmapStore::loadImage( int page, int width, int height )
+{
+    QMutexLocker locker( &m_mutex );
+    const Load load = { page, width, height };
+    m_pendingLoads.enqueue( load );
+
+    startThread();
+    m_wakeUp.wakeOne();
+}
+
+QList< PixmapStore::LoadedImage > PixmapStore::takeLoadedImages()
+{
+    QMutexLocker locker( &m_mutex );
+    QList< LoadedImage > images;
+    images.swap( m_loadedImages );
+    return images;
+}
+
+void PixmapStore::setImage( int page, const QImage &image )
+{
+    if ( !isOpen() || image.isNull() )
+        return;
+
+    QMutexLocker locker( &m_mutex );
+    Entry entry;
+    entry.width = image.width();
+    entry.height = image.height();
+    entry.format = image.format();
+    entry.bytesPerLine = image.bytesPerLine();
+    entry.image = image;
+    entry.id = ++m_nextId;
+    m_entries.insert( page, entry );
+    m_pendingImages.enqueue( qMakePair( page, entry.id ) );
+    m_dirty = true;
+
+    startThread();
+    m_wakeUp.wakeOne();
+}
+
+void PixmapStore::removeImage( int page )
+{
+    QMutexLocker locker( &m_mutex );
+    if ( m_entries.remove( page ) > 0 )
+        m_dirty = true;
+}
+
+void PixmapStore::startThread()
+{
+    if ( !m_thread )
+    {
+        m_thread = new StoreThread( this );
+        m_thread->start();
+    }
+}
+
+void PixmapStore::run()
+{
+    QMutexLocker locker( &m_mutex );
+    while ( true )
+    {
+        while ( m_pendingLoads.isEmpty() && m_pendingImages.isEmpty() && !m_stopping )
+            m_wakeUp.wait( &m_mutex );
+        if ( m_stopping )
+            break;
+
+        m_busy = true;
+
+        // the loads first, a view is waiting for them
+        if ( !m_pendingLoads.isEmpty() )
+        {
+            const Load load = m_pendingLoads.dequeue();
+            locker.unlock();
+            const LoadedImage loaded = { load.page, load.width, load.height, image( load.page, load.width, load.height ) };
+            locker.relock();
+            m_loadedImages.append( loaded );
+
+            locker.unlock();
+            emit imagesLoaded();
+            locker.relock();
+        }
+        else
+        {
+            const QPair< int, quint64 > pending = m_pendingImages.dequeue();
+            QHash< int, Entry >::iterator it = m_entries.find( pending.first );
+            if ( it != m_entries.end() && it->id == pending.second && !it->image.isNull() )
+            {
+                const QImage image = it->image;
+                locker.unlock();
+                const QByteArray data = compress( image );
+                locker.relock();
+
+                // it may have been replaced or removed meanwhile
+                it = m_entries.find( pending.first );
+                if ( it != m_entries.end() && it->id == pending.second )
+                {
+                    if ( data.isEmpty() )
+                    {
+                        m_entries.erase( it );
+                    }
+                    else
+                    {
+                        it->data = data;
+                        it->length = data.size();
+                        it->image = QImage();
+                    }
+                }
+            }
+        }
+
+        m_busy = false;
+        m_idle.wakeAll();
+    }
+}
+
+QByteArray PixmapStore::compress( const QImage &image )
+{
+    // the fastest zlib level, like the compressed pixmap cache: it is
+    // several times faster than PNG both ways and still small for pages
+    const uLong sourceLength = image.byteCount();
+    uLongf length = compressBound( sourceLength );
+    QByteArray data( length, Qt::Uninitialized );
+    if ( ::compress2( reinterpret_cast< Bytef * >( data.data() ), &length, image.constBits(), sourceLength, Z_BEST_SPEED ) != Z_OK )
+        return QByteArray();
+
+    data.resize( length );
+    data.squeeze();
+    return data;
+}
+
+QImage PixmapStore::decompress( const QByteArray &data, const Entry &entry )
+{
+    if ( data.isEmpty() )
+        return QImage();
+
+    QImage image( entry.width, entry.height, QImage::Format( entry.format ) );
+    if ( image.isNull() || image.bytesPerLine() != entry.bytesPerLine )
+        return QImage();
+
+    uLongf length = image.byteCount();
+    if ( ::uncompress( image.bits(), &length, reinterpret_cast< const Bytef * >( data.constData() ), data.size() ) != Z_OK
+         || length != uLongf( image.byteCount() ) )
+        return QImage();
+
+    return image;
+}
+
+QByteArray PixmapStore::readData( const Entry &entry, const QString &fileName )
+{
+    if ( entry.offset < 0 )
+        return entry.data;
+
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) || !file.seek( entry.offset ) )
+        return QByteArray();
+    return file.read( entry.length );
+}
+
+void PixmapStore::write()
+{
+    if ( !QDir().mkpath( storeDirectory() ) )
+        return;
+
+    // collect the images first, the old ones are still read from the
+    // current file while the new one is being written
+    QList< int > pages = m_entries.keys();
+    std::sort( pages.begin(), pages.end() );
+    QList< QByteArray > blobs;
+    QList< int > storedPages;
+    foreach ( int page, pages )
+    {
+        const Entry &entry = m_entries[ page ];
+        const QByteArray data = entry.image.isNull() ? readData( entry, m_fileName ) : compress( entry.image );
+        if ( data.isEmpty() )
+            continue;
+        blobs.append( data );
+        storedPages.append( page );
+    }
+
+    QByteArray header;
+    {
+        QDataStream stream( &header, QIODevice::WriteOnly );
+        stream.setVersion( QDataStream::Qt_5_0 );
+        stream << s_storeMagic << s_storeVersion << m_url.toString() << m_docSize << m_docModified << quint32( storedPages.count() );
+    }
+
+    QSaveFile file( m_fileName );
+    if ( !file.open( QIODevice::WriteOnly ) )
+        return;
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_0 );
+    stream.writeRawData( header.constData(), header.size() );
+    qint64 offset = header.size() + qint64( s_indexEntrySize ) * storedPages.count();
+    for ( int i = 0; i < storedPages.count(); ++i )
+    {
+        const Entry &entry = m_entries[ storedPages.at( i ) ];
+        stream << qint32( storedPages.at( i ) ) << entry.width << entry.height << entry.format << entry.bytesPerLine
+               << offset << qint32( blobs.at( i ).size() );
+        offset += blobs.at( i ).size();
+    }
+    foreach ( const QByteArray &blob, blobs )
+        stream.writeRawData( blob.constData(), blob.size() );
+
+    if ( stream.status() != QDataStream::Ok || !file.commit() )
+    {
+        qCWarning(OkularCoreDebug) << "Failed to write the thumbnail store" << m_fileName;
+        return;
+    }
+
+    m_dirty = false;
+    evict();
+}
+
+void PixmapStore::evict() const
+{
+    // drop the least recently written stores once they take too much space
+    QDir dir( storeDirectory() );
+    const QFileInfoList stores = dir.entryInfoList( QStringList() << QStringLiteral( "*.thumbs" ), QDir::Files, QDir::Time );
+    qint64 totalSize = 0;
+    foreach ( const QFileInfo &store, stores )
+    {
+        totalSize += store.size();
+        if ( totalSize > s_maxStoreDirSize && store.absoluteFilePath() != QFileInfo( m_fileName ).absoluteFilePath() )
+        {
+            qCDebug(OkularCoreDebug) << "Evicting thumbnail store" << store.fileName();
+            QFile::remove( store.absoluteFilePath() );
+            totalSize -= store.size();
+        }
+    }
+}
@@ -0,0 +1,173 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_PIXMAPSTORE_P_H_
+#define _OKULAR_PIXMAPSTORE_P_H_
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QPair>
+#include <QtCore/QQueue>
+#include <QtCore/QString>
+#include <QtCore/QUrl>
+#include <QtCore/QWaitCondition>
+#include <QtGui/QImage>
+
+namespace Okular {
+
+/* On-disk store of the pixmaps rendered for PixmapRequest::Persistent
+ * requests (i.e. thumbnails), one file per document.
+ *
+ * The file records the url, size and modification time of the document it
+ * belongs to and is discarded as soon as any of them changes. Only the index
+ * is read when opening, the images are read when they are asked for.
+ *
+ * The images are kept zlib compressed; a worker thread compresses the new
+ * ones and reads back the ones asked for with loadImage(). */
+class PixmapStore : public QObject
+{
+    Q_OBJECT
+
+    public:
+        struct LoadedImage
+        {
+            int page;
+            int width;
+            int height;
+            // null if it could not be read
+            QImage image;
+        };
+
+        PixmapStore();
+        ~PixmapStore();
+
+        /**
+         * Loads the index of the store for the document @p docFileName,
+         * opened from @p url.
+         */
+        void open( const QUrl &url, const QString &docFileName, qint64 docSize );
+
+        /**
+         * Writes the new images, if any, and forgets the document.
+         *
+         * The images being loaded are forgotten too.
+         */
+        void close();
+
+        bool isOpen() const;
+
+        /**
+         * Returns whether there is a stored image of @p page rendered at
+         * @p width x @p height, without reading it.
+         */
+        bool hasImage( int page, int width, int height ) const;
+
+        /**
+         * Returns the stored image of @p page if it was rendered at
+         * @p width x @p height, or a null image.
+         *
+         * It reads and uncompresses the image in the calling thread.
+         */
+        QImage image( int page, int width, int height ) const;
+
+        /**
+         * Reads the stored image of @p page rendered at @p width x @p height
+         * in the worker thread; imagesLoaded() is emitted once it is there.
+         */
+        void loadImage( int page, int width, int height );
+
+        /**
+         * Returns the images read since the last call.
+         */
+        QList< LoadedImage > takeLoadedImages();
+
+        /**
+         * Stores the rendered @p image of @p page, replacing the previous one.
+         *
+         * The image is compressed in the worker thread.
+         */
+        void setImage( int page, const QImage &image );
+
+        /**
+         * Forgets the stored image of @p page.
+         */
+        void removeImage( int page );
+
+        static QString storeFileName( const QUrl &url, qint64 docSize );
+
+    Q_SIGNALS:
+        /**
+         * Emitted from the worker thread when some images asked for with
+         * loadImage() were read.
+         */
+        void imagesLoaded();
+
+    private:
+        class StoreThread;
+        friend class StoreThread;
+
+        struct Entry
+        {
+            Entry() : width( 0 ), height( 0 ), format( 0 ), bytesPerLine( 0 ), offset( -1 ), length( 0 ), id( 0 ) {}
+
+            qint32 width;
+            qint32 height;
+            qint32 format;
+            qint32 bytesPerLine;
+            // position in the store file, or -1 if only in data
+            qint64 offset;
+            qint32 length;
+            QByteArray data;
+            // not compressed yet
+            QImage image;
+            quint64 id;
+        };
+
+        struct Load
+        {
+            int page;
+            int width;
+            int height;
+        };
+
+        static QByteArray compress( const QImage &image );
+        static QImage decompress( const QByteArray &data, const Entry &entry );
+        static QByteArray readData( const Entry &entry, const QString &fileName );
+
+        void run();
+        void startThread();
+        void write();
+        void evict() const;
+
+        mutable QMutex m_mutex;
+        QWaitCondition m_wakeUp;
+        QWaitCondition m_idle;
+        StoreThread *m_thread;
+        bool m_stopping;
+        // the worker is compressing or reading an image
+        bool m_busy;
+
+        QUrl m_url;
+        QString m_fileName;
+        qint64 m_docSize;
+        qint64 m_docModified;
+        QHash< int, Entry > m_entries;
+        QQueue< QPair< int, quint64 > > m_pendingImages;
+        QQueue< Load > m_pendingLoads;
+        QList< LoadedImage > m_loadedImages;
+        quint64 m_nextId;
+        bool m_dirty;
+};
+
+}
+
+#endif
@@ -18,10 +18,14 @@
 #include "page.h"
 #include "page_p.h"
 
+#include <algorithm>
+#include <climits>
 #include <cstring>
+#include <numeric>
 
 #include <QtAlgorithms>
 #include <QVarLengthArray>
+#include <QVector>
 
 using namespace Okular;
 
@@ -1108,20 +1112,33 @@ QString TextPage::text(const RegularAreaRect *area, TextAreaInclusionBehaviour b
     return ret;
 }
 
-static bool compareTinyTextEntityX(const WordWithCharacters &first, const WordWithCharacters &second)
+/**
+ * The geometry of a word, computed once: its rectangle in page pixels,
+ * rounded and not, and the position used to sort the words.
+ */
+struct WordGeometry
 {
-    QRect firstArea = first.area().roundedGeometry(1000,1000);
-    QRect secondArea = second.area().roundedGeometry(1000,1000);
-
-    return firstArea.left() < secondArea.left();
-}
+    QRect rounded;
+    QRect rect;
+    int sortTop;
+    int sortLeft;
+};
 
-static bool compareTinyTextEntityY(const WordWithCharacters &first, const WordWithCharacters &second)
+static QVector<WordGeometry> wordGeometries(const WordsWithCharacters &words, int pageWidth, int pageHeight)
 {
-    const QRect firstArea = first.area().roundedGeometry(1000,1000);
-    const QRect secondArea = second.area().roundedGeometry(1000,1000);
-
-    return firstArea.top() < secondArea.top();
+    QVector<WordGeometry> geometries;
+    geometries.reserve(words.length());
+    foreach(const WordWithCharacters &word, words)
+    {
+        const QRect sortRect = word.area().roundedGeometry(1000,1000);
+        WordGeometry geometry;
+        geometry.rounded = word.area().roundedGeometry(pageWidth,pageHeight);
+        geometry.rect = word.area().geometry(pageWidth,pageHeight);
+        geometry.sortTop = sortRect.top();
+        geometry.sortLeft = sortRect.left();
+        geometries.append(geometry);
+    }
+    return geometries;
 }
 
 /**
@@ -1271,9 +1288,18 @@ static WordsWithCharacters makeWordFromCharacters(const TextList &characters, in
 }
 
 /**
- * Create Lines from the words and sort them
+ * A line of words: the indices of its words, sorted by x, and its area.
  */
-QList< QPair<WordsWithCharacters, QRect> > makeAndSortLines(const WordsWithCharacters &wordsTmp, int pageWidth, int pageHeight)
+struct TextLine
+{
+    QVector<int> words;
+    QRect area;
+};
+
+/**
+ * Create Lines from the @p count words in @p indices and sort them
+ */
+static QVector<TextLine> makeLines(const int *indices, int count, const QVector<WordGeometry> &geometries)
 {
     /**
      * We cannot assume that the generator will give us texts in the right order.
@@ -1285,34 +1311,79 @@ QList< QPair<WordsWithCharacters, QRect> > makeAndSortLines(const WordsWithChara
      * 2. Create textline where there is y overlap between TinyTextEntity 's
      * 3. Within each line sort the TinyTextEntity 's by x0(left)
      */
-    
-    QList< QPair<WordsWithCharacters, QRect> > lines;
+
+    QVector<TextLine> lines;
+
+    // Step 1
+    QVector<int> words;
+    words.reserve(count);
+    for (int i = 0 ; i < count ; ++i)
+        words.append(indices[i]);
+    qSort(words.begin(), words.end(), [&geometries](int first, int second) {
+        return geometries.at(first).sortTop < geometries.at(second).sortTop;
+    });
 
     /*
-     Make a new copy of the TextList in the words, so that the wordsTmp and lines do
-     not contain same pointers for all the TinyTextEntity.
+     Step 2 sweeps the words from the top: a line ending above the top of
+     all the words left can't take any of them anymore, so only the lines
+     still open are compared to the next word. The smallest top of the
+     words from each one on tells when a line is closed.
      */
-    QList<WordWithCharacters> words = wordsTmp;
+    QVector<int> minTops(count + 1);
+    minTops[count] = INT_MAX;
+    for (int i = count - 1 ; i >= 0 ; --i)
+        minTops[i] = qMin(minTops.at(i + 1), geometries.at(words.at(i)).rounded.top());
 
-    // Step 1
-    qSort(words.begin(),words.end(),compareTinyTextEntityY);
+    // the open lines, in the order they were created
+    QVector<int> openLines;
 
     // Step 2
-    QList<WordWithCharacters>::Iterator it = words.begin(), itEnd = words.end();
-
-    //for every non-space texts(characters/words) in the textList
-    for( ; it != itEnd ; it++)
+    for (int i = 0 ; i < count ; ++i)
     {
-        const QRect elementArea = (*it).area().roundedGeometry(pageWidth,pageHeight);
-        bool found = false;
+        const QRect elementArea = geometries.at(words.at(i)).rounded;
+
+        int openCount = 0;
+        for (int k = 0 ; k < openLines.count() ; ++k)
+        {
+            const QRect &lineArea = lines.at(openLines.at(k)).area;
+            if (lineArea.height() < 0 || lineArea.bottom() >= minTops.at(i) - 1)
+                openLines[openCount++] = openLines.at(k);
+        }
+        openLines.resize(openCount);
+
+        /*
+           if the new text and the line has y overlapping parts of more than 70%,
+           the text will be added to the first such line; a text of negative
+           height may overlap a closed line, which opens again
+         */
+        int found = -1;
+        if (elementArea.height() < 0)
+        {
+            for (int k = 0 ; k < lines.count() && found < 0 ; ++k)
+            {
+                if (doesConsumeY(elementArea, lines.at(k).area, 70))
+                    found = k;
+            }
+            if (found >= 0 && !openLines.contains(found))
+                openLines.insert(std::lower_bound(openLines.begin(), openLines.end(), found), found);
+        }
+        else
+        {
+            for (int k = 0 ; k < openLines.count() && found < 0 ; ++k)
+            {
+                if (doesConsumeY(elementArea, lines.at(openLines.at(k)).area, 70))
+                    found = openLines.at(k);
+            }
+        }
 
-        for( int i = 0 ; i < lines.length() ; i++)
+        if (found >= 0)
         {
             /* the line area which will be expanded
                line_rects is only necessary to preserve the topmin and bottommax of all
                the texts in the line, left and right is not necessary at all
             */
-            QRect &lineArea = lines[i].second;
+            TextLine &line = lines[found];
+            QRect &lineArea = line.area;
             const int text_y1 = elementArea.top() ,
                       text_y2 = elementArea.top() + elementArea.height() ,
                       text_x1 = elementArea.left(),
@@ -1322,52 +1393,71 @@ QList< QPair<WordsWithCharacters, QRect> > makeAndSortLines(const WordsWithChara
                       line_x1 = lineArea.left(),
                       line_x2 = lineArea.left() + lineArea.width();
 
-            /*
-               if the new text and the line has y overlapping parts of more than 70%,
-               the text will be added to this line
-             */
-            if(doesConsumeY(elementArea,lineArea,70))
-            {
-                WordsWithCharacters &line = lines[i].first;
-                line.append(*it);
-
-                const int newLeft = line_x1 < text_x1 ? line_x1 : text_x1;
-                const int newRight = line_x2 > text_x2 ? line_x2 : text_x2;
-                const int newTop = line_y1 < text_y1 ? line_y1 : text_y1;
-                const int newBottom = text_y2 > line_y2 ? text_y2 : line_y2;
+            line.words.append(words.at(i));
 
-                lineArea = QRect( newLeft,newTop, newRight - newLeft, newBottom - newTop );
-                found = true;
-            }
+            const int newLeft = line_x1 < text_x1 ? line_x1 : text_x1;
+            const int newRight = line_x2 > text_x2 ? line_x2 : text_x2;
+            const int newTop = line_y1 < text_y1 ? line_y1 : text_y1;
+            const int newBottom = text_y2 > line_y2 ? text_y2 : line_y2;
 
-            if(found) break;
+            lineArea = QRect( newLeft,newTop, newRight - newLeft, newBottom - newTop );
         }
-
-        /* when we have found a new line create a new TextList containing
+        /* when we have found a new line create a new line containing
            only one element and append it to the lines
          */
-        if(!found)
+        else
         {
-            WordsWithCharacters tmp;
-            tmp.append((*it));
-            lines.append(QPair<WordsWithCharacters, QRect>(tmp, elementArea));
+            TextLine line;
+            line.words.append(words.at(i));
+            line.area = elementArea;
+            lines.append(line);
+            openLines.append(lines.count() - 1);
         }
     }
 
     // Step 3
-    for(int i = 0 ; i < lines.length() ; i++)
+    for (int i = 0 ; i < lines.count() ; i++)
     {
-        WordsWithCharacters &list = lines[i].first;
-        qSort(list.begin(), list.end(), compareTinyTextEntityX);
+        QVector<int> &list = lines[i].words;
+        qSort(list.begin(), list.end(), [&geometries](int first, int second) {
+            return geometries.at(first).sortLeft < geometries.at(second).sortLeft;
+        });
     }
-    
+
     return lines;
 }
 
 /**
- * Calculate Statistical information from the lines we made previously
+ * Create Lines from the words and sort them
  */
-static void calculateStatisticalInformation(const QList<WordWithCharacters> &words, int pageWidth, int pageHeight, int *word_spacing, int *line_spacing, int *col_spacing)
+QList< QPair<WordsWithCharacters, QRect> > makeAndSortLines(const WordsWithCharacters &wordsTmp, int pageWidth, int pageHeight)
+{
+    const QVector<WordGeometry> geometries = wordGeometries(wordsTmp, pageWidth, pageHeight);
+    QVector<int> indices(wordsTmp.length());
+    std::iota(indices.begin(), indices.end(), 0);
+    const QVector<TextLine> lines = makeLines(indices.constData(), indices.count(), geometries);
+
+    /*
+     Make a new copy of the TextList in the words, so that the wordsTmp and lines do
+     not contain same pointers for all the TinyTextEntity.
+     */
+    QList< QPair<WordsWithCharacters, QRect> > sortedLines;
+    sortedLines.reserve(lines.count());
+    foreach(const TextLine &line, lines)
+    {
+        WordsWithCharacters list;
+        list.reserve(line.words.count());
+        foreach(int word, line.words)
+            list.append(wordsTmp.at(word));
+        sortedLines.append(QPair<WordsWithCharacters, QRect>(list, line.area));
+    }
+    return sortedLines;
+}
+
+/**
+ * Calculate Statistical information from the lines of the @p count words in @p indices
+ */
+static void calculateStatisticalInformation(const int *indices, int count, const QVector<WordGeometry> &geometries, int pageWidth, int *word_spacing, int *line_spacing, int *col_spacing)
 {
     /**
      * For the region, defined by line_rects and lines
@@ -1375,11 +1465,11 @@ static void calculateStatisticalInformation(const QList<WordWithCharacters> &wor
      * 2. Make character statistical analysis to differentiate between
      *   word spacing and column spacing.
      */
-    
+
     /**
      * Step 0
      */
-    const QList< QPair<WordsWithCharacters, QRect> > sortedLines = makeAndSortLines(words, pageWidth, pageHeight);
+    const QVector<TextLine> sortedLines = makeLines(indices, count, geometries);
 
     /**
      * Step 1
@@ -1387,10 +1477,10 @@ static void calculateStatisticalInformation(const QList<WordWithCharacters> &wor
     QMap<int,int> line_space_stat;
     for(int i = 0 ; i < sortedLines.length(); i++)
     {
-        const QRect rectUpper = sortedLines.at(i).second;
+        const QRect rectUpper = sortedLines.at(i).area;
 
         if(i+1 == sortedLines.length()) break;
-        const QRect rectLower = sortedLines.at(i+1).second;
+        const QRect rectLower = sortedLines.at(i+1).area;
 
         int linespace = rectLower.top() - (rectUpper.top() + rectUpper.height());
         if(linespace < 0) linespace =-linespace;
@@ -1425,22 +1515,18 @@ static void calculateStatisticalInformation(const QList<WordWithCharacters> &wor
     // Space in every line
     for(int i = 0 ; i < sortedLines.length() ; i++)
     {
-        const WordsWithCharacters list = sortedLines.at(i).first;
+        const QVector<int> &list = sortedLines.at(i).words;
         QList<QRect> line_space_rects;
         int maxSpace = 0, minSpace = pageWidth;
 
         // for every TinyTextEntity element in the line
-        WordsWithCharacters::ConstIterator it = list.begin(), itEnd = list.end();
         QRect max_area1,max_area2;
-        QString before_max, after_max;
 
         // for every line
-        for( ; it != itEnd ; it++ )
+        for(int j = 0 ; j + 1 < list.count() ; j++ )
         {
-            const QRect area1 = (*it).area().roundedGeometry(pageWidth,pageHeight);
-            if( it+1 == itEnd ) break;
-
-            const QRect area2 = (*(it+1)).area().roundedGeometry(pageWidth,pageHeight);
+            const QRect &area1 = geometries.at(list.at(j)).rounded;
+            const QRect &area2 = geometries.at(list.at(j + 1)).rounded;
             int space = area2.left() - area1.right();
 
             if(space > maxSpace)
@@ -1448,8 +1534,6 @@ static void calculateStatisticalInformation(const QList<WordWithCharacters> &wor
                 max_area1 = area1;
                 max_area2 = area2;
                 maxSpace = space;
-                before_max = (*it).text();
-                after_max = (*(it+1)).text();
             }
 
             if(space < minSpace && space != 0) minSpace = space;
@@ -1543,39 +1627,54 @@ static void calculateStatisticalInformation(const QList<WordWithCharacters> &wor
  */
 static RegionTextList XYCutForBoundingBoxes(const QList<WordWithCharacters> &wordsWithCharacters, const NormalizedRect &boundingBox, int pageWidth, int pageHeight)
 {
-    RegionTextList tree;
-    QRect contentRect(boundingBox.geometry(pageWidth,pageHeight));
-    const RegionText root(wordsWithCharacters, contentRect);
+    /*
+     A region is a range of order: the words of a region are next to each
+     other there, in the order they have in the region, and a cut only
+     partitions the range of the region in two.
+     */
+    struct Region
+    {
+        QRect area;
+        int begin;
+        int end;
+    };
+
+    const QVector<WordGeometry> geometries = wordGeometries(wordsWithCharacters, pageWidth, pageHeight);
+    QVector<int> order(wordsWithCharacters.length());
+    std::iota(order.begin(), order.end(), 0);
+
+    QVector<Region> tree;
+    const QRect contentRect(boundingBox.geometry(pageWidth,pageHeight));
+    const Region root = { contentRect, 0, order.count() };
 
     // start the tree with the root, it is our only region at the start
-    tree.push_back(root);
+    tree.append(root);
 
     int i = 0;
 
     // while traversing the tree has not been ended
-    while(i < tree.length())
+    while(i < tree.count())
     {
-        const RegionText node = tree.at(i);
-        QRect regionRect = node.area();
+        const Region node = tree.at(i);
+        QRect regionRect = node.area;
 
         /**
          * 1. calculation of projection profiles
          */
-        // allocate the size of proj profiles and initialize with 0
-        int size_proj_y = node.area().height();
-        int size_proj_x = node.area().width();
+        // allocate the size of proj profiles and initialize with 0, with room
+        // for the end of the last difference
+        int size_proj_y = node.area.height();
+        int size_proj_x = node.area.width();
         //dynamic memory allocation
-        QVarLengthArray<int> proj_on_xaxis(size_proj_x);
-        QVarLengthArray<int> proj_on_yaxis(size_proj_y);
+        QVarLengthArray<int> proj_on_xaxis(qMax(size_proj_x, 0) + 1);
+        QVarLengthArray<int> proj_on_yaxis(qMax(size_proj_y, 0) + 1);
 
-        for( int j = 0 ; j < size_proj_y ; ++j ) proj_on_yaxis[j] = 0;
-        for( int j = 0 ; j < size_proj_x ; ++j ) proj_on_xaxis[j] = 0;
-
-        const QList<WordWithCharacters> list = node.text();
+        for( int j = 0 ; j < proj_on_yaxis.size() ; ++j ) proj_on_yaxis[j] = 0;
+        for( int j = 0 ; j < proj_on_xaxis.size() ; ++j ) proj_on_xaxis[j] = 0;
 
         // Calculate tcx and tcy locally for each new region
         int word_spacing, line_spacing, column_spacing;
-        calculateStatisticalInformation(list, pageWidth, pageHeight, &word_spacing, &line_spacing, &column_spacing);
+        calculateStatisticalInformation(order.constData() + node.begin, node.end - node.begin, geometries, pageWidth, &word_spacing, &line_spacing, &column_spacing);
 
         const int tcx = word_spacing * 2;
         const int tcy = line_spacing * 2;
@@ -1584,27 +1683,36 @@ static RegionTextList XYCutForBoundingBoxes(const QList<WordWithCharacters> &wor
         int avgX = 0;
         int count;
 
-        // for every text in the region
-        for(int j = 0 ; j < list.length() ; ++j )
+        // for every text in the region, the differences of the profiles: the
+        // text adds to the columns from its left to its right, both included,
+        // and the same for the rows
+        for(int j = node.begin ; j < node.end ; ++j )
         {
-            TinyTextEntity *ent = list.at(j).word;
-            const QRect entRect = ent->area.geometry(pageWidth, pageHeight);
+            const QRect &entRect = geometries.at(order.at(j)).rect;
 
             // calculate vertical projection profile proj_on_xaxis1
-            for(int k = entRect.left() ; k <= entRect.left() + entRect.width() ; ++k)
+            const int xFirst = qMax(entRect.left() - regionRect.left(), 0);
+            const int xLast = qMin(entRect.left() + entRect.width() - regionRect.left(), size_proj_x - 1);
+            if (xFirst <= xLast)
             {
-                if( ( k-regionRect.left() ) < size_proj_x && ( k-regionRect.left() ) >= 0 )
-                    proj_on_xaxis[k - regionRect.left()] += entRect.height();
+                proj_on_xaxis[xFirst] += entRect.height();
+                proj_on_xaxis[xLast + 1] -= entRect.height();
             }
 
             // calculate horizontal projection profile in the same way
-            for(int k = entRect.top() ; k <= entRect.top() + entRect.height() ; ++k)
+            const int yFirst = qMax(entRect.top() - regionRect.top(), 0);
+            const int yLast = qMin(entRect.top() + entRect.height() - regionRect.top(), size_proj_y - 1);
+            if (yFirst <= yLast)
             {
-                if( ( k-regionRect.top() ) < size_proj_y && ( k-regionRect.top() ) >= 0 )
-                    proj_on_yaxis[k - regionRect.top()] += entRect.width();
+                proj_on_yaxis[yFirst] += entRect.width();
+                proj_on_yaxis[yLast + 1] -= entRect.width();
             }
         }
 
+        // the prefix sums of the differences are the profiles
+        for( int j = 1 ; j < size_proj_x ; ++j ) proj_on_xaxis[j] += proj_on_xaxis[j - 1];
+        for( int j = 1 ; j < size_proj_y ; ++j ) proj_on_yaxis[j] += proj_on_yaxis[j - 1];
+
         for( int j = 0 ; j < size_proj_y ; ++j )
         {
             if (proj_on_yaxis[j] > maxY)
@@ -1746,59 +1854,54 @@ static RegionTextList XYCutForBoundingBoxes(const QList<WordWithCharacters> &wor
         else
         {
             // we can now update the node rectangle with the shrinked rectangle
-            RegionText tmpNode = tree.at(i);
-            tmpNode.setArea(regionRect);
-            tree.replace(i,tmpNode);
+            tree[i].area = regionRect;
             i++;
             continue;
         }
 
-        WordsWithCharacters list1,list2;
+        int middle;
 
         // horizontal cut, topRect and bottomRect
         if(cut_hor)
         {
-            for( int j = 0 ; j < list.length() ; ++j )
-            {
-                const WordWithCharacters word = list.at(j);
-                const QRect wordRect = word.area().geometry(pageWidth,pageHeight);
+            middle = std::stable_partition(order.begin() + node.begin, order.begin() + node.end, [&](int word) {
+                return topRect.intersects(geometries.at(word).rect);
+            }) - order.begin();
 
-                if(topRect.intersects(wordRect))
-                    list1.append(word);
-                else
-                    list2.append(word);
-            }
+            const Region node1 = { topRect, node.begin, middle };
+            const Region node2 = { bottomRect, middle, node.end };
 
-            RegionText node1(list1,topRect);
-            RegionText node2(list2,bottomRect);
-
-            tree.replace(i,node1);
+            tree[i] = node1;
             tree.insert(i+1,node2);
         }
 
         //vertical cut, leftRect and rightRect
         else if(cut_ver)
         {
-            for( int j = 0 ; j < list.length() ; ++j )
-            {
-                const WordWithCharacters word = list.at(j);
-                const QRect wordRect = word.area().geometry(pageWidth,pageHeight);
+            middle = std::stable_partition(order.begin() + node.begin, order.begin() + node.end, [&](int word) {
+                return leftRect.intersects(geometries.at(word).rect);
+            }) - order.begin();
 
-                if(leftRect.intersects(wordRect))
-                    list1.append(word);
-                else 
-                    list2.append(word);
-            }
-
-            RegionText node1(list1,leftRect);
-            RegionText node2(list2,rightRect);
+            const Region node1 = { leftRect, node.begin, middle };
+            const Region node2 = { rightRect, middle, node.end };
 
-            tree.replace(i,node1);
+            tree[i] = node1;
             tree.insert(i+1,node2);
         }
     }
 
-    return tree;
+    RegionTextList regions;
+    regions.reserve(tree.count());
+    foreach(const Region &region, tree)
+    {
+        WordsWithCharacters list;
+        list.reserve(region.end - region.begin);
+        for( int j = region.begin ; j < region.end ; ++j )
+            list.append(wordsWithCharacters.at(order.at(j)));
+        regions.append(RegionText(list, region.area));
+    }
+
+    return regions;
 }
 
 /**
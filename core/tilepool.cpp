@@ -0,0 +1,188 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "tilepool_p.h"
+
+#include <QtGui/QPixelFormat>
+
+#include <stdlib.h>
+
+#include "tilesmanager_p.h"
+
+using namespace Okular;
+
+// a buffer starts with its size class, the pixels follow, 16 bytes aligned
+static const int s_headerSize = 16;
+// about sixteen 1000x1000 tiles
+static const qulonglong s_maxIdleMemory = 64 * 1024 * 1024;
+// the tile nodes are allocated by chunks of as many splits
+static const int s_chunkSplits = 64;
+
+Q_GLOBAL_STATIC( TilePool, s_tilePool )
+
+TilePool::TilePool()
+    : m_idleMemory( 0 ), m_hits( 0 ), m_misses( 0 ), m_allocatedNodes( 0 )
+{
+}
+
+TilePool::~TilePool()
+{
+    for ( const QVector< uchar * > &buffers : qAsConst( m_buffers ) )
+    {
+        for ( uchar *block : buffers )
+            free( block );
+    }
+
+    for ( TileNode *chunk : qAsConst( m_chunks ) )
+        delete [] chunk;
+}
+
+TilePool *TilePool::instance()
+{
+    return s_tilePool();
+}
+
+QImage TilePool::image( int width, int height, QImage::Format format )
+{
+    const int depth = QImage::toPixelFormat( format ).bitsPerPixel();
+    if ( width <= 0 || height <= 0 || depth <= 0 )
+        return QImage();
+
+    // the lines of a QImage are 32 bit aligned
+    const int bytesPerLine = ( ( width * depth + 31 ) / 32 ) * 4;
+    const qulonglong size = sizeClass( qulonglong( bytesPerLine ) * height );
+
+    uchar *block = nullptr;
+    m_mutex.lock();
+    QHash< qulonglong, QVector< uchar * > >::iterator it = m_buffers.find( size );
+    if ( it != m_buffers.end() && !it->isEmpty() )
+    {
+        block = it->takeLast();
+        m_idleMemory -= size;
+        ++m_hits;
+    }
+    else
+    {
+        ++m_misses;
+    }
+    m_mutex.unlock();
+
+    if ( !block )
+    {
+        block = static_cast< uchar * >( malloc( s_headerSize + size ) );
+        if ( !block )
+            return QImage();
+        *reinterpret_cast< qulonglong * >( block ) = size;
+    }
+
+    return QImage( block + s_headerSize, width, height, bytesPerLine, format, releaseBuffer, block );
+}
+
+TileNode *TilePool::allocateNodes()
+{
+    QMutexLocker locker( &m_mutex );
+    if ( m_freeNodes.isEmpty() )
+    {
+        TileNode *chunk = new TileNode[ 4 * s_chunkSplits ];
+        m_chunks.append( chunk );
+        m_allocatedNodes += 4 * s_chunkSplits;
+        // the first ones of the chunk are used first
+        for ( int i = s_chunkSplits - 1; i >= 0; --i )
+            m_freeNodes.append( chunk + 4 * i );
+    }
+
+    return m_freeNodes.takeLast();
+}
+
+void TilePool::releaseNodes( TileNode *nodes )
+{
+    // ready for their next use
+    for ( int i = 0; i < 4; ++i )
+        nodes[ i ] = TileNode();
+
+    QMutexLocker locker( &m_mutex );
+    m_freeNodes.append( nodes );
+}
+
+int TilePool::hits() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_hits;
+}
+
+int TilePool::misses() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_misses;
+}
+
+qulonglong TilePool::idleMemory() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_idleMemory;
+}
+
+int TilePool::nodesInUse() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_allocatedNodes - 4 * m_freeNodes.count();
+}
+
+int TilePool::allocatedNodes() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_allocatedNodes;
+}
+
+void TilePool::resetStatistics()
+{
+    QMutexLocker locker( &m_mutex );
+    m_hits = 0;
+    m_misses = 0;
+}
+
+qulonglong TilePool::sizeClass( qulonglong bytes )
+{
+    qulonglong size = 4096;
+    if ( bytes <= size )
+        return size;
+
+    // a quarter of the power of two below, so at most a fifth of the
+    // buffer is wasted
+    while ( size * 2 < bytes )
+        size *= 2;
+    const qulonglong step = size / 4;
+    return ( ( bytes + step - 1 ) / step ) * step;
+}
+
+void TilePool::releaseBuffer( void *buffer )
+{
+    uchar *block = static_cast< uchar * >( buffer );
+    const qulonglong size = *reinterpret_cast< qulonglong * >( block );
+
+    // the images may outlive the pool when the process ends
+    TilePool *pool = s_tilePool.isDestroyed() ? nullptr : s_tilePool();
+    if ( pool )
+        pool->release( block, size );
+    else
+        free( block );
+}
+
+void TilePool::release( uchar *block, qulonglong size )
+{
+    QMutexLocker locker( &m_mutex );
+    if ( m_idleMemory + size > s_maxIdleMemory )
+    {
+        free( block );
+        return;
+    }
+
+    m_buffers[ size ].append( block );
+    m_idleMemory += size;
+}
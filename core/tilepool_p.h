@@ -0,0 +1,100 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_TILEPOOL_P_H_
+#define _OKULAR_TILEPOOL_P_H_
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+
+namespace Okular {
+
+class TileNode;
+
+/* The memory of the tiles, shared by all the tiles managers.
+ *
+ * The pixels of the tiles that can't share the ones of the rendered image
+ * (the rotated tiles and the copied ones) come from buffers in size
+ * classes, a quarter of a power of two apart. A buffer goes back to the
+ * pool when its image is gone, and is reused for the next tile of about
+ * the same size, up to a bound on the memory kept idle.
+ *
+ * The tile nodes are allocated four at a time, as the children of a split
+ * tile, out of contiguous chunks that are never given back but reused. */
+class TilePool
+{
+    public:
+        TilePool();
+        ~TilePool();
+
+        /**
+         * The pool of the process.
+         */
+        static TilePool *instance();
+
+        /**
+         * Returns an uninitialized @p width x @p height image in @p format,
+         * its pixels go back to the pool when it is deleted.
+         */
+        QImage image( int width, int height, QImage::Format format );
+
+        /**
+         * Returns four default constructed contiguous tile nodes.
+         */
+        TileNode *allocateNodes();
+
+        /**
+         * Gives back four tile nodes returned by allocateNodes().
+         */
+        void releaseNodes( TileNode *nodes );
+
+        /**
+         * The number of images served with a reused buffer and with a new
+         * one, the memory of the buffers waiting to be reused, and the tile
+         * nodes in use and allocated.
+         */
+        int hits() const;
+        int misses() const;
+        qulonglong idleMemory() const;
+        int nodesInUse() const;
+        int allocatedNodes() const;
+
+        /**
+         * Sets the hits and misses back to zero.
+         */
+        void resetStatistics();
+
+        /**
+         * The bytes of the buffer that holds @p bytes.
+         */
+        static qulonglong sizeClass( qulonglong bytes );
+
+    private:
+        static void releaseBuffer( void *buffer );
+        void release( uchar *block, qulonglong size );
+
+        mutable QMutex m_mutex;
+        // the free buffers, by size class
+        QHash< qulonglong, QVector< uchar * > > m_buffers;
+        qulonglong m_idleMemory;
+        int m_hits;
+        int m_misses;
+
+        QVector< TileNode * > m_chunks;
+        QVector< TileNode * > m_freeNodes;
+        int m_allocatedNodes;
+
+        Q_DISABLE_COPY( TilePool )
+};
+
+}
+
+#endif
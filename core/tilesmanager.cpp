@@ -8,17 +8,117 @@
 
 #include "tilesmanager_p.h"
 
+#include <QImage>
 #include <QPixmap>
 #include <QtCore/qmath.h>
 #include <QList>
-#include <QPainter>
+#include <QTransform>
+
+#include <string.h>
 
 #include "tile.h"
+#include "tilepool_p.h"
+#include "utils_p.h"
 
 #define TILES_MAXSIZE 2000000
 
 using namespace Okular;
 
+static void releaseTileSource( void *image )
+{
+    delete static_cast< QImage * >( image );
+}
+
+/* Returns a pixmap with the @p rect part of @p image. When the lines of the
+ * part are aligned the pixmap shares the pixels of the image, that stays
+ * alive until the last of its tiles is deleted, so a tile costs no copy. */
+static QPixmap *tilePixmap( const QImage &image, const QRect &rect )
+{
+    // the same part QPixmap::copy() would take
+    const QRect part = rect.isEmpty() ? image.rect() : ( rect & image.rect() );
+    const int offset = part.x() * image.depth() / 8;
+    if ( part.isEmpty() || image.depth() < 8 )
+        return new QPixmap( pixmapFromImage( image.copy( part ) ) );
+
+    if ( offset % 4 != 0 )
+    {
+        // the copy goes to a pooled buffer
+        QImage copy = TilePool::instance()->image( part.width(), part.height(), image.format() );
+        if ( copy.isNull() )
+            return new QPixmap( pixmapFromImage( image.copy( part ) ) );
+
+        copy.setColorTable( image.colorTable() );
+        const int lineLength = part.width() * image.depth() / 8;
+        for ( int y = 0; y < part.height(); ++y )
+            memcpy( copy.scanLine( y ), image.constScanLine( part.y() + y ) + offset, lineLength );
+        return new QPixmap( pixmapFromImage( copy ) );
+    }
+
+    // writable for QImage, or setting the device pixel ratio of the tile
+    // when painting it would copy it; nothing paints on the tiles
+    const QImage shared( const_cast< uchar * >( image.constScanLine( part.y() ) ) + offset, part.width(), part.height(), image.bytesPerLine(),
+                         image.format(), releaseTileSource, new QImage( image ) );
+    return new QPixmap( pixmapFromImage( shared ) );
+}
+
+template< typename T >
+static void rotatePixels( const QImage &source, QImage &target, int angle )
+{
+    const int width = source.width();
+    const int height = source.height();
+    for ( int y = 0; y < target.height(); ++y )
+    {
+        T *line = reinterpret_cast< T * >( target.scanLine( y ) );
+        for ( int x = 0; x < target.width(); ++x )
+        {
+            int sourceX, sourceY;
+            switch ( angle )
+            {
+                case 90:
+                    sourceX = y;
+                    sourceY = height - 1 - x;
+                    break;
+                case 180:
+                    sourceX = width - 1 - x;
+                    sourceY = height - 1 - y;
+                    break;
+                default: // 270
+                    sourceX = width - 1 - y;
+                    sourceY = x;
+                    break;
+            }
+            line[ x ] = reinterpret_cast< const T * >( source.constScanLine( sourceY ) )[ sourceX ];
+        }
+    }
+}
+
+/* Returns @p pixmap rotated clockwise by @p angle, a multiple of 90 degrees,
+ * in a pooled buffer for the usual formats of the tiles. */
+static QPixmap *rotatedTilePixmap( const QPixmap *pixmap, int angle )
+{
+    angle = ( angle % 360 + 360 ) % 360;
+    const QImage source = pixmap->toImage();
+    if ( angle == 0 )
+        return new QPixmap( pixmapFromImage( source ) );
+
+    if ( source.depth() == 8 || source.depth() == 32 )
+    {
+        QImage target = angle == 180 ? TilePool::instance()->image( source.width(), source.height(), source.format() )
+                                     : TilePool::instance()->image( source.height(), source.width(), source.format() );
+        if ( !target.isNull() )
+        {
+            target.setColorTable( source.colorTable() );
+            if ( source.depth() == 8 )
+                rotatePixels< uchar >( source, target, angle );
+            else
+                rotatePixels< quint32 >( source, target, angle );
+            return new QPixmap( pixmapFromImage( target ) );
+        }
+    }
+
+    return new QPixmap( pixmapFromImage( source.transformed( QTransform().rotate( angle ) ) ) );
+}
+
 static bool rankedTilesLessThan( TileNode *t1, TileNode *t2 )
 {
     // Order tiles by its dirty state and then by distance from the viewport.
@@ -35,7 +135,7 @@ class TilesManager::Private
 
         bool hasPixmap( const NormalizedRect &rect, const TileNode &tile ) const;
         void tilesAt( const NormalizedRect &rect, TileNode &tile, QList<Tile> &result, TileLeaf tileLeaf );
-        void setPixmap( const QPixmap *pixmap, const NormalizedRect &rect, TileNode &tile, bool isPartialPixmap );
+        void setPixmap( const QImage &image, const NormalizedRect &rect, TileNode &tile, bool isPartialPixmap );
 
         /**
          * Mark @p tile and all its children as dirty
@@ -70,23 +170,27 @@ class TilesManager::Private
         int width;
         int height;
         int pageNumber;
-        qulonglong totalPixels;
+        qulonglong totalMemory;
         Rotation rotation;
         NormalizedRect visibleRect;
-        NormalizedRect requestRect;
-        int requestWidth;
-        int requestHeight;
+
+        // the regions being rendered, several at once for generators
+        // rendering tiles in parallel
+        struct Request
+        {
+            NormalizedRect rect;
+            int width;
+            int height;
+        };
+        QList< Request > requests;
 };
 
 TilesManager::Private::Private()
     : width( 0 )
     , height( 0 )
     , pageNumber( 0 )
-    , totalPixels( 0 )
+    , totalMemory( 0 )
     , rotation( Rotation0 )
-    , requestRect( NormalizedRect() )
-    , requestWidth( 0 )
-    , requestHeight( 0 )
 {
 }
 
@@ -120,7 +224,7 @@ void TilesManager::Private::deleteTiles( const TileNode &tile )
 {
     if ( tile.pixmap )
     {
-        totalPixels -= tile.pixmap->width()*tile.pixmap->height();
+        totalMemory -= pixmapMemory( tile.pixmap );
         delete tile.pixmap;
     }
 
@@ -129,7 +233,7 @@ void TilesManager::Private::deleteTiles( const TileNode &tile )
         for ( int i = 0; i < tile.nTiles; ++i )
             deleteTiles( tile.tiles[ i ] );
 
-        delete [] tile.tiles;
+        TilePool::instance()->releaseNodes( tile.tiles );
     }
 }
 
@@ -188,16 +292,19 @@ void TilesManager::Private::markDirty( TileNode &tile )
 void TilesManager::setPixmap( const QPixmap *pixmap, const NormalizedRect &rect, bool isPartialPixmap )
 {
     const NormalizedRect rotatedRect = TilesManager::fromRotatedRect( rect, d->rotation );
-    if ( !d->requestRect.isNull() )
+    if ( !d->requests.isEmpty() )
     {
-        if ( !(d->requestRect == rect) )
+        int request = 0;
+        while ( request < d->requests.count() && !( d->requests.at( request ).rect == rect ) )
+            ++request;
+        if ( request == d->requests.count() )
             return;
 
         if ( pixmap )
         {
             // Check whether the pixmap has the same absolute size of the expected
             // request.
-            // If the document is rotated, rotate requestRect back to the original
+            // If the document is rotated, rotate the request back to the original
             // rotation before comparing to pixmap's size. This is to avoid
             // conversion issues. The pixmap request was made using an unrotated
             // rect.
@@ -214,21 +321,25 @@ void TilesManager::setPixmap( const QPixmap *pixmap, const NormalizedRect &rect,
                 return;
         }
 
-        d->requestRect = NormalizedRect();
+        d->requests.removeAt( request );
     }
 
+    // with raster pixmaps this shares the pixels, and so do the tiles
+    const QImage image = pixmap ? pixmap->toImage() : QImage();
     for ( int i = 0; i < 16; ++i )
     {
-        d->setPixmap( pixmap, rotatedRect, d->tiles[ i ], isPartialPixmap );
+        d->setPixmap( image, rotatedRect, d->tiles[ i ], isPartialPixmap );
     }
 }
 
-void TilesManager::Private::setPixmap( const QPixmap *pixmap, const NormalizedRect &rect, TileNode &tile, bool isPartialPixmap )
+void TilesManager::Private::setPixmap( const QImage &image, const NormalizedRect &rect, TileNode &tile, bool isPartialPixmap )
 {
     QRect pixmapRect = TilesManager::toRotatedRect( rect, rotation ).geometry( width, height );
 
-    // Exclude tiles outside the viewport
-    if ( !tile.rect.intersects( rect ) )
+    // Exclude tiles outside the viewport, and the ones only touching it: the
+    // tiles are requested one by one, so the neighbours share an edge
+    const NormalizedRect rectIntersection = tile.rect & rect;
+    if ( rectIntersection.width() <= 0 || rectIntersection.height() <= 0 )
         return;
 
     // if the tile is not entirely within the viewport (the tile intersects an
@@ -239,7 +350,7 @@ void TilesManager::Private::setPixmap( const QPixmap *pixmap, const NormalizedRe
         if ( tile.nTiles > 0 )
         {
             for ( int i = 0; i < tile.nTiles; ++i )
-                setPixmap( pixmap, rect, tile.tiles[ i ], isPartialPixmap );
+                setPixmap( image, rect, tile.tiles[ i ], isPartialPixmap );
 
             delete tile.pixmap;
             tile.pixmap = nullptr;
@@ -258,15 +369,15 @@ void TilesManager::Private::setPixmap( const QPixmap *pixmap, const NormalizedRe
         {
             if ( tile.pixmap )
             {
-                totalPixels -= tile.pixmap->width()*tile.pixmap->height();
+                totalMemory -= pixmapMemory( tile.pixmap );
                 delete tile.pixmap;
             }
             tile.rotation = rotation;
-            if ( pixmap )
+            if ( !image.isNull() )
             {
                 const NormalizedRect rotatedRect = TilesManager::toRotatedRect( tile.rect, rotation );
-                tile.pixmap = new QPixmap( pixmap->copy( rotatedRect.geometry( width, height ).translated( -pixmapRect.topLeft() ) ) );
-                totalPixels += tile.pixmap->width()*tile.pixmap->height();
+                tile.pixmap = tilePixmap( image, rotatedRect.geometry( width, height ).translated( -pixmapRect.topLeft() ) );
+                totalMemory += pixmapMemory( tile.pixmap );
             }
             else
             {
@@ -277,13 +388,13 @@ void TilesManager::Private::setPixmap( const QPixmap *pixmap, const NormalizedRe
         {
             if ( tile.pixmap )
             {
-                totalPixels -= tile.pixmap->width()*tile.pixmap->height();
+                totalMemory -= pixmapMemory( tile.pixmap );
                 delete tile.pixmap;
                 tile.pixmap = nullptr;
             }
 
             for ( int i = 0; i < tile.nTiles; ++i )
-                setPixmap( pixmap, rect, tile.tiles[ i ], isPartialPixmap );
+                setPixmap( image, rect, tile.tiles[ i ], isPartialPixmap );
         }
     }
     else
@@ -296,13 +407,13 @@ void TilesManager::Private::setPixmap( const QPixmap *pixmap, const NormalizedRe
             tile.dirty = isPartialPixmap;
             if ( tile.pixmap )
             {
-                totalPixels -= tile.pixmap->width()*tile.pixmap->height();
+                totalMemory -= pixmapMemory( tile.pixmap );
                 delete tile.pixmap;
                 tile.pixmap = nullptr;
             }
 
             for ( int i = 0; i < tile.nTiles; ++i )
-                setPixmap( pixmap, rect, tile.tiles[ i ], isPartialPixmap );
+                setPixmap( image, rect, tile.tiles[ i ], isPartialPixmap );
         }
         else
         {
@@ -313,22 +424,22 @@ void TilesManager::Private::setPixmap( const QPixmap *pixmap, const NormalizedRe
                 tile.tiles[ i ].pixmap = nullptr;
             }
 
-            delete [] tile.tiles;
+            TilePool::instance()->releaseNodes( tile.tiles );
             tile.tiles = nullptr;
             tile.nTiles = 0;
 
             // paint tile
             if ( tile.pixmap )
             {
-                totalPixels -= tile.pixmap->width()*tile.pixmap->height();
+                totalMemory -= pixmapMemory( tile.pixmap );
                 delete tile.pixmap;
             }
             tile.rotation = rotation;
-            if ( pixmap )
+            if ( !image.isNull() )
             {
                 const NormalizedRect rotatedRect = TilesManager::toRotatedRect( tile.rect, rotation );
-                tile.pixmap = new QPixmap( pixmap->copy( rotatedRect.geometry( width, height ).translated( -pixmapRect.topLeft() ) ) );
-                totalPixels += tile.pixmap->width()*tile.pixmap->height();
+                tile.pixmap = tilePixmap( image, rotatedRect.geometry( width, height ).translated( -pixmapRect.topLeft() ) );
+                totalMemory += pixmapMemory( tile.pixmap );
             }
             else
             {
@@ -406,46 +517,12 @@ void TilesManager::Private::tilesAt( const NormalizedRect &rect, TileNode &tile,
         if ( tile.pixmap && tileLeaf == PixmapTile && tile.rotation != rotation )
         {
             // Lazy tiles rotation
-            int angleToRotate = (rotation - tile.rotation)*90;
-            int xOffset = 0, yOffset = 0;
-            int w = 0, h = 0;
-            switch( angleToRotate )
-            {
-                case 0:
-                    xOffset = 0;
-                    yOffset = 0;
-                    w = tile.pixmap->width();
-                    h = tile.pixmap->height();
-                    break;
-                case 90:
-                case -270:
-                    xOffset = 0;
-                    yOffset = -tile.pixmap->height();
-                    w = tile.pixmap->height();
-                    h = tile.pixmap->width();
-                    break;
-                case 180:
-                case -180:
-                    xOffset = -tile.pixmap->width();
-                    yOffset = -tile.pixmap->height();
-                    w = tile.pixmap->width();
-                    h = tile.pixmap->height();
-                    break;
-                case 270:
-                case -90:
-                    xOffset = -tile.pixmap->width();
-                    yOffset = 0;
-                    w = tile.pixmap->height();
-                    h = tile.pixmap->width();
-                    break;
-            }
-            QPixmap *rotatedPixmap = new QPixmap( w, h );
-            QPainter p( rotatedPixmap );
-            p.rotate( angleToRotate );
-            p.translate( xOffset, yOffset );
-            p.drawPixmap( 0, 0, *tile.pixmap );
-            p.end();
+            const int angleToRotate = ( rotation - tile.rotation ) * 90;
+            QPixmap *rotatedPixmap = rotatedTilePixmap( tile.pixmap, angleToRotate );
 
+            // the lines of the rotated pixmap may be padded differently
+            totalMemory -= pixmapMemory( tile.pixmap );
+            totalMemory += pixmapMemory( rotatedPixmap );
             delete tile.pixmap;
             tile.pixmap = rotatedPixmap;
             tile.rotation = rotation;
@@ -461,7 +538,7 @@ void TilesManager::Private::tilesAt( const NormalizedRect &rect, TileNode &tile,
 
 qulonglong TilesManager::totalMemory() const
 {
-    return 4*d->totalPixels;
+    return d->totalMemory;
 }
 
 void TilesManager::cleanupPixmapMemory( qulonglong numberOfBytes, const NormalizedRect &visibleRect, int visiblePageNumber )
@@ -483,12 +560,12 @@ void TilesManager::cleanupPixmapMemory( qulonglong numberOfBytes, const Normaliz
         if ( tile->rect.intersects( visibleRect ) )
             continue;
 
-        qulonglong pixels = tile->pixmap->width()*tile->pixmap->height();
-        d->totalPixels -= pixels;
-        if ( numberOfBytes < 4*pixels )
+        const qulonglong memory = pixmapMemory( tile->pixmap );
+        d->totalMemory -= memory;
+        if ( numberOfBytes < memory )
             numberOfBytes = 0;
         else
-            numberOfBytes -= 4*pixels;
+            numberOfBytes -= memory;
 
         delete tile->pixmap;
         tile->pixmap = nullptr;
@@ -551,14 +628,32 @@ void TilesManager::Private::rankTiles( TileNode &tile, QList<TileNode*> &rankedT
 
 bool TilesManager::isRequesting( const NormalizedRect &rect, int pageWidth, int pageHeight ) const
 {
-    return rect == d->requestRect && pageWidth == d->requestWidth && pageHeight == d->requestHeight;
+    for ( const Private::Request &request : qAsConst( d->requests ) )
+    {
+        if ( rect == request.rect && pageWidth == request.width && pageHeight == request.height )
+            return true;
+    }
+    return false;
 }
 
 void TilesManager::setRequest( const NormalizedRect &rect, int pageWidth, int pageHeight )
 {
-    d->requestRect = rect;
-    d->requestWidth = pageWidth;
-    d->requestHeight = pageHeight;
+    if ( rect.isNull() )
+    {
+        d->requests.clear();
+        return;
+    }
+
+    // the pixmaps rendered for another size of the page are of no use
+    for ( int i = d->requests.count() - 1; i >= 0; --i )
+    {
+        const Private::Request &request = d->requests.at( i );
+        if ( request.width != pageWidth || request.height != pageHeight )
+            d->requests.removeAt( i );
+    }
+
+    const Private::Request request = { rect, pageWidth, pageHeight };
+    d->requests.append( request );
 }
 
 bool TilesManager::Private::splitBigTiles( TileNode &tile, const NormalizedRect &rect )
@@ -580,7 +675,7 @@ void TilesManager::Private::split( TileNode &tile, const NormalizedRect &rect )
         return;
 
     tile.nTiles = 4;
-    tile.tiles = new TileNode[4];
+    tile.tiles = TilePool::instance()->allocateNodes();
     double hCenter = (tile.rect.left + tile.rect.right)/2;
     double vCenter = (tile.rect.top + tile.rect.bottom)/2;
 
@@ -155,8 +155,12 @@ class TilesManager
         bool isRequesting( const NormalizedRect &rect, int pageWidth, int pageHeight ) const;
 
         /**
-         * Sets a region to be requested so the tiles manager knows which
-         * pixmaps to expect and discard those not useful anymore (late pixmaps)
+         * Adds a region to be requested so the tiles manager knows which
+         * pixmaps to expect and discard those not useful anymore (late pixmaps).
+         * Several regions can be requested at once, as long as they are for
+         * the same size of the page; a null @p rect forgets them all.
+         *
+         * setPixmap() with a requested region forgets it.
          */
         void setRequest( const NormalizedRect &rect, int pageWidth, int pageHeight );
 
@@ -134,6 +134,59 @@ got_bottom:
     return bbox;
 }
 
+QImage Okular::compactImage( const QImage &image )
+{
+    switch ( image.format() )
+    {
+        case QImage::Format_Mono:
+        case QImage::Format_MonoLSB:
+        case QImage::Format_Indexed8:
+            // the color table tells
+            if ( image.isGrayscale() && !image.hasAlphaChannel() )
+                return image.convertToFormat( QImage::Format_Grayscale8 );
+            return image;
+
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+        {
+            // most pages of text are black on white with gray antialiasing;
+            // colored pages usually show a color soon, so this stops early
+            const bool hasAlpha = image.hasAlphaChannel();
+            const int width = image.width();
+            const int height = image.height();
+            for ( int y = 0; y < height; ++y )
+            {
+                const QRgb *line = reinterpret_cast< const QRgb * >( image.constScanLine( y ) );
+                for ( int x = 0; x < width; ++x )
+                {
+                    if ( !qIsGray( line[ x ] ) || ( hasAlpha && qAlpha( line[ x ] ) != 255 ) )
+                        return image;
+                }
+            }
+            return image.convertToFormat( QImage::Format_Grayscale8 );
+        }
+
+        default:
+            return image;
+    }
+}
+
+QImage Okular::pixmapImage( const QImage &image )
+{
+    const QImage compact = compactImage( image );
+    switch ( compact.format() )
+    {
+        case QImage::Format_Invalid:
+        case QImage::Format_Grayscale8:
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+            return compact;
+        default:
+            return compact.convertToFormat( compact.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32 );
+    }
+}
+
 void Okular::copyQIODevice( QIODevice *from, QIODevice *to )
 {
     QByteArray buffer( 65536, '\0' );
@@ -10,6 +10,12 @@
 #ifndef _OKULAR_UTILS_P_H_
 #define _OKULAR_UTILS_P_H_
 
+#include <QtGui/QImage>
+#include <QtGui/QPixmap>
+#include <QtGui/QTransform>
+
+#include "global.h"
+
 class QIODevice;
 
 namespace Okular
@@ -22,6 +28,52 @@ void copyQIODevice( QIODevice *from, QIODevice *to );
  */
 QTransform buildRotationMatrix( Rotation rotation );
 
+/**
+ * Return @p image in the most compact format that paints the same: opaque
+ * gray images (including bilevel and grayscale indexed ones) become
+ * Grayscale8, any other image is returned as it is.
+ */
+QImage compactImage( const QImage &image );
+
+/**
+ * Return @p image in the format its pixmap is kept in: the compactImage()
+ * of it, converted to RGB32 or ARGB32_Premultiplied unless it is one of
+ * them or Grayscale8.
+ *
+ * Meant for the threads rendering the images, so that pixmapFromImage()
+ * has nothing to convert in the GUI thread.
+ */
+QImage pixmapImage( const QImage &image );
+
+/**
+ * Convert @p image to a pixmap. The formats returned by pixmapImage() are
+ * kept as they are, and then the pixmap shares the pixels of the image.
+ * In particular the compact images are not expanded to 32 bits.
+ *
+ * 1 bit images are not kept as they are, as QPainter paints 1 bit pixmaps
+ * with the pen color like bitmaps; compactImage() turns them to Grayscale8.
+ */
+inline QPixmap pixmapFromImage( const QImage &image )
+{
+    switch ( image.format() )
+    {
+        case QImage::Format_Grayscale8:
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+            return QPixmap::fromImage( image, Qt::NoFormatConversion );
+        default:
+            return QPixmap::fromImage( image );
+    }
+}
+
+/**
+ * Return the memory taken by the pixels of @p pixmap.
+ */
+inline qulonglong pixmapMemory( const QPixmap *pixmap )
+{
+    return (qulonglong)pixmap->width() * pixmap->height() * pixmap->depth() / 8;
+}
+
 }
 
 #endif
@@ -74,6 +74,7 @@ DjVuGenerator::DjVuGenerator( QObject *parent, const QVariantList &args )
 {
     setFeature( TextExtraction );
     setFeature( Threaded );
+    setFeature( SupportsCancelling );
     setFeature( PrintPostscript );
     if ( Okular::FilePrinter::ps2pdfAvailable() )
         setFeature( PrintToFile );
@@ -112,10 +113,16 @@ bool DjVuGenerator::doCloseDocument()
     return true;
 }
 
+static bool shouldAbortRenderCallback( void *payload )
+{
+    return static_cast< Okular::PixmapRequest * >( payload )->shouldAbortRender();
+}
+
 QImage DjVuGenerator::image( Okular::PixmapRequest *request )
 {
     userMutex()->lock();
-    QImage img = m_djvu->image( request->pageNumber(), request->width(), request->height(), request->page()->rotation() );
+    QImage img = m_djvu->image( request->pageNumber(), request->width(), request->height(), request->page()->rotation(),
+                                shouldAbortRenderCallback, request );
     userMutex()->unlock();
     return img;
 }
@@ -909,7 +909,8 @@ const QVector<KDjVu::Page*> &KDjVu::pages() const
     return d->m_pages;
 }
 
-QImage KDjVu::image( int page, int width, int height, int rotation )
+QImage KDjVu::image( int page, int width, int height, int rotation,
+                     bool (*shouldAbort)( void *payload ), void *abortPayload )
 {
     if ( d->m_cacheEnabled )
     {
@@ -942,7 +943,17 @@ QImage KDjVu::image( int page, int width, int height, int rotation )
         // wait for the new page to be loaded
         ddjvu_status_t sts;
         while ( ( sts = ddjvu_page_decoding_status( newpage ) ) < DDJVU_JOB_OK )
+        {
+            if ( shouldAbort && shouldAbort( abortPayload ) )
+            {
+                // the decoding is started again by the next request of the page
+                ddjvu_job_stop( ddjvu_page_job( newpage ) );
+                ddjvu_page_release( newpage );
+                handle_ddjvu_messages( d->m_djvu_cxt, false );
+                return QImage();
+            }
             handle_ddjvu_messages( d->m_djvu_cxt, true );
+        }
         d->m_pages_cache[page] = newpage;
     }
     ddjvu_page_t *djvupage = d->m_pages_cache[page];
@@ -964,6 +975,9 @@ QImage KDjVu::image( int page, int width, int height, int rotation )
 
     QImage newimg;
 
+    if ( shouldAbort && shouldAbort( abortPayload ) )
+        return QImage();
+
     int res = 10000;
     if ( ( xparts == 1 ) && ( yparts == 1 ) )
     {
@@ -981,6 +995,11 @@ QImage KDjVu::image( int page, int width, int height, int rotation )
         int parts = xparts * yparts;
         for ( int i = 0; i < parts; ++i )
         {
+            if ( shouldAbort && shouldAbort( abortPayload ) )
+            {
+                p.end();
+                return QImage();
+            }
             int row = i % xparts;
             int col = i / xparts;
             int tmpres = 0;
@@ -254,8 +254,13 @@ class KDjVu
          * Check if the image for the specified \p page with the specified
          * \p width, \p height and \p rotation is already in cache, and returns
          * it. If not, a null image is returned.
+         *
+         * If \p shouldAbort is given, it is called with \p abortPayload while
+         * the page is decoded and between the rendered parts; as soon as it
+         * returns true the rendering stops and a null image is returned.
          */
-        QImage image( int page, int width, int height, int rotation );
+        QImage image( int page, int width, int height, int rotation,
+                      bool (*shouldAbort)( void *payload ) = nullptr, void *abortPayload = nullptr );
 
         /**
          * Export the currently open document as PostScript file \p fileName.
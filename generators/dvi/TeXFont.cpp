@@ -2,7 +2,59 @@
 #include <config.h>
 
 #include "TeXFont.h"
+#include "fontpool.h"
 
 
 TeXFont::~TeXFont()
-{}
+{
+  // Forget about the glyphs of this font that are still cached for
+  // other resolutions
+  QCache<QPair<const TeXFont *, quint64>, shrunkenGlyph> &cache = parent->font_pool->glyphCache;
+  const QList<QPair<const TeXFont *, quint64> > keys = cache.keys();
+  for (const QPair<const TeXFont *, quint64> &key : keys)
+    if (key.first == this)
+      cache.remove(key);
+}
+
+
+QPair<const TeXFont *, quint64> TeXFont::glyphCacheKey(quint16 character, double resolution_in_dpi) const
+{
+  // Resolutions are quantized to 1/8 dpi
+  return qMakePair(this, ((quint64)character << 32) | (quint32)qRound(resolution_in_dpi * 8.0));
+}
+
+
+void TeXFont::setDisplayResolution(double oldResolution_in_dpi, double newResolution_in_dpi)
+{
+  QCache<QPair<const TeXFont *, quint64>, shrunkenGlyph> &cache = parent->font_pool->glyphCache;
+
+  for(unsigned int i=0; i<TeXFontDefinition::max_num_of_chars_in_font; i++) {
+    glyph *g = glyphtable+i;
+
+    if (!g->shrunkenCharacter.isNull()) {
+      shrunkenGlyph *old = new shrunkenGlyph;
+      old->image = g->shrunkenCharacter;
+      old->color = g->color;
+      old->x2    = g->x2;
+      old->y2    = g->y2;
+      cache.insert(glyphCacheKey(i, oldResolution_in_dpi), old, qMax(old->image.byteCount(), 1));
+    }
+
+    shrunkenGlyph *cached = cache.take(glyphCacheKey(i, newResolution_in_dpi));
+    if (cached != nullptr) {
+      g->shrunkenCharacter = cached->image;
+      g->color             = cached->color;
+      g->x2                = cached->x2;
+      g->y2                = cached->y2;
+      delete cached;
+    } else
+      g->shrunkenCharacter = QImage();
+  }
+}
+
+
+void TeXFont::invalidateGlyphs()
+{
+  for(unsigned int i=0; i<TeXFontDefinition::max_num_of_chars_in_font; i++)
+    glyphtable[i].shrunkenCharacter = QImage();
+}
@@ -12,6 +12,8 @@
 #include "glyph.h"
 #include "TeXFontDefinition.h"
 
+#include <QPair>
+
 
 class TeXFont {
  public:
@@ -23,11 +25,14 @@ class TeXFont {
 
   virtual ~TeXFont();
 
-  void setDisplayResolution()
-    {
-      for(unsigned int i=0; i<TeXFontDefinition::max_num_of_chars_in_font; i++)
-        glyphtable[i].shrunkenCharacter = QImage();
-    }
+  // Switches the rasterized glyphs from one display resolution to
+  // another. The glyphs of the old resolution are handed over to the
+  // glyph cache of the font pool, and those of the new resolution are
+  // taken back from it if they are still there.
+  void setDisplayResolution(double oldResolution_in_dpi, double newResolution_in_dpi);
+
+  // Drops all rasterized glyphs, e.g. when the hinting changes.
+  void invalidateGlyphs();
 
   virtual glyph* getGlyph(quint16 character, bool generateCharacterPixmap=false, const QColor& color=Qt::black) = 0;
 
@@ -41,6 +46,8 @@ class TeXFont {
   QString            errorMessage;
 
  protected:
+  QPair<const TeXFont *, quint64> glyphCacheKey(quint16 character, double resolution_in_dpi) const;
+
   glyph              glyphtable[TeXFontDefinition::max_num_of_chars_in_font];
   TeXFontDefinition *parent;
 };
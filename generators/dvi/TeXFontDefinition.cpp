@@ -204,9 +204,16 @@ void TeXFontDefinition::reset()
 
 void TeXFontDefinition::setDisplayResolution(double _displayResolution_in_dpi)
 {
+  if (font != nullptr)
+    font->setDisplayResolution(displayResolution_in_dpi, _displayResolution_in_dpi);
   displayResolution_in_dpi = _displayResolution_in_dpi;
+}
+
+
+void TeXFontDefinition::invalidateGlyphs()
+{
   if (font != nullptr)
-    font->setDisplayResolution();
+    font->invalidateGlyphs();
 }
 
 
@@ -77,6 +77,7 @@ class TeXFontDefinition {
 
   // Members for character fonts
   void           setDisplayResolution(double _displayResolution_in_dpi);
+  void           invalidateGlyphs();
 
   bool           isLocated() const {return ((flags & FONT_KPSE_NAME) != 0);}
   void           markAsLocated() {flags |= FONT_KPSE_NAME;}
@@ -15,9 +15,12 @@ dviPageInfo::dviPageInfo( const dviPageInfo &dvipi )
     height = dvipi.height;
     resolution = dvipi.resolution;
     pageNumber = dvipi.pageNumber;
+    shouldAbort = dvipi.shouldAbort;
+    abortPayload = dvipi.abortPayload;
 }
 
 dviPageInfo::dviPageInfo() 
+    : shouldAbort( nullptr ), abortPayload( nullptr )
 {
     sourceHyperLinkList.reserve(200);
 }
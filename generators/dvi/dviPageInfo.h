@@ -40,6 +40,12 @@ public:
     */
    QVector<Hyperlink> hyperLinkList;
    QVector<TextBox> textBoxList;
+
+   /** \brief Polled while the page is drawn; when it returns true the
+       drawing stops and img is left null
+    */
+   bool (*shouldAbort)( void *payload );
+   void *abortPayload;
 };
 
 /* quick&dirty hack to cheat the dviRenderer class... */
@@ -179,6 +179,12 @@ void dviRenderer::drawPage(RenderedDocumentPagePixmap* page)
   {
     qCDebug(OkularDviDebug) << "painter creation failed.";
   } 
+  if (drawingAborted()) {
+    // the image is incomplete, leave page->img null
+    errorMsg.clear();
+    currentlyDrawnPage = nullptr;
+    return;
+  }
   page->img = img;
 //page->setImage(img);
  
@@ -250,6 +256,12 @@ void dviRenderer::drawPage(RenderedDocumentPagePixmap* page)
 }
 
 
+bool dviRenderer::drawingAborted() const
+{
+  return currentlyDrawnPage && currentlyDrawnPage->shouldAbort && currentlyDrawnPage->shouldAbort(currentlyDrawnPage->abortPayload);
+}
+
+
 void dviRenderer::getText(RenderedDocumentPagePixmap* page)
 {
   bool postscriptBackup = _postscript;
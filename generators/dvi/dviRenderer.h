@@ -204,6 +204,9 @@ private:
 
   void  setResolution(double resolution_in_DPI);
 
+  /** Whether the page that is currently drawn is not wanted anymore */
+  bool  drawingAborted() const;
+
   fontPool      font_pool;
 
   double        resolutionInDPI;
@@ -281,6 +281,10 @@ void dviRenderer::draw_part(double current_dimconv, bool is_vfmacro)
   bool space_encountered = false;
   bool after_space = false;
   for (;;) {
+    // checked between the commands so that a page that is not wanted
+    // anymore stops drawing quickly
+    if (drawingAborted())
+      return;
     space_encountered = false;
     ch = readUINT8();
     if (ch <= (unsigned char) (SETCHAR0 + 127)) {
@@ -673,7 +677,7 @@ void dviRenderer::draw_page()
 #endif
 
   // Render the PostScript background, if there is one.
-  if (_postscript)
+  if (_postscript && !drawingAborted())
   {
 #if 0
     // In accessiblity mode use the custom background color
@@ -43,6 +43,7 @@ fontPool::fontPool(bool useFontHinting)
 
   displayResolution_in_dpi = 100.0; // A not-too-bad-default
   useFontHints             = useFontHinting;
+  glyphCache.setMaxCost(16 * 1024 * 1024);
   CMperDVIunit             = 0;
   extraSearchPath.clear();
 
@@ -107,11 +108,11 @@ void fontPool::setParameters( bool _useFontHints )
 {
   // Check if glyphs need to be cleared
   if (_useFontHints != useFontHints) {
-    double displayResolution = displayResolution_in_dpi;
+    glyphCache.clear();
     QList<TeXFontDefinition*>::iterator it_fontp = fontList.begin();
     for (; it_fontp != fontList.end(); ++it_fontp) {
       TeXFontDefinition *fontp = *it_fontp;
-      fontp->setDisplayResolution(displayResolution * fontp->enlargement);
+      fontp->invalidateGlyphs();
     }
   }
 
@@ -357,9 +358,11 @@ void fontPool::setCMperDVIunit( double _CMperDVI )
 
   CMperDVIunit = _CMperDVI;
 
+  glyphCache.clear();
   QList<TeXFontDefinition*>::iterator it_fontp = fontList.begin();
   for (; it_fontp != fontList.end(); ++it_fontp) {
     TeXFontDefinition *fontp = *it_fontp;
+    fontp->invalidateGlyphs();
     fontp->setDisplayResolution(displayResolution_in_dpi * fontp->enlargement);
   }
 }
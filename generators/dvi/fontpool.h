@@ -9,10 +9,13 @@
 
 #include "fontEncodingPool.h"
 #include "fontMap.h"
+#include "glyph.h"
 #include "TeXFontDefinition.h"
 
+#include <QCache>
 #include <QList>
 #include <QObject>
+#include <QPair>
 #include <QProcess>
 
 #ifdef HAVE_FREETYPE
@@ -122,6 +125,13 @@ public:
       drawing routines for the different setups. */
   bool QPixmapSupportsAlpha;
 
+  /** Glyphs rasterized for display resolutions other than the current
+      one, keyed by font, character and resolution. Thumbnails, the
+      page view and the presentation mode all render at different
+      resolutions; this cache lets them switch back and forth without
+      rasterizing every glyph again. The cost is measured in bytes. */
+  QCache<QPair<const TeXFont *, quint64>, shrunkenGlyph> glyphCache;
+
 Q_SIGNALS:
   /** Passed through to the top-level kpart. */
   void error( const QString &message, int duration );
@@ -22,8 +22,11 @@
 #include "pageSize.h"
 #include "dviexport.h"
 #include "TeXFont.h"
+#include "TeXFontDefinition.h"
+#include "fontpool.h"
 
 #include <qapplication.h>
+#include <qcryptographichash.h>
 #include <qdir.h>
 #include <qstring.h>
 #include <qurl.h>
@@ -31,6 +34,7 @@
 #include <qstack.h>
 #include <qtemporaryfile.h>
 #include <qmutex.h>
+#include <qmap.h>
 
 #include <KAboutData>
 #include <QtCore/QDebug>
@@ -46,6 +50,7 @@ DviGenerator::DviGenerator( QObject *parent, const QVariantList &args ) : Okular
   m_fontExtracted( false ), m_docSynopsis( nullptr ), m_dviRenderer( nullptr )
 {
     setFeature( Threaded );
+    setFeature( SupportsCancelling );
     setFeature( TextExtraction );
     setFeature( FontInfo );
     setFeature( PrintPostscript );
@@ -186,6 +191,11 @@ QLinkedList<Okular::ObjectRect*> DviGenerator::generateDviLinks( const dviPageIn
     return dviLinks; 
 }
 
+static bool shouldAbortRenderCallback( void *payload )
+{
+    return static_cast< Okular::PixmapRequest * >( payload )->shouldAbortRender();
+}
+
 QImage DviGenerator::image( Okular::PixmapRequest *request )
 {
 
@@ -198,6 +208,9 @@ QImage DviGenerator::image( Okular::PixmapRequest *request )
 
     pageInfo->pageNumber = request->pageNumber() + 1;
 
+    pageInfo->shouldAbort = shouldAbortRenderCallback;
+    pageInfo->abortPayload = request;
+
 //  pageInfo->resolution = m_resolution;
 
     QMutexLocker lock( userMutex() );
@@ -570,9 +583,74 @@ QVariant DviGenerator::metaData( const QString & key, const QVariant & option )
             }
         }
     }
+    else if ( key == QLatin1String("PageFingerprints") )
+    {
+        return pageFingerprints();
+    }
     return QVariant();
 }
 
+QVariantList DviGenerator::pageFingerprints() const
+{
+    QVariantList fingerprints;
+    if ( !m_dviRenderer || !m_dviRenderer->dviFile )
+        return fingerprints;
+
+    QMutexLocker lock( userMutex() );
+    dvifile *dvif = m_dviRenderer->dviFile;
+    const int numofpages = dvif->total_pages;
+    if ( dvif->page_offset.size() <= numofpages )
+        return fingerprints;
+
+    // the fonts are defined globally, so a page is only the same if
+    // the fonts it refers to by number are the same too
+    QCryptographicHash fontsHash( QCryptographicHash::Sha1 );
+    fontsHash.addData( QByteArray::number( dvif->getMagnification() ) );
+    fontsHash.addData( QByteArray::number( dvif->getCmPerDVIunit(), 'g', 17 ) );
+    QMap<int, TeXFontDefinition*> fonts;
+    for ( QHash<int, TeXFontDefinition*>::const_iterator it = dvif->tn_table.constBegin(); it != dvif->tn_table.constEnd(); ++it )
+        fonts.insert( it.key(), it.value() );
+    for ( QMap<int, TeXFontDefinition*>::const_iterator it = fonts.constBegin(); it != fonts.constEnd(); ++it )
+    {
+        fontsHash.addData( QByteArray::number( it.key() ) );
+        fontsHash.addData( it.value()->fontname.toUtf8() );
+        fontsHash.addData( QByteArray::number( it.value()->scaled_size_in_DVI_units ) );
+        fontsHash.addData( QByteArray::number( it.value()->enlargement, 'g', 17 ) );
+    }
+    const QByteArray fontsResult = fontsHash.result();
+
+    const char *data = reinterpret_cast<const char *>( dvif->dvi_Data() );
+    for ( int i = 0; i < numofpages; ++i )
+    {
+        // bop is followed by ten counters and the pointer to the previous
+        // page; that pointer changes whenever an earlier page changes size
+        const quint32 begin = dvif->page_offset[i];
+        const quint32 end = dvif->page_offset[i + 1];
+        if ( end < begin + 45 || end > dvif->size_of_file )
+        {
+            fingerprints.append( QByteArray() );
+            continue;
+        }
+
+        const QByteArray counters = QByteArray::fromRawData( data + begin + 1, 40 );
+        const QByteArray commands = QByteArray::fromRawData( data + begin + 45, end - begin - 45 );
+
+        // included graphics can change without the DVI file changing
+        if ( commands.toLower().contains( "psfile" ) )
+        {
+            fingerprints.append( QByteArray() );
+            continue;
+        }
+
+        QCryptographicHash hash( QCryptographicHash::Sha1 );
+        hash.addData( fontsResult );
+        hash.addData( counters );
+        hash.addData( commands );
+        fingerprints.append( hash.result() );
+    }
+    return fingerprints;
+}
+
 Q_LOGGING_CATEGORY(OkularDviDebug, "org.kde.okular.generators.dvi.core", QtWarningMsg)
 Q_LOGGING_CATEGORY(OkularDviShellDebug, "org.kde.okular.generators.dvi.shell", QtWarningMsg)
 
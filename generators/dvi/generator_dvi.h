@@ -59,6 +59,7 @@ class DviGenerator : public Okular::Generator
         QBitArray m_linkGenerated;
 
         void loadPages( QVector< Okular::Page * > & pagesVector );
+        QVariantList pageFingerprints() const;
         Okular::TextPage *extractTextFromPage( dviPageInfo *pageInfo );
         void fillViewportFromAnchor( Okular::DocumentViewport &vp, const Anchor &anch, 
                                      int pW, int pH ) const; 
@@ -41,4 +41,13 @@ class glyph {
   short   x2, y2;
 };
 
+// A glyph rasterized for a given display resolution. The fontPool keeps
+// these for resolutions other than the current one, see
+// fontPool::glyphCache.
+struct shrunkenGlyph {
+  QImage image;
+  QColor color;
+  short  x2, y2;
+};
+
 #endif //ifndef _GLYPH_H
@@ -56,6 +56,8 @@ ghostscript_interface::ghostscript_interface() {
   knownDevices.append(QStringLiteral("pnn"));
   knownDevices.append(QStringLiteral("pnnraw"));
   gsDevice = knownDevices.begin();
+
+  graphicsCache.setMaxCost(64 * 1024 * 1024);
 }
 
 ghostscript_interface::~ghostscript_interface() {
@@ -78,6 +80,8 @@ void ghostscript_interface::setPostScript(const PageNumber& page, const QString&
     pageList.insert(page, info);
   } else
     *(pageList.value(page)->PostScriptString) = PostScript;
+
+  removeCachedGraphics(page);
 }
 
 
@@ -86,6 +90,9 @@ void ghostscript_interface::setIncludePath(const QString &_includePath) {
      includePath = QLatin1Char('*'); // Allow all files
   else
      includePath = _includePath + QStringLiteral("/*");
+
+  // Included files may resolve differently now
+  graphicsCache.clear();
 }
 
 
@@ -143,6 +150,37 @@ void ghostscript_interface::clear() {
   // Deletes all items, removes temporary files, etc.
   qDeleteAll(pageList);
   pageList.clear();
+  graphicsCache.clear();
+}
+
+
+void ghostscript_interface::removeCachedGraphics(quint16 page) {
+  const QList<psGraphicsKey> keys = graphicsCache.keys();
+  for (const psGraphicsKey &key : keys)
+    if (key.page == page)
+      graphicsCache.remove(key);
+}
+
+
+QImage ghostscript_interface::scaledDownGraphics(const psGraphicsKey &key) {
+  const QList<psGraphicsKey> keys = graphicsCache.keys();
+  const psGraphicsKey *best = nullptr;
+  for (const psGraphicsKey &candidate : keys) {
+    if (candidate.page != key.page || candidate.magnification != key.magnification || candidate.background != key.background)
+      continue;
+    if (candidate.width < key.width || candidate.height < key.height)
+      continue;
+    // Only reuse graphics of the same page geometry
+    if (qAbs((qint64)candidate.width * key.height - (qint64)candidate.height * key.width) > (qint64)candidate.height)
+      continue;
+    if (best == nullptr || candidate.width < best->width)
+      best = &candidate;
+  }
+
+  if (best == nullptr)
+    return QImage();
+
+  return graphicsCache.object(*best)->scaled(key.width, key.height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
 }
 
 
@@ -318,15 +356,30 @@ void ghostscript_interface::graphics(const PageNumber& page, double dpi, long ma
     return;
   }
 
-  QTemporaryFile gfxFile;
-  gfxFile.open();
-  const QString gfxFileName = gfxFile.fileName();
-  // We are want the filename, not the file.
-  gfxFile.close();
+  const psGraphicsKey key = { page, magnification, pixel_page_w, pixel_page_h, info->background.rgb() };
+  if (QImage *cached = graphicsCache.object(key)) {
+    paint->drawImage(0, 0, *cached);
+    return;
+  }
 
-  gs_generate_graphics_file(page, gfxFileName, magnification);
-  
-  QImage MemoryCopy(gfxFileName);
+  // Scaling down graphics that were rendered at a larger size (e.g.
+  // for the page view when the thumbnail is requested) is way cheaper
+  // than a ghostscript run and looks just as good
+  QImage MemoryCopy = scaledDownGraphics(key);
+  if (MemoryCopy.isNull()) {
+    QTemporaryFile gfxFile;
+    gfxFile.open();
+    const QString gfxFileName = gfxFile.fileName();
+    // We are want the filename, not the file.
+    gfxFile.close();
+
+    gs_generate_graphics_file(page, gfxFileName, magnification);
+
+    MemoryCopy = QImage(gfxFileName);
+  }
+
+  if (!MemoryCopy.isNull())
+    graphicsCache.insert(key, new QImage(MemoryCopy), qMax(MemoryCopy.byteCount(), 1));
   paint->drawImage(0, 0, MemoryCopy);
   return;
 }
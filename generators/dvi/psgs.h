@@ -11,9 +11,11 @@
 #define _PSGS_H_
 
 #include <QApplication>
+#include <QCache>
 #include <QColor>
 #include <QtGui/qevent.h>
 #include <QHash>
+#include <QImage>
 #include <QObject>
 
 class QUrl;
@@ -33,6 +35,29 @@ public:
 };
 
 
+// Identifies the rasterized PostScript graphics of a page: which page,
+// at which magnification and size, and on which background.
+struct psGraphicsKey
+{
+  quint16 page;
+  long    magnification;
+  int     width;
+  int     height;
+  QRgb    background;
+};
+
+inline bool operator==(const psGraphicsKey &a, const psGraphicsKey &b)
+{
+  return a.page == b.page && a.magnification == b.magnification && a.width == b.width
+    && a.height == b.height && a.background == b.background;
+}
+
+inline uint qHash(const psGraphicsKey &key, uint seed = 0)
+{
+  return qHash(key.page, seed) ^ qHash((qint64)key.magnification, seed) ^ qHash(key.width << 16 ^ key.height, seed) ^ qHash(key.background, seed);
+}
+
+
 class ghostscript_interface  : public QObject
 {
  Q_OBJECT
@@ -80,8 +105,19 @@ public:
 
 private:
   void                  gs_generate_graphics_file(const PageNumber& page, const QString& filename, long magnification);
+
+  // Looks for graphics of the same page rendered at a larger size,
+  // which can be scaled down instead of running ghostscript again.
+  QImage                scaledDownGraphics(const psGraphicsKey &key);
+  void                  removeCachedGraphics(quint16 page);
+
   QHash<quint16,pageInfo*>   pageList;
 
+  // Graphics that ghostscript already rendered, so that re-rendering a
+  // page (e.g. after a zoom change) does not start ghostscript again.
+  // The cost is measured in bytes.
+  QCache<psGraphicsKey, QImage> graphicsCache;
+
   double                resolution;   // in dots per inch
   int                   pixel_page_w; // in pixels
   int                   pixel_page_h; // in pixels
@@ -17,6 +17,7 @@
 #include <QBuffer>
 #include <QFile>
 #include <QImageReader>
+#include <QMutexLocker>
 #include <QPainter>
 #include <QPrinter>
 #include <QMimeType>
@@ -30,16 +31,29 @@
 
 #include <kexiv2/kexiv2.h>
 
+#include <core/fileprinter.h>
 #include <core/page.h>
 
 OKULAR_EXPORT_PLUGIN(KIMGIOGenerator, "libokularGenerator_kimgio.json")
 
+// Whether the Exif orientation swaps the width and the height of the image
+static bool isTransposingOrientation( int orientation )
+{
+    return orientation == KExiv2Iface::KExiv2::ORIENTATION_ROT_90_HFLIP
+        || orientation == KExiv2Iface::KExiv2::ORIENTATION_ROT_90
+        || orientation == KExiv2Iface::KExiv2::ORIENTATION_ROT_90_VFLIP
+        || orientation == KExiv2Iface::KExiv2::ORIENTATION_ROT_270;
+}
+
 KIMGIOGenerator::KIMGIOGenerator( QObject *parent, const QVariantList &args )
-    : Generator( parent, args )
+    : Generator( parent, args ), m_imgPage( -1 ), m_nextFrame( 0 ),
+      m_exifOrientation( KExiv2Iface::KExiv2::ORIENTATION_UNSPECIFIED )
 {
     setFeature( ReadRawData );
     setFeature( Threaded );
     setFeature( TiledRendering );
+    setFeature( ParallelTileRendering );
+    setFeature( SupportsCancelling );
     setFeature( PrintNative );
     setFeature( PrintToFile );
     setFeature( SwapBackingFile );
@@ -56,6 +70,11 @@ bool KIMGIOGenerator::loadDocument( const QString & fileName, QVector<Okular::Pa
         emit error( i18n( "Unable to load document: %1", f.errorString() ), -1 );
         return false;
     }
+    // Map the file instead of reading it all: the encoded data is only
+    // needed while decoding, and the mapping goes away together with f
+    if ( const uchar *data = f.map( 0, f.size() ) ) {
+        return loadDocumentInternal( QByteArray::fromRawData( reinterpret_cast<const char *>( data ), f.size() ), fileName, pagesVector );
+    }
     return loadDocumentInternal( f.readAll(), fileName, pagesVector );
 }
 
@@ -80,6 +99,9 @@ bool KIMGIOGenerator::loadDocumentInternal(const QByteArray & fileData, const QS
             return false;
         }
     }
+    m_imgPage = 0;
+    const QSize firstFrameSize = m_img.size();
+
     QMimeDatabase db;
     auto mime = db.mimeTypeForFileNameAndData( fileName, fileData );
     docInfo.set( Okular::DocumentInfo::MimeType, mime.name() );
@@ -87,14 +109,91 @@ bool KIMGIOGenerator::loadDocumentInternal(const QByteArray & fileData, const QS
     // Apply transformations dictated by Exif metadata
     KExiv2Iface::KExiv2 exifMetadata;
     if ( exifMetadata.loadFromData( fileData ) ) {
+        m_exifOrientation = exifMetadata.getImageOrientation();
         exifMetadata.rotateExifQImage(m_img, exifMetadata.getImageOrientation());
     }
 
-    pagesVector.resize( 1 );
+    // Multi-frame images (animated GIFs, icons, HEIF sequences...) get a
+    // page per frame. Only the encoded data is kept: frames are decoded on
+    // demand by loadFrame(), one at a time.
+    const int frameCount = qMax( reader.imageCount(), 1 );
+    pagesVector.resize( frameCount );
 
     Okular::Page * page = new Okular::Page( 0, m_img.width(), m_img.height(), Okular::Rotation0 );
     pagesVector[0] = page;
 
+    if ( frameCount > 1 ) {
+        // deep copy, as fileData might be just a mapping of the file
+        m_frameData = QByteArray( fileData.constData(), fileData.size() );
+        m_frameFormat = reader.format();
+
+        for ( int i = 1; i < frameCount; ++i ) {
+            QSize frameSize = reader.jumpToImage( i ) ? reader.size() : QSize();
+            if ( !frameSize.isValid() )
+                frameSize = firstFrameSize;
+            if ( isTransposingOrientation( m_exifOrientation ) )
+                frameSize.transpose();
+
+            pagesVector[i] = new Okular::Page( i, frameSize.width(), frameSize.height(), Okular::Rotation0 );
+        }
+    }
+
+    return true;
+}
+
+void KIMGIOGenerator::rewindFrameReader()
+{
+    m_frameReader.reset();
+    m_frameBuffer.close();
+    m_frameBuffer.setBuffer( &m_frameData );
+    m_frameBuffer.open( QIODevice::ReadOnly );
+    m_frameReader.reset( new QImageReader( &m_frameBuffer, m_frameFormat ) );
+    m_nextFrame = 0;
+}
+
+bool KIMGIOGenerator::loadFrame( int frame )
+{
+    if ( frame == m_imgPage )
+        return true;
+
+    if ( m_frameData.isEmpty() )
+        return false;
+
+    if ( !m_frameReader )
+        rewindFrameReader();
+
+    if ( !m_frameReader->jumpToImage( frame ) ) {
+        // Formats like GIF can only be decoded sequentially, so go on from
+        // the last decoded frame, or start over when going backwards
+        if ( frame < m_nextFrame )
+            rewindFrameReader();
+
+        QImage skipped;
+        while ( m_nextFrame < frame ) {
+            if ( !m_frameReader->read( &skipped ) ) {
+                m_frameReader.reset();
+                return false;
+            }
+            ++m_nextFrame;
+        }
+    }
+
+    QImage img;
+    if ( !m_frameReader->read( &img ) && img.isNull() ) {
+        m_frameReader.reset();
+        return false;
+    }
+    m_nextFrame = frame + 1;
+
+    if ( m_exifOrientation != KExiv2Iface::KExiv2::ORIENTATION_UNSPECIFIED ) {
+        KExiv2Iface::KExiv2 exifMetadata;
+        exifMetadata.rotateExifQImage( img, static_cast<KExiv2Iface::KExiv2::ImageOrientation>( m_exifOrientation ) );
+    }
+
+    m_img = img;
+    m_imgPage = frame;
+    m_mipLevels.clear();
+
     return true;
 }
 
@@ -108,35 +207,89 @@ KIMGIOGenerator::SwapBackingFileResult KIMGIOGenerator::swapBackingFile( QString
 bool KIMGIOGenerator::doCloseDocument()
 {
     m_img = QImage();
+    m_imgPage = -1;
+    m_mipLevels.clear();
+
+    m_frameReader.reset();
+    m_frameBuffer.close();
+    m_frameData.clear();
+    m_frameFormat.clear();
+    m_nextFrame = 0;
+    m_exifOrientation = KExiv2Iface::KExiv2::ORIENTATION_UNSPECIFIED;
 
     return true;
 }
 
+QImage KIMGIOGenerator::mipLevel( int width, int height )
+{
+    QImage level = m_img;
+    for ( int i = 0; ; ++i )
+    {
+        const int nextWidth = level.width() / 2;
+        const int nextHeight = level.height() / 2;
+        if ( nextWidth < qMax( width, 1 ) || nextHeight < qMax( height, 1 ) )
+            return level;
+
+        if ( i == m_mipLevels.count() )
+            m_mipLevels.append( level.scaled( nextWidth, nextHeight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation ) );
+        level = m_mipLevels.at( i );
+    }
+}
+
 QImage KIMGIOGenerator::image( Okular::PixmapRequest * request )
 {
-    // perform a smooth scaled generation
+    int width = request->width();
+    int height = request->height();
+    if ( !request->isTile() && request->page()->rotation() % 2 == 1 )
+        qSwap( width, height );
+
+    // the decoded frame and its pyramid are shared by the tiles rendered in
+    // parallel: only take the level to sample from with the lock held, the
+    // scaling works on a shallow copy of it
+    QImage source;
+    {
+        QMutexLocker lock( userMutex() );
+        if ( request->shouldAbortRender() )
+            return QImage();
+
+        if ( !loadFrame( request->page()->number() ) )
+        {
+            QImage blank( request->width(), request->height(), QImage::Format_RGB32 );
+            blank.fill( Qt::white );
+            return blank;
+        }
+
+        // decoding a frame and building the pyramid are the expensive steps,
+        // don't go on scaling when the request got cancelled meanwhile; what
+        // they produced stays cached for the next request
+        if ( request->shouldAbortRender() )
+            return QImage();
+
+        // perform a smooth scaled generation, sampling from the smallest level
+        // of the pyramid that still has enough pixels
+        source = mipLevel( width, height );
+    }
+
+    if ( request->shouldAbortRender() )
+        return QImage();
+
     if ( request->isTile() )
     {
-        const QRect srcRect = request->normalizedRect().geometry( m_img.width(), m_img.height() );
-        const QRect destRect = request->normalizedRect().geometry( request->width(), request->height() );
+        const QRect srcRect = request->normalizedRect().geometry( source.width(), source.height() );
+        const QRect destRect = request->normalizedRect().geometry( width, height );
 
         QImage destImg( destRect.size(), QImage::Format_RGB32 );
         destImg.fill( Qt::white );
 
         QPainter p( &destImg );
         p.setRenderHint( QPainter::SmoothPixmapTransform );
-        p.drawImage( destImg.rect(), m_img, srcRect );
+        p.drawImage( destImg.rect(), source, srcRect );
 
         return destImg;
     }
     else
     {
-        int width = request->width();
-        int height = request->height();
-        if ( request->page()->rotation() % 2 == 1 )
-            qSwap( width, height );
-
-        return m_img.scaled( width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+        return source.scaled( width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
     }
 }
 
@@ -144,14 +297,29 @@ bool KIMGIOGenerator::print( QPrinter& printer )
 {
     QPainter p( &printer );
 
-    QImage image( m_img );
+    QMutexLocker lock( userMutex() );
 
-    if ( ( image.width() > printer.width() ) || ( image.height() > printer.height() ) )
+    const QList<int> pageList = Okular::FilePrinter::pageList( printer, document()->pages(),
+                                                               document()->currentPage() + 1,
+                                                               document()->bookmarkedPageList() );
 
-        image = image.scaled( printer.width(), printer.height(),
-                              Qt::KeepAspectRatio, Qt::SmoothTransformation );
+    for ( int i = 0; i < pageList.count(); ++i )
+    {
+        if ( !loadFrame( pageList[i] - 1 ) )
+            continue;
+
+        if ( i != 0 )
+            printer.newPage();
+
+        QImage image( m_img );
 
-    p.drawImage( 0, 0, image );
+        if ( ( image.width() > printer.width() ) || ( image.height() > printer.height() ) )
+
+            image = image.scaled( printer.width(), printer.height(),
+                                  Qt::KeepAspectRatio, Qt::SmoothTransformation );
+
+        p.drawImage( 0, 0, image );
+    }
 
     return true;
 }
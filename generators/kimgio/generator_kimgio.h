@@ -16,8 +16,12 @@
 #include <core/generator.h>
 #include <core/document.h>
 
+#include <QtCore/QBuffer>
+#include <QtCore/QScopedPointer>
 #include <QtGui/QImage>
 
+class QImageReader;
+
 class KIMGIOGenerator : public Okular::Generator
 {
     Q_OBJECT
@@ -45,8 +49,26 @@ class KIMGIOGenerator : public Okular::Generator
     private:
         bool loadDocumentInternal(const QByteArray & fileData, const QString & fileName,
                                   QVector<Okular::Page*> & pagesVector );
+        // makes m_img the decoded image of the given frame
+        bool loadFrame( int frame );
+        void rewindFrameReader();
+        // returns the smallest level of the mipmap pyramid of m_img that is
+        // at least width x height, building the missing levels on the way
+        QImage mipLevel( int width, int height );
+
     private:
+        // the decoded frame shown in page m_imgPage
         QImage m_img;
+        int m_imgPage;
+        // m_mipLevels[i] is m_img downscaled by 2^(i+1), built on demand
+        QVector<QImage> m_mipLevels;
+        // encoded data of multi-frame images, decoded one frame at a time
+        QByteArray m_frameData;
+        QByteArray m_frameFormat;
+        QBuffer m_frameBuffer;
+        QScopedPointer<QImageReader> m_frameReader;
+        int m_nextFrame;
+        int m_exifOrientation;
         Okular::DocumentInfo docInfo;
 };
 
@@ -20,6 +20,8 @@
 #include <QImage>
 #include <QPainter>
 #include <QImageReader>
+#include <QPrinter>
+#include <QRegularExpression>
 #include <QTemporaryFile>
 #include <KPluginLoader>
 
@@ -32,6 +34,8 @@ class KIMGIOTest
 		void initTestCase();
 		void testExifOrientation_data();
 		void testExifOrientation();
+		void testMipLevels();
+		void testMultiFrame();
 };
 
 void KIMGIOTest::initTestCase()
@@ -116,5 +120,121 @@ void KIMGIOTest::testExifOrientation()
 	delete m_document;
 }
 
+// A large image is rendered at a small size, which makes the generator sample
+// from its mipmap pyramid; the result must still match the source image.
+void KIMGIOTest::testMipLevels()
+{
+	QTemporaryFile tempFile( QDir::tempPath() + QStringLiteral("/okular_kimgiotest_XXXXXX.png") );
+	QVERIFY( tempFile.open() );
+	QImage source( 1024, 512, QImage::Format_RGB32 );
+	source.fill( Qt::white );
+	QPainter sourcePainter( &source );
+	sourcePainter.fillRect( 0, 0, 512, 512, Qt::black );
+	sourcePainter.end();
+	QVERIFY( source.save( &tempFile, "PNG" ) );
+	tempFile.close();
+
+	QMimeDatabase db;
+	Okular::SettingsCore::instance( QStringLiteral("kimgiotest") );
+	Okular::Document *m_document = new Okular::Document( nullptr );
+	const QMimeType mime = db.mimeTypeForFile( tempFile.fileName() );
+
+	Okular::DocumentObserver *dummyDocumentObserver = new Okular::DocumentObserver();
+	m_document->addObserver( dummyDocumentObserver );
+
+	QCOMPARE((int)m_document->openDocument( tempFile.fileName(), QUrl(), mime ), (int)Okular::Document::OpenSuccess);
+	m_document->setRotation( 0 );
+	QCOMPARE( m_document->page(0)->width(), double(1024) );
+	QCOMPARE( m_document->page(0)->height(), double(512) );
+
+	Okular::PixmapRequest *req = new Okular::PixmapRequest( dummyDocumentObserver, 0, 64, 32,
+		1, Okular::PixmapRequest::NoFeature );
+	m_document->requestPixmaps( QLinkedList<Okular::PixmapRequest*>() << req );
+	QVERIFY( m_document->page(0)->hasPixmap( dummyDocumentObserver, 64, 32 ) );
+
+	QImage img( 64, 32, QImage::Format_ARGB32_Premultiplied );
+	QPainter p( &img );
+	PagePainter::paintPageOnPainter( &p, m_document->page(0), dummyDocumentObserver, 0, 64, 32, QRect(0, 0, 64, 32) );
+
+	QCOMPARE( img.pixel(4, 16), qRgb(0, 0, 0) );
+	QCOMPARE( img.pixel(60, 16), qRgb(255, 255, 255) );
+
+	m_document->removeObserver( dummyDocumentObserver );
+	delete dummyDocumentObserver;
+	delete m_document;
+}
+
+// testMultiFrame.gif has three 8x6 frames: red, green and blue, each with a
+// white top-left pixel. Every frame is a page of its own.
+void KIMGIOTest::testMultiFrame()
+{
+	if ( !QImageReader::supportedImageFormats().contains( "gif" ) )
+		QSKIP( "GIF support is not available" );
+
+	const QString imgPath = QStringLiteral( KDESRCDIR "tests/data/testMultiFrame.gif" );
+	QMimeDatabase db;
+	Okular::SettingsCore::instance( QStringLiteral("kimgiotest") );
+	Okular::Document *m_document = new Okular::Document( nullptr );
+	const QMimeType mime = db.mimeTypeForFile( imgPath );
+
+	Okular::DocumentObserver *dummyDocumentObserver = new Okular::DocumentObserver();
+	m_document->addObserver( dummyDocumentObserver );
+
+	QCOMPARE((int)m_document->openDocument( imgPath, QUrl(), mime ), (int)Okular::Document::OpenSuccess);
+	m_document->setRotation( 0 );
+	QCOMPARE( m_document->pages(), 3u );
+
+	const QRgb colors[] = { qRgb(255, 0, 0), qRgb(0, 255, 0), qRgb(0, 0, 255) };
+
+	// backwards too, GIF frames can only be decoded from the first one on
+	const int order[] = { 0, 1, 2, 1, 0 };
+	for ( int page : order )
+	{
+		QCOMPARE( m_document->page(page)->width(), double(8) );
+		QCOMPARE( m_document->page(page)->height(), double(6) );
+
+		// drop the pixmap of the previous round
+		m_document->page(page)->deletePixmap( dummyDocumentObserver );
+		Okular::PixmapRequest *req = new Okular::PixmapRequest( dummyDocumentObserver, page, 8, 6,
+			1, Okular::PixmapRequest::NoFeature );
+		m_document->requestPixmaps( QLinkedList<Okular::PixmapRequest*>() << req );
+		QVERIFY( m_document->page(page)->hasPixmap( dummyDocumentObserver, 8, 6 ) );
+
+		QImage img( 8, 6, QImage::Format_ARGB32_Premultiplied );
+		QPainter p( &img );
+		PagePainter::paintPageOnPainter( &p, m_document->page(page), dummyDocumentObserver, 0, 8, 6, QRect(0, 0, 8, 6) );
+		p.end();
+
+		QCOMPARE( img.pixel(0, 0), qRgb(255, 255, 255) );
+		QCOMPARE( img.pixel(4, 3), colors[page] );
+		QCOMPARE( img.pixel(7, 5), colors[page] );
+	}
+
+	// every frame is printed on a page of its own
+	QTemporaryFile pdfFile( QDir::tempPath() + QStringLiteral("/okular_kimgiotest_XXXXXX.pdf") );
+	QVERIFY( pdfFile.open() );
+	pdfFile.close();
+	const QRegularExpression pageObject( QStringLiteral("/Type\\s*/Page[^s]") );
+
+	QPrinter printer;
+	printer.setOutputFormat( QPrinter::PdfFormat );
+	printer.setOutputFileName( pdfFile.fileName() );
+	QVERIFY( m_document->print( printer ) );
+	QVERIFY( pdfFile.open() );
+	QCOMPARE( QString::fromLatin1( pdfFile.readAll() ).count( pageObject ), 3 );
+	pdfFile.close();
+
+	printer.setPrintRange( QPrinter::PageRange );
+	printer.setFromTo( 2, 3 );
+	QVERIFY( m_document->print( printer ) );
+	QVERIFY( pdfFile.open() );
+	QCOMPARE( QString::fromLatin1( pdfFile.readAll() ).count( pageObject ), 2 );
+	pdfFile.close();
+
+	m_document->removeObserver( dummyDocumentObserver );
+	delete dummyDocumentObserver;
+	delete m_document;
+}
+
 QTEST_MAIN(KIMGIOTest)
 #include "kimgiotest.moc"
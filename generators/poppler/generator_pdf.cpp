@@ -23,11 +23,13 @@
 #include <qlayout.h>
 #include <qmutex.h>
 #include <qregexp.h>
+#include <qset.h>
 #include <qstack.h>
 #include <qtemporaryfile.h>
 #include <qtextstream.h>
 #include <QPrinter>
 #include <QPainter>
+#include <QElapsedTimer>
 #include <QTimer>
 #include <QtCore/QDebug>
 
@@ -70,6 +72,10 @@ Q_DECLARE_METATYPE(const Poppler::LinkOCGState*)
 static const int defaultPageWidth = 595;
 static const int defaultPageHeight = 842;
 
+// documents with more pages get only the size of the pages loaded when
+// opening, all the rest is filled in afterwards, except for the first pages
+static const int eagerlyLoadedPages = 50;
+
 class PDFOptionsPage : public QWidget
 {
     Q_OBJECT
@@ -543,7 +549,7 @@ PDFGenerator::PDFGenerator( QObject *parent, const QVariantList &args )
     : Generator( parent, args ), pdfdoc( 0 ),
     docSynopsisDirty( true ),
     docEmbeddedFilesDirty( true ), nextFontPage( 0 ),
-    annotProxy( 0 )
+    annotProxy( 0 ), pendingPagesCount( 0 ), pendingPagesCenter( -1 ), pendingPagesRadius( 0 )
 {
     setFeature( Threaded );
     setFeature( TextExtraction );
@@ -565,6 +571,8 @@ PDFGenerator::PDFGenerator( QObject *parent, const QVariantList &args )
     // You only need to do it once not for each of the documents but it is cheap enough
     // so doing it all the time won't hurt either
     Poppler::setDebugErrorFunction(PDFGeneratorPopplerDebugFunction, QVariant());
+
+    connect( &pendingPagesTimer, &QTimer::timeout, this, &PDFGenerator::loadNextPendingPages );
 }
 
 PDFGenerator::~PDFGenerator()
@@ -648,6 +656,12 @@ PDFGenerator::SwapBackingFileResult PDFGenerator::swapBackingFile( QString const
     if (openResult != Okular::Document::OpenSuccess)
         return SwapBackingFileError;
 
+    // the Document moves the annotations and forms of the new pages into its
+    // own pages and deletes the new ones, so none of them can be left for later
+    for ( int i = 0; i < newPagesVector.count(); ++i )
+        loadPendingPage( i );
+    pendingPages.clear();
+
     return SwapBackingFileReloadInternalData;
 }
 
@@ -667,6 +681,9 @@ bool PDFGenerator::doCloseDocument()
     docEmbeddedFiles.clear();
     nextFontPage = 0;
     rectsGenerated.clear();
+    pendingPagesTimer.stop();
+    pendingPages.clear();
+    pendingPagesCount = 0;
 
     return true;
 }
@@ -676,6 +693,14 @@ void PDFGenerator::loadPages(QVector<Okular::Page*> &pagesVector, int rotation,
     // TODO XPDF 3.01 check
     const int count = pagesVector.count();
     double w = 0, h = 0;
+
+    // the annotations and form fields of big documents take long to load,
+    // so most pages are filled in later, starting from the ones shown
+    const bool loadLazily = count > eagerlyLoadedPages;
+    pendingPages.fill( nullptr, count );
+    pendingPagesCount = 0;
+    pendingPagesCenter = -1;
+
     for ( int i = 0; i < count ; i++ )
     {
         // get xpdf page
@@ -696,25 +721,20 @@ void PDFGenerator::loadPages(QVector<Okular::Page*> &pagesVector, int rotation,
             }
             if (rotation % 2 == 1)
             qSwap(w,h);
-            // init a Okular::page, add transition and annotation information
+            // init a Okular::page, its contents come now or with the pending pages
             page = new Okular::Page( i, w, h, orientation );
-            addTransition( p, page );
-            if ( true ) //TODO real check
-            addAnnotations( p, page );
-            Poppler::Link * tmplink = p->action( Poppler::Page::Opening );
-            if ( tmplink )
+            page->setDuration( p->duration() );
+            page->setLabel( p->label() );
+
+            if ( loadLazily && i >= eagerlyLoadedPages )
             {
-                page->setPageAction( Okular::Page::Opening, createLinkFromPopplerLink( tmplink ) );
+                pendingPages[i] = page;
+                ++pendingPagesCount;
             }
-            tmplink = p->action( Poppler::Page::Closing );
-            if ( tmplink )
+            else
             {
-                page->setPageAction( Okular::Page::Closing, createLinkFromPopplerLink( tmplink ) );
+                addPageContents( p, page );
             }
-            page->setDuration( p->duration() );
-            page->setLabel( p->label() );
-
-            addFormFields( p, page );
 //        kWarning(PDFDebug).nospace() << page->width() << "x" << page->height();
 
 #ifdef PDFGENERATOR_DEBUG
@@ -732,6 +752,110 @@ void PDFGenerator::loadPages(QVector<Okular::Page*> &pagesVector, int rotation,
         // set the Okular::page at the right position in document's pages vector
         pagesVector[i] = page;
     }
+
+    // the pending pages are loaded in the background once the document is shown
+    if ( pendingPagesCount > 0 )
+        pendingPagesTimer.start( 0 );
+}
+
+void PDFGenerator::addPageContents( Poppler::Page * p, Okular::Page * page )
+{
+    addTransition( p, page );
+    if ( true ) //TODO real check
+    addAnnotations( p, page );
+    Poppler::Link * tmplink = p->action( Poppler::Page::Opening );
+    if ( tmplink )
+    {
+        page->setPageAction( Okular::Page::Opening, createLinkFromPopplerLink( tmplink ) );
+    }
+    tmplink = p->action( Poppler::Page::Closing );
+    if ( tmplink )
+    {
+        page->setPageAction( Okular::Page::Closing, createLinkFromPopplerLink( tmplink ) );
+    }
+
+    addFormFields( p, page );
+}
+
+bool PDFGenerator::loadPendingPage( int pageNumber )
+{
+    Okular::Page *page = pendingPages.value( pageNumber );
+    if ( !page )
+        return false;
+
+    pendingPages[ pageNumber ] = nullptr;
+    if ( --pendingPagesCount == 0 )
+        pendingPagesTimer.stop();
+
+    // the rendering and text threads may be using the document
+    userMutex()->lock();
+    Poppler::Page *p = pdfdoc->page( pageNumber );
+    if ( p )
+        addPageContents( p, page );
+    userMutex()->unlock();
+    delete p;
+
+    return true;
+}
+
+int PDFGenerator::nextPendingPage()
+{
+    const Okular::Document *doc = document();
+    if ( pendingPagesCount == 0 || !doc )
+        return -1;
+
+    // the visible pages first
+    foreach ( const Okular::VisiblePageRect *rect, doc->visiblePageRects() )
+    {
+        if ( pendingPages.value( rect->pageNumber ) )
+            return rect->pageNumber;
+    }
+
+    // then the closest ones to the current page; the pages nearer than
+    // pendingPagesRadius have been loaded already
+    const int center = doc->currentPage();
+    if ( center != pendingPagesCenter )
+    {
+        pendingPagesCenter = center;
+        pendingPagesRadius = 0;
+    }
+    const int count = pendingPages.count();
+    for ( ; pendingPagesRadius < count; ++pendingPagesRadius )
+    {
+        if ( pendingPages.value( center + pendingPagesRadius ) )
+            return center + pendingPagesRadius;
+        if ( pendingPages.value( center - pendingPagesRadius ) )
+            return center - pendingPagesRadius;
+    }
+    return -1;
+}
+
+void PDFGenerator::loadNextPendingPages()
+{
+    // a few pages at a time, not to block the user interface
+    QElapsedTimer timer;
+    timer.start();
+    while ( timer.elapsed() < 20 )
+    {
+        const int pageNumber = nextPendingPage();
+        if ( pageNumber < 0 )
+        {
+            pendingPagesTimer.stop();
+            return;
+        }
+        loadPendingPage( pageNumber );
+        signalPageContentsLoaded( pageNumber );
+    }
+}
+
+void PDFGenerator::generatePixmap( Okular::PixmapRequest *request )
+{
+    // a page about to be shown can't wait for its turn
+    const int pageNumber = request->pageNumber();
+    if ( loadPendingPage( pageNumber ) )
+        QTimer::singleShot( 0, this, [this, pageNumber] { signalPageContentsLoaded( pageNumber ); } );
+
+    Generator::generatePixmap( request );
 }
 
 Okular::DocumentInfo PDFGenerator::generateDocumentInfo( const QSet<Okular::DocumentInfo::Key> &keys ) const
@@ -1710,8 +1834,20 @@ void PDFGenerator::addAnnotations( Poppler::Page * popplerPage, Okular::Page * p
     QList<Poppler::Annotation*> popplerAnnotations = popplerPage->annotations();
 #endif
 
+    // the local annotations of a page loaded lazily were restored from the
+    // docdata before, they are in the poppler page already
+    QSet<QString> boundAnnotations;
+    foreach(const Okular::Annotation *annotation, page->annotations())
+        boundAnnotations.insert( annotation->uniqueName() );
+
     foreach(Poppler::Annotation *a, popplerAnnotations)
     {
+        if ( !a->uniqueName().isEmpty() && boundAnnotations.contains( a->uniqueName() ) )
+        {
+            delete a;
+            continue;
+        }
+
         bool doDelete = true;
         Okular::Annotation * newann = createAnnotationFromPopplerAnnotation( a, &doDelete );
         if (newann)
@@ -21,6 +21,7 @@
 
 #include <qbitarray.h>
 #include <qpointer.h>
+#include <qtimer.h>
 
 #include <core/document.h>
 #include <core/generator.h>
@@ -105,11 +106,15 @@ class PDFGenerator : public Okular::Generator, public Okular::ConfigInterface, p
         SwapBackingFileResult swapBackingFile( QString const &newFileName, QVector<Okular::Page*> & newPagesVector ) override;
         bool doCloseDocument() override;
         Okular::TextPage* textPage( Okular::TextRequest *request ) override;
+        void generatePixmap( Okular::PixmapRequest *request ) override;
 
     protected Q_SLOTS:
         void requestFontData(const Okular::FontInfo &font, QByteArray *data);
         Okular::Generator::PrintError printError() const;
 
+    private Q_SLOTS:
+        void loadNextPendingPages();
+
     private:
         Okular::Document::OpenResult init(QVector<Okular::Page*> & pagesVector, const QString &password);
 
@@ -121,6 +126,12 @@ class PDFGenerator : public Okular::Generator, public Okular::ConfigInterface, p
         void addTransition( Poppler::Page * popplerPage, Okular::Page * page );
         // fetch the form fields and add them to the page
         void addFormFields( Poppler::Page * popplerPage, Okular::Page * page );
+        // fetch everything of the page but its size and label
+        void addPageContents( Poppler::Page * popplerPage, Okular::Page * page );
+        // fill in a page left out by loadPages(), returns whether it was pending
+        bool loadPendingPage( int pageNumber );
+        // the pending page to load next, -1 if there are none left
+        int nextPendingPage();
 
         Okular::TextPage * abstractTextPage(const QList<Poppler::TextBox*> &text, double height, double width, int rot);
 
@@ -146,6 +157,13 @@ class PDFGenerator : public Okular::Generator, public Okular::ConfigInterface, p
 
         QBitArray rectsGenerated;
 
+        // pages of big documents whose contents are loaded after opening
+        QVector<Okular::Page*> pendingPages;
+        int pendingPagesCount;
+        int pendingPagesCenter;
+        int pendingPagesRadius;
+        QTimer pendingPagesTimer;
+
         QPointer<PDFOptionsPage> pdfOptionsPage;
         
         PrintError lastPrintError;
@@ -10,18 +10,22 @@
 #include "generator_tiff.h"
 
 #include <qbuffer.h>
+#include <qcache.h>
 #include <qdatetime.h>
 #include <qfile.h>
 #include <qfileinfo.h>
 #include <qimage.h>
 #include <qlist.h>
 #include <qpainter.h>
+#include <qpair.h>
+#include <qvector.h>
 #include <QtPrintSupport/QPrinter>
 
 #include <kaboutdata.h>
 #include <QtCore/QDebug>
 #include <KLocalizedString>
 
+#include <core/area.h>
 #include <core/document.h>
 #include <core/page.h>
 #include <core/fileprinter.h>
@@ -30,6 +34,8 @@
 #include <tiff.h>
 #include <tiffio.h>
 
+#include <algorithm>
+
 #define TiffDebug 4714
 
 tsize_t okular_tiffReadProc( thandle_t handle, tdata_t buf, tsize_t size )
@@ -85,15 +91,36 @@ void okular_tiffUnmapProc( thandle_t, tdata_t, toff_t )
 }
 
 
+// upper bound (in KiB) for the decoded directories kept around between requests
+static const int DecodedCacheSize = 128 * 1024;
+
 class TIFFGenerator::Private
 {
     public:
         Private()
-          : tiff( nullptr ), dev( nullptr ) {}
+          : tiff( nullptr ), dev( nullptr ), decodedCache( DecodedCacheSize ) {}
+
+        /**
+         * A reduced-resolution version of a page, stored as a SubIFD.
+         */
+        struct ReducedImage
+        {
+            toff_t offset;
+            uint32 width;
+            uint32 height;
+        };
+
+        QImage decodedImage( int page, tdir_t dir, int level, const QSize &targetSize = QSize() );
+        QImage imageForSize( int page, tdir_t dir, const QSize &size );
+        QImage tileImage( int page, tdir_t dir, const QSize &pageSize, const Okular::NormalizedRect &rect );
 
         TIFF* tiff;
         QByteArray data;
         QIODevice* dev;
+        // reduced-resolution SubIFDs of each page, sorted by decreasing size
+        QHash< int, QVector< ReducedImage > > reducedImages;
+        // decoded images keyed by (page, level); level -1 is the full resolution one
+        QCache< QPair< int, int >, QImage > decodedCache;
 };
 
 static QDateTime convertTIFFDateTime( const char* tiffdate )
@@ -157,6 +184,263 @@ static Okular::Rotation readTiffRotation( TIFF *tiff )
     return ret;
 }
 
+static bool isGrayscale( TIFF *tiff )
+{
+    uint16 samples = 0;
+    uint16 photometric = 0;
+    if ( !TIFFGetFieldDefaulted( tiff, TIFFTAG_SAMPLESPERPIXEL, &samples )
+         || !TIFFGetField( tiff, TIFFTAG_PHOTOMETRIC, &photometric ) )
+        return false;
+
+    return samples == 1 && ( photometric == PHOTOMETRIC_MINISWHITE || photometric == PHOTOMETRIC_MINISBLACK );
+}
+
+/**
+ * Reads the rows of a directory stored as a single strip one scanline at a
+ * time, as TIFFRGBAImageGet would decode the whole strip at once.
+ * Only bilevel, 8 bit grayscale and 8 bit RGB directories are supported,
+ * begin() returns false for the others.
+ */
+class ScanlineReader
+{
+    public:
+        explicit ScanlineReader( TIFF *tiff )
+          : m_tiff( tiff ), m_bits( 0 ), m_samples( 0 ), m_photometric( 0 ), m_nextRow( 0 ) {}
+
+        bool begin()
+        {
+            uint32 height = 0;
+            uint32 rowsPerStrip = 0;
+            uint16 planar = PLANARCONFIG_CONTIG;
+            if ( TIFFIsTiled( m_tiff ) || !TIFFGetField( m_tiff, TIFFTAG_IMAGELENGTH, &height )
+                 || !TIFFGetField( m_tiff, TIFFTAG_PHOTOMETRIC, &m_photometric ) )
+                return false;
+
+            TIFFGetFieldDefaulted( m_tiff, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip );
+            TIFFGetFieldDefaulted( m_tiff, TIFFTAG_BITSPERSAMPLE, &m_bits );
+            TIFFGetFieldDefaulted( m_tiff, TIFFTAG_SAMPLESPERPIXEL, &m_samples );
+            TIFFGetFieldDefaulted( m_tiff, TIFFTAG_PLANARCONFIG, &planar );
+            if ( rowsPerStrip < height || planar != PLANARCONFIG_CONTIG )
+                return false;
+
+            const bool gray = ( m_photometric == PHOTOMETRIC_MINISBLACK || m_photometric == PHOTOMETRIC_MINISWHITE )
+                              && m_samples == 1 && ( m_bits == 1 || m_bits == 8 );
+            const bool rgb = m_photometric == PHOTOMETRIC_RGB && m_samples == 3 && m_bits == 8;
+            if ( !gray && !rgb )
+                return false;
+
+            m_line.resize( TIFFScanlineSize( m_tiff ) );
+            return true;
+        }
+
+        // fills @p raster like TIFFRGBAImageGet does, with @p rows rows of
+        // @p width pixels starting at @p col
+        bool read( uint32 row, uint32 rows, uint32 col, uint32 width, uint32 *raster )
+        {
+            // the codecs can only decode forward, skipped rows are read too
+            if ( row < m_nextRow )
+                m_nextRow = 0;
+            for ( ; m_nextRow < row + rows; ++m_nextRow )
+            {
+                if ( TIFFReadScanline( m_tiff, m_line.data(), m_nextRow, 0 ) < 0 )
+                    return false;
+                if ( m_nextRow < row )
+                    continue;
+
+                const uchar *line = m_line.constData();
+                uint32 *dest = raster + ( m_nextRow - row ) * width;
+                for ( uint32 x = 0; x < width; ++x )
+                {
+                    const uint32 sx = col + x;
+                    if ( m_photometric == PHOTOMETRIC_RGB )
+                    {
+                        const uchar *pixel = line + 3 * sx;
+                        dest[ x ] = 0xff000000 | ( pixel[ 2 ] << 16 ) | ( pixel[ 1 ] << 8 ) | pixel[ 0 ];
+                        continue;
+                    }
+
+                    uint32 value = m_bits == 8 ? line[ sx ] : ( ( line[ sx >> 3 ] << ( sx & 7 ) ) & 0x80 ? 255 : 0 );
+                    if ( m_photometric == PHOTOMETRIC_MINISWHITE )
+                        value = 255 - value;
+                    dest[ x ] = 0xff000000 | ( value << 16 ) | ( value << 8 ) | value;
+                }
+            }
+            return true;
+        }
+
+    private:
+        TIFF *m_tiff;
+        uint16 m_bits;
+        uint16 m_samples;
+        uint16 m_photometric;
+        uint32 m_nextRow;
+        QVector< uchar > m_line;
+};
+
+/**
+ * Decodes the @p sourceRect region (the whole image if invalid) of the
+ * current directory of @p tiff into an image of @p targetSize, which must
+ * not be larger than the region.
+ *
+ * The raster is read in bands of whole strips (or tiles) covering the
+ * region only, or scanline by scanline for single strip directories, so
+ * the full resolution image is never held in memory when the target is
+ * smaller: each band is box-filtered straight into the result.
+ * Bilevel and grayscale directories are decoded as Format_Grayscale8.
+ */
+static QImage decodeTiffDirectory( TIFF *tiff, const QSize &targetSize, const QRect &sourceRect = QRect() )
+{
+    uint32 width = 1;
+    uint32 height = 1;
+    uint32 orientation = 0;
+    TIFFGetField( tiff, TIFFTAG_IMAGEWIDTH, &width );
+    TIFFGetField( tiff, TIFFTAG_IMAGELENGTH, &height );
+
+    if ( !TIFFGetField( tiff, TIFFTAG_ORIENTATION, &orientation ) )
+        orientation = ORIENTATION_TOPLEFT;
+
+    const QRect imageRect( 0, 0, width, height );
+    const QRect region = sourceRect.isValid() ? sourceRect & imageRect : imageRect;
+    if ( region.isEmpty() )
+        return QImage();
+
+    ScanlineReader scanlines( tiff );
+    const bool useScanlines = scanlines.begin();
+
+    char emsg[1024];
+    TIFFRGBAImage rgba;
+    if ( !useScanlines && ( !TIFFRGBAImageOK( tiff, emsg ) || !TIFFRGBAImageBegin( &rgba, tiff, 0, emsg ) ) )
+    {
+        qCWarning(OkularTiffDebug) << "Cannot decode TIFF directory:" << emsg;
+        return QImage();
+    }
+    // asking for the orientation of the file means no flipping, so the
+    // bands can be read one after the other
+    if ( !useScanlines )
+        rgba.req_orientation = orientation;
+
+    const uint32 regionWidth = region.width();
+    const uint32 regionHeight = region.height();
+    const QSize size = targetSize.isValid() ? targetSize : region.size();
+    const bool gray = isGrayscale( tiff );
+    QImage image( size, gray ? QImage::Format_Grayscale8 : QImage::Format_RGB32 );
+    if ( image.isNull() )
+    {
+        if ( !useScanlines )
+            TIFFRGBAImageEnd( &rgba );
+        return QImage();
+    }
+
+    uint32 rowsPerBlock = 0;
+    if ( useScanlines )
+        rowsPerBlock = 1;
+    else if ( TIFFIsTiled( tiff ) )
+        TIFFGetField( tiff, TIFFTAG_TILELENGTH, &rowsPerBlock );
+    else
+        TIFFGetFieldDefaulted( tiff, TIFFTAG_ROWSPERSTRIP, &rowsPerBlock );
+    rowsPerBlock = qBound( (uint32)1, rowsPerBlock, regionHeight );
+    const uint32 bandHeight = qMin( regionHeight, qMax( rowsPerBlock, ( 64 / rowsPerBlock ) * rowsPerBlock ) );
+
+    const bool scaled = size != region.size();
+    const int destWidth = size.width();
+    const int destHeight = size.height();
+    // box filter state: the destination column of every source column, and
+    // the per-channel sums of the destination row being accumulated
+    QVector< int > destColumn;
+    QVector< quint64 > sums;
+    QVector< quint32 > counts;
+    int currentDestRow = 0;
+    if ( scaled )
+    {
+        destColumn.resize( regionWidth );
+        for ( uint32 x = 0; x < regionWidth; ++x )
+            destColumn[ x ] = (int)( (quint64)x * destWidth / regionWidth );
+        sums.fill( 0, destWidth * 3 );
+        counts.fill( 0, destWidth );
+    }
+
+    const auto flushRow = [&]( int destRow ) {
+        uchar *line = image.scanLine( destRow );
+        for ( int x = 0; x < destWidth; ++x )
+        {
+            const quint32 n = qMax( counts[ x ], (quint32)1 );
+            if ( gray )
+                line[ x ] = (uchar)( sums[ 3 * x ] / n );
+            else
+                reinterpret_cast< QRgb * >( line )[ x ] = qRgb( (int)( sums[ 3 * x ] / n ), (int)( sums[ 3 * x + 1 ] / n ), (int)( sums[ 3 * x + 2 ] / n ) );
+        }
+        sums.fill( 0 );
+        counts.fill( 0 );
+    };
+
+    QVector< uint32 > band( regionWidth * bandHeight );
+    bool ok = true;
+    for ( uint32 y = 0; ok && y < regionHeight; y += bandHeight )
+    {
+        const uint32 rows = qMin( bandHeight, regionHeight - y );
+        if ( useScanlines )
+        {
+            ok = scanlines.read( region.top() + y, rows, region.left(), regionWidth, band.data() );
+        }
+        else
+        {
+            rgba.row_offset = region.top() + y;
+            rgba.col_offset = region.left();
+            ok = TIFFRGBAImageGet( &rgba, band.data(), regionWidth, rows );
+        }
+        if ( !ok )
+            break;
+
+        for ( uint32 i = 0; i < rows; ++i )
+        {
+            // an image read by TIFFRGBAImageGet is ABGR, we need ARGB
+            const uint32 *src = band.constData() + i * regionWidth;
+            if ( !scaled )
+            {
+                uchar *line = image.scanLine( y + i );
+                for ( uint32 x = 0; x < regionWidth; ++x )
+                {
+                    if ( gray )
+                        line[ x ] = TIFFGetR( src[ x ] );
+                    else
+                        reinterpret_cast< QRgb * >( line )[ x ] = qRgb( TIFFGetR( src[ x ] ), TIFFGetG( src[ x ] ), TIFFGetB( src[ x ] ) );
+                }
+                continue;
+            }
+
+            const int destRow = (int)( (quint64)( y + i ) * destHeight / regionHeight );
+            if ( destRow != currentDestRow )
+            {
+                flushRow( currentDestRow );
+                currentDestRow = destRow;
+            }
+            for ( uint32 x = 0; x < regionWidth; ++x )
+            {
+                const int dx = destColumn[ x ];
+                sums[ 3 * dx ] += TIFFGetR( src[ x ] );
+                sums[ 3 * dx + 1 ] += TIFFGetG( src[ x ] );
+                sums[ 3 * dx + 2 ] += TIFFGetB( src[ x ] );
+                ++counts[ dx ];
+            }
+        }
+    }
+    if ( ok && scaled )
+        flushRow( currentDestRow );
+
+    if ( !useScanlines )
+        TIFFRGBAImageEnd( &rgba );
+
+    return ok ? image : QImage();
+}
+
+static QImage toRGB32( const QImage &image, const QSize &size )
+{
+    if ( image.size() == size )
+        return image.convertToFormat( QImage::Format_RGB32 );
+
+    return image.scaled( size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation ).convertToFormat( QImage::Format_RGB32 );
+}
+
 OKULAR_EXPORT_PLUGIN(TIFFGenerator, "libokularGenerator_tiff.json")
 
 TIFFGenerator::TIFFGenerator( QObject *parent, const QVariantList &args )
@@ -164,6 +448,7 @@ TIFFGenerator::TIFFGenerator( QObject *parent, const QVariantList &args )
       d( new Private )
 {
     setFeature( Threaded );
+    setFeature( TiledRendering );
     setFeature( PrintNative );
     setFeature( PrintToFile );
     setFeature( ReadRawData );
@@ -227,57 +512,146 @@ bool TIFFGenerator::doCloseDocument()
         delete d->dev;
         d->dev = nullptr;
         d->data.clear();
+        d->reducedImages.clear();
+        d->decodedCache.clear();
         m_pageMapping.clear();
     }
 
     return true;
 }
 
-QImage TIFFGenerator::image( Okular::PixmapRequest * request )
+QImage TIFFGenerator::Private::decodedImage( int page, tdir_t dir, int level, const QSize &targetSize )
 {
-    bool generated = false;
-    QImage img;
+    const QPair< int, int > key( page, level );
+    const bool cacheable = !targetSize.isValid();
+    if ( cacheable )
+    {
+        if ( QImage *cached = decodedCache.object( key ) )
+            return *cached;
+    }
+
+    if ( !TIFFSetDirectory( tiff, dir ) )
+        return QImage();
+    if ( level >= 0 && !TIFFSetSubDirectory( tiff, reducedImages.value( page ).at( level ).offset ) )
+        return QImage();
+
+    const QImage image = decodeTiffDirectory( tiff, targetSize );
+    if ( cacheable && !image.isNull() )
+        decodedCache.insert( key, new QImage( image ), qMax( image.byteCount() / 1024, 1 ) );
+
+    return image;
+}
+
+QImage TIFFGenerator::Private::imageForSize( int page, tdir_t dir, const QSize &size )
+{
+    // the full resolution image is already decoded, just sample from it
+    if ( QImage *cached = decodedCache.object( qMakePair( page, -1 ) ) )
+        return *cached;
 
-    if ( TIFFSetDirectory( d->tiff, mapPage( request->page()->number() ) ) )
+    // use the smallest reduced-resolution SubIFD that is still big enough
+    const QVector< ReducedImage > levels = reducedImages.value( page );
+    for ( int level = levels.count() - 1; level >= 0; --level )
     {
-        int rotation = request->page()->rotation();
-        uint32 width = 1;
-        uint32 height = 1;
-        uint32 orientation = 0;
-        TIFFGetField( d->tiff, TIFFTAG_IMAGEWIDTH, &width );
-        TIFFGetField( d->tiff, TIFFTAG_IMAGELENGTH, &height );
+        const ReducedImage &reduced = levels.at( level );
+        if ( (int)reduced.width >= size.width() && (int)reduced.height >= size.height() )
+            return decodedImage( page, dir, level );
+    }
 
-        if ( !TIFFGetField( d->tiff, TIFFTAG_ORIENTATION, &orientation ) )
-            orientation = ORIENTATION_TOPLEFT;
+    uint32 width = 1;
+    uint32 height = 1;
+    if ( !TIFFSetDirectory( tiff, dir ) )
+        return QImage();
+    TIFFGetField( tiff, TIFFTAG_IMAGEWIDTH, &width );
+    TIFFGetField( tiff, TIFFTAG_IMAGELENGTH, &height );
 
-        QImage image( width, height, QImage::Format_RGB32 );
-        uint32 * data = (uint32 *)image.bits();
+    // much smaller than the page (e.g. thumbnails): decode downsampled
+    if ( size.width() * 2 <= (int)width && size.height() * 2 <= (int)height )
+        return decodedImage( page, dir, -1, size );
 
-        // read data
-        if ( TIFFReadRGBAImageOriented( d->tiff, width, height, data, orientation ) != 0 )
-        {
-            // an image read by ReadRGBAImage is ABGR, we need ARGB, so swap red and blue
-            uint32 size = width * height;
-            for ( uint32 i = 0; i < size; ++i )
-            {
-                uint32 red = ( data[i] & 0x00FF0000 ) >> 16;
-                uint32 blue = ( data[i] & 0x000000FF ) << 16;
-                data[i] = ( data[i] & 0xFF00FF00 ) + red + blue;
-            }
+    return decodedImage( page, dir, -1 );
+}
+
+// paints the @p rect part of @p source, scaled to @p size
+static QImage sampleTile( const QImage &source, const Okular::NormalizedRect &rect, const QSize &size )
+{
+    const QRect srcRect = rect.geometry( source.width(), source.height() );
+
+    QImage img( size, QImage::Format_RGB32 );
+    img.fill( Qt::white );
 
-            int reqwidth = request->width();
-            int reqheight = request->height();
-            if ( rotation % 2 == 1 )
-                qSwap( reqwidth, reqheight );
-            img = image.scaled( reqwidth, reqheight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+    QPainter p( &img );
+    p.setRenderHint( QPainter::SmoothPixmapTransform );
+    p.drawImage( img.rect(), source, srcRect );
 
-            generated = true;
+    return img;
+}
+
+QImage TIFFGenerator::Private::tileImage( int page, tdir_t dir, const QSize &pageSize, const Okular::NormalizedRect &rect )
+{
+    const QSize size = rect.geometry( pageSize.width(), pageSize.height() ).size();
+
+    // the full resolution image is already decoded, just sample from it
+    if ( QImage *cached = decodedCache.object( qMakePair( page, -1 ) ) )
+        return sampleTile( *cached, rect, size );
+
+    // the smallest reduced-resolution SubIFD with enough pixels for the
+    // whole page at this zoom, decoded once for all its tiles
+    const QVector< ReducedImage > levels = reducedImages.value( page );
+    for ( int level = levels.count() - 1; level >= 0; --level )
+    {
+        const ReducedImage &reduced = levels.at( level );
+        if ( (int)reduced.width >= pageSize.width() && (int)reduced.height >= pageSize.height() )
+        {
+            const QImage source = decodedImage( page, dir, level );
+            return source.isNull() ? QImage() : sampleTile( source, rect, size );
         }
     }
 
-    if ( !generated )
+    // otherwise only decode the strips or tiles of the page under the tile
+    uint32 width = 1;
+    uint32 height = 1;
+    if ( !TIFFSetDirectory( tiff, dir ) )
+        return QImage();
+    TIFFGetField( tiff, TIFFTAG_IMAGEWIDTH, &width );
+    TIFFGetField( tiff, TIFFTAG_IMAGELENGTH, &height );
+
+    const QRect srcRect = rect.geometry( width, height );
+    const bool downscaled = size.width() <= srcRect.width() && size.height() <= srcRect.height();
+    const QImage source = decodeTiffDirectory( tiff, downscaled ? size : QSize(), srcRect );
+    if ( source.isNull() )
+        return QImage();
+
+    return toRGB32( source, size );
+}
+
+QImage TIFFGenerator::image( Okular::PixmapRequest * request )
+{
+    const int page = request->page()->number();
+    const int dir = mapPage( page );
+    QImage img;
+    QSize size( request->width(), request->height() );
+
+    if ( request->isTile() )
+    {
+        size = request->normalizedRect().geometry( request->width(), request->height() ).size();
+
+        if ( dir >= 0 )
+            img = d->tileImage( page, dir, QSize( request->width(), request->height() ), request->normalizedRect() );
+    }
+    else
+    {
+        QSize reqSize = size;
+        if ( request->page()->rotation() % 2 == 1 )
+            reqSize.transpose();
+
+        const QImage source = dir >= 0 ? d->imageForSize( page, dir, reqSize ) : QImage();
+        if ( !source.isNull() )
+            img = toRGB32( source, reqSize );
+    }
+
+    if ( img.isNull() )
     {
-        img = QImage( request->width(), request->height(), QImage::Format_RGB32 );
+        img = QImage( size, QImage::Format_RGB32 );
         img.fill( qRgb( 255, 255, 255 ) );
     }
 
@@ -362,6 +736,8 @@ void TIFFGenerator::loadPages( QVector<Okular::Page*> & pagesVector )
 
         m_pageMapping[ realdirs ] = i;
 
+        loadReducedImages( realdirs );
+
         ++realdirs;
     }
 
@@ -422,6 +798,50 @@ bool TIFFGenerator::print( QPrinter& printer )
     return true;
 }
 
+void TIFFGenerator::loadReducedImages( int page )
+{
+    uint16 count = 0;
+    toff_t *offsets = nullptr;
+    if ( !TIFFGetField( d->tiff, TIFFTAG_SUBIFD, &count, &offsets ) || count == 0 )
+        return;
+
+    // the offsets array belongs to the current directory, so copy it first
+    QVector< toff_t > subIfds( count );
+    std::copy( offsets, offsets + count, subIfds.begin() );
+    const tdir_t dir = TIFFCurrentDirectory( d->tiff );
+
+    uint32 width = 0;
+    uint32 height = 0;
+    TIFFGetField( d->tiff, TIFFTAG_IMAGEWIDTH, &width );
+    TIFFGetField( d->tiff, TIFFTAG_IMAGELENGTH, &height );
+
+    QVector< Private::ReducedImage > levels;
+    for ( const toff_t offset : subIfds )
+    {
+        if ( !TIFFSetSubDirectory( d->tiff, offset ) )
+            continue;
+
+        uint32 subFileType = 0;
+        Private::ReducedImage reduced = { offset, 0, 0 };
+        if ( !TIFFGetField( d->tiff, TIFFTAG_SUBFILETYPE, &subFileType ) || !( subFileType & FILETYPE_REDUCEDIMAGE ) ||
+             TIFFGetField( d->tiff, TIFFTAG_IMAGEWIDTH, &reduced.width ) != 1 ||
+             TIFFGetField( d->tiff, TIFFTAG_IMAGELENGTH, &reduced.height ) != 1 )
+            continue;
+
+        if ( reduced.width < width && reduced.height < height )
+            levels.append( reduced );
+    }
+
+    std::sort( levels.begin(), levels.end(), []( const Private::ReducedImage &a, const Private::ReducedImage &b ) {
+        return a.width > b.width;
+    } );
+    if ( !levels.isEmpty() )
+        d->reducedImages.insert( page, levels );
+
+    // go back to the main image of the page
+    TIFFSetDirectory( d->tiff, dir );
+}
+
 int TIFFGenerator::mapPage( int page ) const
 {
     QHash< int, int >::const_iterator it = m_pageMapping.find( page );
@@ -40,6 +40,7 @@ class TIFFGenerator : public Okular::Generator
 
         bool loadTiff( QVector< Okular::Page * > & pagesVector, const char *name );
         void loadPages( QVector<Okular::Page*> & pagesVector );
+        void loadReducedImages( int page );
         int mapPage( int page ) const;
 
         QHash< int, int > m_pageMapping;
@@ -726,6 +726,7 @@ static QString unicodeString( const QString &raw )
 XpsHandler::XpsHandler(XpsPage *page): m_page(page)
 {
     m_painter = nullptr;
+    m_request = nullptr;
 }
 
 XpsHandler::~XpsHandler()
@@ -751,6 +752,10 @@ bool XpsHandler::startElement( const QString &nameSpace,
     Q_UNUSED( nameSpace )
     Q_UNUSED( qname )
 
+    // returning false stops the parser
+    if ( m_request && m_request->shouldAbortRender() )
+        return false;
+
     XpsRenderNode node;
     node.name = localName;
     node.attributes = atts;
@@ -1380,14 +1385,17 @@ void XpsHandler::processEndElement( XpsRenderNode &node )
     }
 }
 
-XpsPage::XpsPage(XpsFile *file, const QString &fileName): m_file( file ),
-    m_fileName( fileName ), m_pageIsRendered(false)
+XpsPage::XpsPage(XpsFile *file, const QString &fileName, const QSizeF &sizeHint): m_file( file ),
+    m_fileName( fileName ), m_pageSize( sizeHint ), m_pageSizeLoaded( sizeHint.isValid() && !sizeHint.isEmpty() )
 {
-    m_pageImage = nullptr;
-
     // qCWarning(OkularXpsDebug) << "page file name: " << fileName;
+}
 
-    const KZipFileEntry* pageFile = static_cast<const KZipFileEntry *>(m_file->xpsArchive()->directory()->entry( fileName ));
+void XpsPage::loadPageSize() const
+{
+    m_pageSizeLoaded = true;
+
+    const KZipFileEntry* pageFile = static_cast<const KZipFileEntry *>(m_file->xpsArchive()->directory()->entry( m_fileName ));
 
     QXmlStreamReader xml;
     xml.addData( readFileOrDirectoryParts( pageFile ) );
@@ -1410,37 +1418,28 @@ XpsPage::XpsPage(XpsFile *file, const QString &fileName): m_file( file ),
 
 XpsPage::~XpsPage()
 {
-    delete m_pageImage;
 }
 
-bool XpsPage::renderToImage( QImage *p )
+bool XpsPage::renderToImage( QImage *p, Okular::PixmapRequest *request )
 {
+    // Render straight into the requested image: the Document already caches
+    // (and evicts) the resulting pixmap, so keeping a copy here would only
+    // grow the memory usage with every visited page.
 
-    if ((m_pageImage == nullptr) || (m_pageImage->size() != p->size())) {
-        delete m_pageImage;
-        m_pageImage = new QImage( p->size(), QImage::Format_ARGB32 );
-        // Set one point = one drawing unit. Useful for fonts, because xps specifies font size using drawing units, not points as usual
-        m_pageImage->setDotsPerMeterX( 2835 );
-        m_pageImage->setDotsPerMeterY( 2835 );
-
-        m_pageIsRendered = false;
-    }
-    if (! m_pageIsRendered) {
-        m_pageImage->fill( qRgba( 255, 255, 255, 255 ) );
-        QPainter painter( m_pageImage );
-        renderToPainter( &painter );
-        m_pageIsRendered = true;
-    }
+    // Set one point = one drawing unit. Useful for fonts, because xps specifies font size using drawing units, not points as usual
+    p->setDotsPerMeterX( 2835 );
+    p->setDotsPerMeterY( 2835 );
+    p->fill( qRgba( 255, 255, 255, 255 ) );
 
-    *p = *m_pageImage;
-
-    return true;
+    QPainter painter( p );
+    return renderToPainter( &painter, request );
 }
 
-bool XpsPage::renderToPainter( QPainter *painter )
+bool XpsPage::renderToPainter( QPainter *painter, Okular::PixmapRequest *request )
 {
     XpsHandler handler( this );
     handler.m_painter = painter;
+    handler.m_request = request;
     handler.m_painter->setWorldTransform(QTransform().scale((qreal)painter->device()->width() / size().width(), (qreal)painter->device()->height() / size().height()));
     QXmlSimpleReader parser;
     parser.setContentHandler( &handler );
@@ -1452,11 +1451,13 @@ bool XpsPage::renderToPainter( QPainter *painter )
     bool ok = parser.parse( source );
     qCWarning(OkularXpsDebug) << "Parse result: " << ok;
 
-    return true;
+    return !request || !request->shouldAbortRender();
 }
 
 QSizeF XpsPage::size() const
 {
+    if ( !m_pageSizeLoaded )
+        loadPageSize();
     return m_pageSize;
 }
 
@@ -1592,6 +1593,7 @@ Okular::TextPage* XpsPage::textPage()
     // qCWarning(OkularXpsDebug) << "Parsing XpsPage, text extraction";
 
     Okular::TextPage* textPage = new Okular::TextPage();
+    const QSizeF pageSize = size();
 
     const KZipFileEntry* pageFile = static_cast<const KZipFileEntry *>(m_file->xpsArchive()->directory()->entry( m_fileName ));
     QXmlStreamReader xml;
@@ -1661,10 +1663,10 @@ Okular::TextPage* XpsPage::textPage()
                 for (int i = 0; i < text.length(); i++) {
                     int width = metrics.width( text, i + 1 );
 
-                    Okular::NormalizedRect * rect = new Okular::NormalizedRect( (origin.x() + lastWidth) / m_pageSize.width(),
-                                                                                (origin.y() - metrics.height()) / m_pageSize.height(),
-                                                                                (origin.x() + width) / m_pageSize.width(),
-                                                                                origin.y() / m_pageSize.height() );
+                    Okular::NormalizedRect * rect = new Okular::NormalizedRect( (origin.x() + lastWidth) / pageSize.width(),
+                                                                                (origin.y() - metrics.height()) / pageSize.height(),
+                                                                                (origin.x() + width) / pageSize.width(),
+                                                                                origin.y() / pageSize.height() );
                     rect->transform( matrix );
                     textPage->append( text.mid(i, 1), rect );
 
@@ -1782,9 +1784,14 @@ XpsDocument::XpsDocument(XpsFile *file, const QString &fileName): m_file(file),
         docXml.readNext();
         if ( docXml.isStartElement() ) {
             if ( docXml.name() == QStringLiteral("PageContent") ) {
-                QString pagePath = docXml.attributes().value(QStringLiteral("Source")).toString();
+                const QXmlStreamAttributes attributes = docXml.attributes();
+                QString pagePath = attributes.value(QStringLiteral("Source")).toString();
                 qCWarning(OkularXpsDebug) << "Page Path: " << pagePath;
-                XpsPage *page = new XpsPage( file, absolutePath( documentFilePath, pagePath ) );
+                // The optional Width/Height hints of PageContent let us avoid
+                // inflating and parsing every FixedPage while loading
+                const QSizeF sizeHint( attributes.value( QStringLiteral("Width") ).toString().toDouble(),
+                                       attributes.value( QStringLiteral("Height") ).toString().toDouble() );
+                XpsPage *page = new XpsPage( file, absolutePath( documentFilePath, pagePath ), sizeHint );
                 m_pages.append(page);
             } else if ( docXml.name() == QStringLiteral("PageContent.LinkTargets") ) {
                 // do nothing - wait for the real LinkTarget elements
@@ -2074,6 +2081,7 @@ XpsGenerator::XpsGenerator( QObject *parent, const QVariantList &args )
     // 3) Qt >= 4.4.2 (see Trolltech task ID: 215090)
     if ( QFontDatabase::supportsThreadedFontRendering() )
         setFeature( Threaded );
+    setFeature( SupportsCancelling );
     userMutex();
 }
 
@@ -2116,10 +2124,14 @@ bool XpsGenerator::doCloseDocument()
 QImage XpsGenerator::image( Okular::PixmapRequest * request )
 {
     QMutexLocker lock( userMutex() );
+    if ( request->shouldAbortRender() )
+        return QImage();
+
     QSize size( (int)request->width(), (int)request->height() );
     QImage image( size, QImage::Format_RGB32 );
     XpsPage *pageToRender = m_xpsFile->page( request->page()->number() );
-    pageToRender->renderToImage( &image );
+    if ( !pageToRender->renderToImage( &image, request ) )
+        return QImage();
     return image;
 }
 
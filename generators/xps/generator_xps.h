@@ -140,6 +140,9 @@ protected:
 
     QPainter *m_painter;
 
+    // when set, the parsing stops as soon as the request is cancelled
+    Okular::PixmapRequest *m_request;
+
     QImage m_image;
 
     QStack<XpsRenderNode> m_nodes;
@@ -150,22 +153,33 @@ protected:
 class XpsPage
 {
 public:
-    XpsPage(XpsFile *file, const QString &fileName);
+    XpsPage(XpsFile *file, const QString &fileName, const QSizeF &sizeHint = QSizeF());
     ~XpsPage();
 
+    /**
+       the size of the page in drawing units; taken from the PageContent
+       size hint when available, otherwise read from the FixedPage on first use
+    */
     QSizeF size() const;
-    bool renderToImage( QImage *p );
-    bool renderToPainter( QPainter *painter );
+    /**
+       renders the page; returns false if the rendering was stopped
+       because @p request was cancelled
+    */
+    bool renderToImage( QImage *p, Okular::PixmapRequest *request = nullptr );
+    bool renderToPainter( QPainter *painter, Okular::PixmapRequest *request = nullptr );
     Okular::TextPage* textPage();
 
     QImage loadImageFromFile( const QString &filename );
     QString fileName() const { return m_fileName; }
 
 private:
+    void loadPageSize() const;
+
     XpsFile *m_file;
     const QString m_fileName;
 
-    QSizeF m_pageSize;
+    mutable QSizeF m_pageSize;
+    mutable bool m_pageSizeLoaded;
 
 
     QString m_thumbnailFileName;
@@ -173,9 +187,6 @@ private:
     QImage m_thumbnail;
     bool m_thumbnailIsLoaded;
 
-    QImage *m_pageImage;
-    bool m_pageIsRendered;
-
     friend class XpsHandler;
     friend class XpsTextExtractionHandler;
 };
@@ -1258,6 +1258,16 @@ QString Part::documentMetaData( const QString &metaData ) const
     return info.get( metaData );
 }
 
+QString Part::renderStatistics() const
+{
+    // one "key value" pair per line, times in microseconds
+    const QVariantMap statistics = m_document->metaData( QStringLiteral("RenderStatistics") ).toMap();
+    QString result;
+    for ( QVariantMap::const_iterator it = statistics.constBegin(); it != statistics.constEnd(); ++it )
+        result += it.key() + QLatin1Char(' ') + it.value().toString() + QLatin1Char('\n');
+    return result;
+}
+
 
 bool Part::slotImportPSFile()
 {
@@ -1989,6 +1999,9 @@ bool Part::slotAttemptReload( bool oneShot, const QUrl &newUrl )
         m_pageView->displayMessage( i18n("Reloading the document...") );
     }
 
+    // keep the pixmaps and text of the pages that turn out to be unchanged
+    m_document->prepareReload();
+
     // close and (try to) reopen the document
     if ( !closeUrl() )
     {
@@ -155,6 +155,7 @@ class OKULARPART_EXPORT Part : public KParts::ReadWritePart, public Okular::Docu
         Q_SCRIPTABLE uint currentPage();
         Q_SCRIPTABLE QString currentDocument();
         Q_SCRIPTABLE QString documentMetaData( const QString &metaData ) const;
+        Q_SCRIPTABLE QString renderStatistics() const;
         Q_SCRIPTABLE void slotPreferences();
         Q_SCRIPTABLE void slotFind();
         Q_SCRIPTABLE void slotPrintPreview();
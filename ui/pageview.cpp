@@ -205,6 +205,9 @@ public:
     // left click depress
     QTimer leftClickTimer;
 
+    // refreshes the render statistics overlay
+    QTimer renderStatisticsTimer;
+
     // actions
     QAction * aRotateClockwise;
     QAction * aRotateCounterClockwise;
@@ -422,6 +425,9 @@ PageView::PageView( QWidget *parent, Okular::Document *document )
     d->leftClickTimer.setSingleShot( true );
     connect( &d->leftClickTimer, &QTimer::timeout, this, &PageView::slotShowSizeAllCursor );
 
+    d->renderStatisticsTimer.setInterval( 500 );
+    connect( &d->renderStatisticsTimer, &QTimer::timeout, viewport(), static_cast<void (QWidget::*)()>( &QWidget::update ) );
+
     // set a corner button to resize the view to the page size
 //    QPushButton * resizeButton = new QPushButton( viewport() );
 //    resizeButton->setPixmap( SmallIcon("crop") );
@@ -995,6 +1001,29 @@ void PageView::createAnnotationsVideoWidgets(PageViewItem *item, const QLinkedLi
 }
 
 
+void PageView::createFormWidgets( PageViewItem *item, const QLinkedList< Okular::FormField * > &formFields, bool *hasFormWidgets, bool *hasSignatureForms )
+{
+    const bool allowfillforms = d->document->isAllowed( Okular::AllowFillForms );
+    QLinkedList< Okular::FormField * >::const_iterator ffIt = formFields.constBegin(), ffEnd = formFields.constEnd();
+    for ( ; ffIt != ffEnd; ++ffIt )
+    {
+        Okular::FormField * ff = *ffIt;
+        FormWidgetIface * w = FormWidgetFactory::createWidget( ff, viewport() );
+        if ( w )
+        {
+            w->setPageItem( item );
+            w->setFormWidgetsController( d->formWidgetsController() );
+            w->setVisibility( false );
+            w->setCanBeFilled( allowfillforms );
+            item->formWidgets().insert( w );
+            *hasFormWidgets = true;
+            if ( w->formField()->type() == Okular::FormField::FormSignature )
+                *hasSignatureForms = true;
+        }
+    }
+}
+
+
 //BEGIN DocumentObserver inherited methods
 void PageView::notifySetup( const QVector< Okular::Page * > & pageSet, int setupFlags )
 {
@@ -1112,25 +1141,7 @@ void PageView::notifySetup( const QVector< Okular::Page * > & pageSet, int setup
 #ifdef PAGEVIEW_DEBUG
         qCDebug(OkularUiDebug).nospace() << "cropped geom for " << d->items.last()->pageNumber() << " is " << d->items.last()->croppedGeometry();
 #endif
-        const QLinkedList< Okular::FormField * > pageFields = (*setIt)->formFields();
-        QLinkedList< Okular::FormField * >::const_iterator ffIt = pageFields.constBegin(), ffEnd = pageFields.constEnd();
-        for ( ; ffIt != ffEnd; ++ffIt )
-        {
-            Okular::FormField * ff = *ffIt;
-            FormWidgetIface * w = FormWidgetFactory::createWidget( ff, viewport() );
-            if ( w )
-            {
-                w->setPageItem( item );
-                w->setFormWidgetsController( d->formWidgetsController() );
-                w->setVisibility( false );
-                w->setCanBeFilled( allowfillforms );
-                item->formWidgets().insert( w );
-                hasformwidgets = true;
-                if ( w->formField()->type() == Okular::FormField::FormSignature )
-                    hassignatureforms = true;
-            }
-        }
-
+        createFormWidgets( item, (*setIt)->formFields(), &hasformwidgets, &hassignatureforms );
         createAnnotationsVideoWidgets( item, (*setIt)->annotations() );
     }
 
@@ -1409,6 +1420,32 @@ void PageView::notifyPageChanged( int pageNumber, int changedFlags )
     if ( changedFlags & DocumentObserver::Bookmark )
         return;
 
+    // the generator filled in the page after the setup, give it the
+    // widgets notifySetup() would have created
+    if ( changedFlags & DocumentObserver::PageContents )
+    {
+        PageViewItem * item = d->items.value( pageNumber );
+        if ( item && item->formWidgets().isEmpty() )
+        {
+            bool hasformwidgets = false;
+            bool hassignatureforms = false;
+            createFormWidgets( item, item->page()->formFields(), &hasformwidgets, &hassignatureforms );
+            if ( hasformwidgets )
+            {
+                // size the new widgets, slotRequestVisiblePixmaps() places them
+                item->setWHZC( item->croppedWidth(), item->croppedHeight(), item->zoomFactor(), item->crop() );
+                item->setFormWidgetsVisible( d->m_formsVisible );
+                if ( d->aToggleForms )
+                    d->aToggleForms->setEnabled( true );
+                if ( hassignatureforms && d->aValidateSignatures )
+                    d->aValidateSignatures->setEnabled( true );
+            }
+        }
+        if ( item )
+            createAnnotationsVideoWidgets( item, item->page()->annotations() );
+        QMetaObject::invokeMethod( this, "slotRequestVisiblePixmaps", Qt::QueuedConnection );
+    }
+
     if ( changedFlags & DocumentObserver::Annotations )
     {
         const QLinkedList< Okular::Annotation * > annots = d->document->page( pageNumber )->annotations();
@@ -1874,6 +1911,49 @@ void PageView::paintEvent(QPaintEvent *pe)
                 }
             }
         }
+
+        // 5) the render statistics stay in the corner of the viewport
+        if ( Okular::Settings::debugDrawRenderStatistics() )
+        {
+            screenPainter.resetTransform();
+            drawRenderStatistics( &screenPainter );
+            if ( !d->renderStatisticsTimer.isActive() )
+                d->renderStatisticsTimer.start();
+        }
+        else
+        {
+            d->renderStatisticsTimer.stop();
+        }
+}
+
+void PageView::drawRenderStatistics( QPainter * screenPainter )
+{
+        const Okular::RenderStatistics s = d->document->renderStatistics();
+        // average of a total time in microseconds, in milliseconds
+        auto average = []( qint64 time, int count ) { return count > 0 ? QString::number( time / 1000.0 / count, 'f', 1 ) : QStringLiteral( "-" ); };
+
+        const QStringList lines = QStringList()
+            << QStringLiteral( "pixmaps: %1 rendered, %2 cancelled" ).arg( s.renderedPixmaps() ).arg( s.cancelledPixmaps() )
+            << QStringLiteral( "cache: %1 hits, %2 misses" ).arg( s.cacheHits() ).arg( s.cacheMisses() )
+            << QStringLiteral( "memory: %1 pixmaps, %2 MiB" ).arg( s.allocatedPixmaps() ).arg( s.allocatedMemory() / ( 1024 * 1024 ) )
+            << QStringLiteral( "evicted: %1 pixmaps, %2 MiB in %3 ms" ).arg( s.evictedPixmaps() ).arg( s.evictedMemory() / ( 1024 * 1024 ) ).arg( s.evictionTime() / 1000 )
+            << QStringLiteral( "compressed: %1 pixmaps, %2 MiB, %3 MiB on disk" ).arg( s.compressedPixmaps() ).arg( s.compressedMemory() / ( 1024 * 1024 ) ).arg( s.compressedDiskMemory() / ( 1024 * 1024 ) )
+            << QStringLiteral( "compressed cache: %1 hits, %2 misses, avg %3 ms" ).arg( s.compressedCacheHits() ).arg( s.compressedCacheMisses() ).arg( average( s.decompressionTime(), s.compressedCacheHits() ) )
+            << QStringLiteral( "tile pool: %1 hits, %2 misses, %3 MiB idle, %4/%5 nodes" ).arg( s.tilePoolHits() ).arg( s.tilePoolMisses() ).arg( s.tilePoolMemory() / ( 1024 * 1024 ) ).arg( s.tileNodes() ).arg( s.allocatedTileNodes() )
+            << QStringLiteral( "avg ms: queue %1, render %2, convert %3, tiles %4, notify %5" )
+                .arg( average( s.queueTime(), s.renderedPixmaps() ), average( s.generationTime(), s.renderedPixmaps() ), average( s.conversionTime(), s.renderedPixmaps() ),
+                      average( s.tilingTime(), s.renderedPixmaps() ), average( s.notificationTime(), s.renderedPixmaps() ) )
+            << QStringLiteral( "text pages: %1, avg %2 ms" ).arg( s.textPages() ).arg( average( s.textPageTime(), s.textPages() ) );
+
+        const QFontMetrics metrics( screenPainter->font() );
+        int width = 0;
+        foreach ( const QString &line, lines )
+            width = qMax( width, metrics.width( line ) );
+        const QRect box( viewport()->width() - width - 20, 10, width + 10, lines.count() * metrics.height() + 10 );
+
+        screenPainter->fillRect( box, QColor( 0, 0, 0, 180 ) );
+        screenPainter->setPen( Qt::white );
+        screenPainter->drawText( box.adjusted( 5, 5, -5, -5 ), Qt::AlignLeft | Qt::AlignTop, lines.join( QLatin1Char( '\n' ) ) );
 }
 
 void PageView::drawTableDividers(QPainter * screenPainter)
@@ -37,6 +37,7 @@ class Action;
 class Document;
 class DocumentViewport;
 class Annotation;
+class FormField;
 class MovieAction;
 class RenditionAction;
 class PixmapRequest;
@@ -167,6 +168,7 @@ Q_OBJECT
         void selectionStart( const QPoint & pos, const QColor & color, bool aboveAll = false );
         void selectionClear( const ClearMode mode = ClearAllSelection );
         void drawTableDividers(QPainter * screenPainter);
+        void drawRenderStatistics( QPainter * screenPainter );
         void guessTableDividers();
         // update either text or rectangle selection
         void updateSelection( const QPoint & pos );
@@ -205,6 +207,7 @@ Q_OBJECT
         bool mouseReleaseOverLink( const Okular::ObjectRect * rect ) const;
 
         void createAnnotationsVideoWidgets(PageViewItem *item, const QLinkedList< Okular::Annotation * > &annotations);
+        void createFormWidgets( PageViewItem *item, const QLinkedList< Okular::FormField * > &formFields, bool *hasFormWidgets, bool *hasSignatureForms );
 
         // don't want to expose classes in here
         class PageViewPrivate * d;
@@ -29,6 +29,9 @@
 #include <qvalidator.h>
 #include <qapplication.h>
 #include <qdesktopwidget.h>
+#include <qmath.h>
+#include <qscreen.h>
+#include <qwindow.h>
 #include <QGestureEvent>
 #include <kcursor.h>
 #include <krandom.h>
@@ -73,6 +76,8 @@
 // comment this to disable the top-right progress indicator
 #define ENABLE_PROGRESS_OVERLAY
 
+// how many of the following slides are kept rendered
+#define PRESENTATION_RESERVED_SLIDES 2
 
 // a frame contains a pointer to the page object, its geometry and the
 // transition effect to the next frame
@@ -143,6 +148,11 @@ PresentationWidget::PresentationWidget( QWidget * parent, Okular::Document * doc
     : QWidget( nullptr /* must be null, to have an independent widget */, Qt::FramelessWindowHint ),
     m_pressedLink( nullptr ), m_handCursor( false ), m_drawingEngine( nullptr ),
     m_screenInhibitCookie(0), m_sleepInhibitCookie(0),
+    m_transitionDuration( 0 ), m_transitionFrameInterval( 16 ), m_transitionRectsShown( 0 ),
+    m_lastTransitionStepTime( 0 ), m_transitionStepPainting( false ),
+    m_currentPixmapOpacity( 1.0 ), m_fading( false ),
+    m_slideLatencyPage( -1 ), m_slideLatencyPreloaded( false ), m_slidesShown( 0 ), m_slidesPreloaded( 0 ),
+    m_totalSlideLatency( 0 ), m_worstSlideLatency( 0 ),
     m_parentWidget( parent ),
     m_document( doc ), m_frameIndex( -1 ), m_topBar( nullptr ), m_pagesEdit( nullptr ), m_searchBar( nullptr ),
     m_ac( collection ), m_screenSelect( nullptr ), m_isSetup( false ), m_blockNotifications( false ), m_inBlackScreenMode( false ),
@@ -243,6 +253,7 @@ PresentationWidget::PresentationWidget( QWidget * parent, Okular::Document * doc
     setContextMenuPolicy( Qt::PreventContextMenu );
     m_transitionTimer = new QTimer( this );
     m_transitionTimer->setSingleShot( true );
+    m_transitionTimer->setTimerType( Qt::PreciseTimer );
     connect(m_transitionTimer, &QTimer::timeout, this, &PresentationWidget::slotTransitionStep);
     m_overlayHideTimer = new QTimer( this );
     m_overlayHideTimer->setSingleShot( true );
@@ -283,6 +294,10 @@ PresentationWidget::~PresentationWidget()
     // allow power management saver again
     allowPowerManagement();
 
+    if ( m_slidesShown > 0 )
+        qCDebug(OkularUiDebug).nospace() << "Presentation: " << m_slidesShown << " slide changes, " << m_slidesPreloaded << " preloaded, "
+                                         << m_totalSlideLatency / m_slidesShown << " ms on average, " << m_worstSlideLatency << " ms at worst";
+
     // stop the audio playbacks
     Okular::AudioPlayer::instance()->stopPlaybacks();
 
@@ -452,7 +467,9 @@ void PresentationWidget::notifyCurrentPageChanged( int previousPage, int current
 
         // if pixmap not inside the Okular::Page we request it and wait for
         // notifyPixmapChanged call or else we can proceed to pixmap generation
-        if ( !frame->page->hasPixmap( this, ceil(pixW * qApp->devicePixelRatio()), ceil(pixH * qApp->devicePixelRatio()) ) )
+        m_slideLatencyPage = m_frameIndex;
+        m_slideLatencyPreloaded = frame->page->hasPixmap( this, ceil(pixW * qApp->devicePixelRatio()), ceil(pixH * qApp->devicePixelRatio()) );
+        if ( !m_slideLatencyPreloaded )
         {
             requestPixmaps();
         }
@@ -460,6 +477,8 @@ void PresentationWidget::notifyCurrentPageChanged( int previousPage, int current
         {
             // make the background pixmap
             generatePage();
+            // and get the reserved slides ready for the next change
+            requestPixmaps();
         }
 
         // perform the page opening action, if any
@@ -488,17 +507,9 @@ void PresentationWidget::notifyCurrentPageChanged( int previousPage, int current
 
 bool PresentationWidget::canUnloadPixmap( int pageNumber ) const
 {
-    if ( Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Low ||
-         Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Normal )
-    {
-        // can unload all pixmaps except for the currently visible one
-        return pageNumber != m_frameIndex;
-    }
-    else
-    {
-        // can unload all pixmaps except for the currently visible one, previous and next
-        return qAbs(pageNumber - m_frameIndex) <= 1;
-    }
+    // the reserved slides are kept whatever the memory pressure, so that
+    // changing slide never has to wait for the renderer
+    return !isReservedPage( pageNumber );
 }
 
 void PresentationWidget::setupActions()
@@ -781,6 +792,14 @@ void PresentationWidget::mouseMoveEvent( QMouseEvent * e )
 
 void PresentationWidget::paintEvent( QPaintEvent * pe )
 {
+    // the next step of the transition waits for this one to be painted
+    if ( m_transitionStepPainting )
+    {
+        m_transitionStepPainting = false;
+        const int spent = m_transitionClock.elapsed() - m_lastTransitionStepTime;
+        m_transitionTimer->start( qMax( 0, m_transitionFrameInterval - spent ) );
+    }
+
     qreal dpr = devicePixelRatioF();
 
     if ( m_inBlackScreenMode )
@@ -836,7 +855,7 @@ void PresentationWidget::paintEvent( QPaintEvent * pe )
             QPainter pixPainter( &backPixmap );
 
             // first draw the background on the backbuffer
-            pixPainter.drawPixmap( QPoint(0,0), m_lastRenderedPixmap, dR );
+            drawPagePixmap( pixPainter, QPoint(0,0), dR );
 
             // then blend the overlay (a piece of) over the background
             QRect ovr = m_overlayGeometry.intersected( r );
@@ -851,8 +870,8 @@ void PresentationWidget::paintEvent( QPaintEvent * pe )
             painter.drawPixmap( r.topLeft(), backPixmap, dBackPixmapRect );
         } else
 #endif
-        // copy the rendered pixmap to the screen
-        painter.drawPixmap( r.topLeft(), m_lastRenderedPixmap, dR );
+        // copy the rendered pixmap (or the current fade frame) to the screen
+        drawPagePixmap( painter, r.topLeft(), dR );
     }
 
     // paint drawings
@@ -881,6 +900,30 @@ void PresentationWidget::paintEvent( QPaintEvent * pe )
     painter.end();
 }
 
+void PresentationWidget::drawPagePixmap( QPainter &painter, const QPoint &pos, const QRect &source ) const
+{
+    if ( !m_fading )
+    {
+        painter.drawPixmap( pos, m_lastRenderedPixmap, source );
+        return;
+    }
+
+    // cross-fade the two pages
+    if ( m_previousPagePixmap.isNull() )
+    {
+        const qreal dpr = m_currentPagePixmap.devicePixelRatioF();
+        painter.fillRect( QRectF( pos, QSizeF( source.size() ) / dpr ), Okular::Settings::slidesBackgroundColor() );
+    }
+    else
+    {
+        painter.drawPixmap( pos, m_previousPagePixmap, source );
+    }
+    painter.save();
+    painter.setOpacity( m_currentPixmapOpacity );
+    painter.drawPixmap( pos, m_currentPagePixmap, source );
+    painter.restore();
+}
+
 void PresentationWidget::resizeEvent( QResizeEvent *re )
 {
     // qCDebug(OkularUiDebug) << re->oldSize() << "=>" << re->size();
@@ -997,6 +1040,9 @@ void PresentationWidget::changePage( int newPage )
     if ( m_frameIndex == newPage )
         return;
 
+    // measure how long it takes until the new slide is fully on screen
+    m_slideLatencyClock.start();
+
     // switch to newPage
     m_document->setViewportPage( newPage, this );
 
@@ -1054,6 +1100,10 @@ void PresentationWidget::generatePage( bool disableTransition )
         initTransition( &trans );
     }
 
+    // transitions report it when they are over
+    if ( !m_transitionTimer->isActive() )
+        slideShown();
+
     // update cursor + tooltip
     if ( !m_drawingEngine && Okular::Settings::slidesCursor() != Okular::Settings::EnumSlidesCursor::Hidden )
     {
@@ -1404,57 +1454,113 @@ void PresentationWidget::repositionContent()
 
 void PresentationWidget::requestPixmaps()
 {
+    const qreal dpr = qApp->devicePixelRatio();
+    QLinkedList< Okular::PixmapRequest * > requests;
+
+    // request the pixmap of the current page, unless it was preloaded
     PresentationFrame * frame = m_frames[ m_frameIndex ];
     int pixW = frame->geometry.width();
     int pixH = frame->geometry.height();
+    if ( !frame->page->hasPixmap( this, ceil( pixW * dpr ), ceil( pixH * dpr ) ) )
+        requests.push_back( new Okular::PixmapRequest( this, m_frameIndex, pixW, pixH, PRESENTATION_PRIO, Okular::PixmapRequest::NoFeature ) );
 
-    // operation will take long: set busy cursor
-    QApplication::setOverrideCursor( QCursor( Qt::BusyCursor ) );
-    // request the pixmap
-    QLinkedList< Okular::PixmapRequest * > requests;
-    requests.push_back( new Okular::PixmapRequest( this, m_frameIndex, pixW, pixH, PRESENTATION_PRIO, Okular::PixmapRequest::NoFeature ) );
-    // restore cursor
-    QApplication::restoreOverrideCursor();
     // ask for next and previous page if not in low memory usage setting
     if ( Okular::SettingsCore::memoryLevel() != Okular::SettingsCore::EnumMemoryLevel::Low )
     {
-        int pagesToPreload = 1;
-
-        // If greedy, preload everything
-        if (Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Greedy)
-            pagesToPreload = (int)m_document->pages();
-
         Okular::PixmapRequest::PixmapRequestFeatures requestFeatures = Okular::PixmapRequest::Preload;
         requestFeatures |= Okular::PixmapRequest::Asynchronous;
 
-        for( int j = 1; j <= pagesToPreload; j++ )
+        // the reserved slides come first, nearest first; if greedy the rest
+        // of the document is preloaded after them
+        const QList< int > reserved = reservedPages();
+        QList< int > pagesToPreload = reserved;
+        if ( Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Greedy )
         {
-            int tailRequest = m_frameIndex + j;
-            if ( tailRequest < (int)m_document->pages() )
+            for ( int j = 1; j < m_frames.count(); j++ )
             {
-                PresentationFrame *nextFrame = m_frames[ tailRequest ];
-                pixW = nextFrame->geometry.width();
-                pixH = nextFrame->geometry.height();
-                if ( !nextFrame->page->hasPixmap( this, pixW, pixH ) )
-                    requests.push_back( new Okular::PixmapRequest( this, tailRequest, pixW, pixH, PRESENTATION_PRELOAD_PRIO, requestFeatures ) );
+                if ( m_frameIndex + j < m_frames.count() && !reserved.contains( m_frameIndex + j ) )
+                    pagesToPreload << m_frameIndex + j;
+                if ( m_frameIndex - j >= 0 && !reserved.contains( m_frameIndex - j ) )
+                    pagesToPreload << m_frameIndex - j;
             }
+        }
+
+        foreach ( int page, pagesToPreload )
+        {
+            if ( page == m_frameIndex )
+                continue;
 
-            int headRequest = m_frameIndex - j;
-            if ( headRequest >= 0 )
+            PresentationFrame *preloadFrame = m_frames[ page ];
+            pixW = preloadFrame->geometry.width();
+            pixH = preloadFrame->geometry.height();
+            if ( !preloadFrame->page->hasPixmap( this, ceil( pixW * dpr ), ceil( pixH * dpr ) ) )
             {
-                PresentationFrame *prevFrame = m_frames[ headRequest ];
-                pixW = prevFrame->geometry.width();
-                pixH = prevFrame->geometry.height();
-                if ( !prevFrame->page->hasPixmap( this, pixW, pixH ) )
-                    requests.push_back( new Okular::PixmapRequest( this, headRequest, pixW, pixH, PRESENTATION_PRELOAD_PRIO, requestFeatures ) );
+                const int priority = reserved.contains( page ) ? PRESENTATION_RESERVED_PRIO : PRESENTATION_PRELOAD_PRIO;
+                requests.push_back( new Okular::PixmapRequest( this, page, pixW, pixH, priority, requestFeatures ) );
             }
+        }
+    }
+
+    if ( requests.isEmpty() )
+        return;
+
+    // operation will take long: set busy cursor
+    QApplication::setOverrideCursor( QCursor( Qt::BusyCursor ) );
+    m_document->requestPixmaps( requests );
+    QApplication::restoreOverrideCursor();
+}
+
+QList< int > PresentationWidget::reservedPages() const
+{
+    QList< int > pages;
+    if ( m_frameIndex < 0 || m_frameIndex >= m_frames.count() )
+        return pages;
+
+    pages << m_frameIndex;
+    if ( Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Low )
+        return pages;
 
-            // stop if we've already reached both ends of the document
-            if ( headRequest < 0 && tailRequest >= (int)m_document->pages() )
+    // the slides the presenter is most likely to go to next: the following
+    // ones (wrapping around if the slides loop) and the previous one
+    const bool loop = Okular::Settings::slidesLoop();
+    for ( int j = 1; j <= PRESENTATION_RESERVED_SLIDES; j++ )
+    {
+        int page = m_frameIndex + j;
+        if ( page >= m_frames.count() )
+        {
+            if ( !loop )
                 break;
+            page %= m_frames.count();
         }
+        if ( !pages.contains( page ) )
+            pages << page;
     }
-    m_document->requestPixmaps( requests );
+    if ( m_frameIndex > 0 && !pages.contains( m_frameIndex - 1 ) )
+        pages << m_frameIndex - 1;
+
+    return pages;
+}
+
+bool PresentationWidget::isReservedPage( int pageNumber ) const
+{
+    return reservedPages().contains( pageNumber );
+}
+
+void PresentationWidget::slideShown()
+{
+    if ( !m_slideLatencyClock.isValid() || m_slideLatencyPage != m_frameIndex )
+        return;
+
+    const qint64 latency = m_slideLatencyClock.elapsed();
+    m_slideLatencyClock.invalidate();
+
+    ++m_slidesShown;
+    if ( m_slideLatencyPreloaded )
+        ++m_slidesPreloaded;
+    m_totalSlideLatency += latency;
+    m_worstSlideLatency = qMax( m_worstSlideLatency, latency );
+    qCDebug(OkularUiDebug).nospace() << "Slide " << m_frameIndex + 1 << " shown " << latency << " ms after the page change ("
+                                     << ( m_slideLatencyPreloaded ? "preloaded" : "rendered on demand" ) << ")";
 }
 
 
@@ -1481,7 +1587,7 @@ void PresentationWidget::slotNextPage()
 #endif
         if ( m_transitionTimer->isActive() )
         {
-            m_transitionTimer->stop();
+            stopTransition();
             m_lastRenderedPixmap = m_currentPagePixmap;
             update();
         }
@@ -1508,7 +1614,7 @@ void PresentationWidget::slotPrevPage()
 #endif
         if ( m_transitionTimer->isActive() )
         {
-            m_transitionTimer->stop();
+            stopTransition();
             m_lastRenderedPixmap = m_currentPagePixmap;
             update();
         }
@@ -1534,43 +1640,58 @@ void PresentationWidget::slotHideOverlay()
 
 void PresentationWidget::slotTransitionStep()
 {
+    const qint64 elapsed = m_transitionClock.elapsed();
+    m_lastTransitionStepTime = elapsed;
+
+    const double progress = m_transitionDuration > 0 ? qMin( 1.0, (double)elapsed / m_transitionDuration ) : 1.0;
+
     switch( m_currentTransition.type() )
     {
         case Okular::PageTransition::Fade:
         {
-            QPainter pixmapPainter;
-            m_currentPixmapOpacity += 1.0 / m_transitionSteps;
-            m_lastRenderedPixmap = QPixmap( m_lastRenderedPixmap.size() );
-            m_lastRenderedPixmap.setDevicePixelRatio( qApp->devicePixelRatio() );
-            m_lastRenderedPixmap.fill( Qt::transparent );
-            pixmapPainter.begin( &m_lastRenderedPixmap );
-            pixmapPainter.setCompositionMode( QPainter::CompositionMode_Source );
-            pixmapPainter.setOpacity( 1 - m_currentPixmapOpacity );
-            pixmapPainter.drawPixmap( 0, 0, m_previousPagePixmap );
-            pixmapPainter.setOpacity( m_currentPixmapOpacity );
-            pixmapPainter.drawPixmap( 0, 0, m_currentPagePixmap );
+            m_currentPixmapOpacity = progress;
             update();
-            if( m_currentPixmapOpacity >= 1 )
-                return;
+            m_transitionStepPainting = true;
         } break;
         default:
         {
-            if ( m_transitionRects.empty() )
-            {
-                // it's better to fix the transition to cover the whole screen than
-                // enabling the following line that wastes cpu for nothing
-                //update();
-                return;
-            }
-
-            for ( int i = 0; i < m_transitionMul && !m_transitionRects.empty(); i++ )
+            // reveal all the rects that are due by now with a single repaint
+            const int rectsDue = qCeil( progress * m_transitionRects.count() );
+            QRegion dirty;
+            for ( ; m_transitionRectsShown < rectsDue; ++m_transitionRectsShown )
+                dirty += m_transitionRects.at( m_transitionRectsShown );
+            if ( !dirty.isEmpty() )
             {
-                update( m_transitionRects.first() );
-                m_transitionRects.pop_front();
+                update( dirty );
+                m_transitionStepPainting = true;
             }
         } break;
     }
-    m_transitionTimer->start( m_transitionDelay );
+
+    if ( progress >= 1.0 )
+    {
+        m_transitionStepPainting = false;
+        m_fading = false;
+        update();
+        slideShown();
+        return;
+    }
+
+    // a step that changed the screen starts the next one from paintEvent(),
+    // so the steps are never computed faster than they are shown
+    if ( !m_transitionStepPainting )
+        m_transitionTimer->start( m_transitionFrameInterval );
+}
+
+void PresentationWidget::stopTransition()
+{
+    m_transitionTimer->stop();
+    m_transitionStepPainting = false;
+    if ( m_fading )
+    {
+        m_fading = false;
+        update();
+    }
 }
 
 void PresentationWidget::slotDelayedEvents()
@@ -1707,10 +1828,7 @@ void PresentationWidget::applyNewScreenSize( const QSize & oldSize )
     requestPixmaps();
     m_blockNotifications = false;
     }
-    if ( m_transitionTimer->isActive() )
-    {
-        m_transitionTimer->stop();
-    }
+    stopTransition();
     generatePage( true /* no transitions */ );
 }
 
@@ -1979,6 +2097,8 @@ const Okular::PageTransition PresentationWidget::defaultTransition( int type ) c
 /** ONLY the TRANSITIONS GENERATION function from here on **/
 void PresentationWidget::initTransition( const Okular::PageTransition *transition )
 {
+    stopTransition();
+
     // if it's just a 'replace' transition, repaint the screen
     if ( transition->type() == Okular::PageTransition::Replace )
     {
@@ -2050,8 +2170,6 @@ void PresentationWidget::initTransition( const Okular::PageTransition *transitio
                     }
                 }
             }
-            m_transitionMul = 2;
-            m_transitionDelay = (int)( (totalTime * 1000) / steps );
         } break;
 
             // blinds: horizontal(l-to-r) / vertical(t-to-b)
@@ -2091,8 +2209,6 @@ void PresentationWidget::initTransition( const Okular::PageTransition *transitio
                     }
                 }
             }
-            m_transitionMul = blinds;
-            m_transitionDelay = (int)( (totalTime * 1000) / steps );
         } break;
 
             // box: inward / outward
@@ -2135,8 +2251,6 @@ void PresentationWidget::initTransition( const Okular::PageTransition *transitio
                     L = newL; T = newT; R = newR, B = newB;
                 }
             }
-            m_transitionMul = 4;
-            m_transitionDelay = (int)( (totalTime * 1000) / steps );
         } break;
 
             // wipe: implemented for 4 canonical angles
@@ -2189,8 +2303,6 @@ void PresentationWidget::initTransition( const Okular::PageTransition *transitio
                 update();
                 return;
             }
-            m_transitionMul = 1;
-            m_transitionDelay = (int)( (totalTime * 1000) / steps );
         } break;
 
             // dissolve: replace 'random' rects
@@ -2232,9 +2344,6 @@ void PresentationWidget::initTransition( const Okular::PageTransition *transitio
                     m_transitionRects[ n1 ] = r;
                 }
             }
-            // set global transition parameters
-            m_transitionMul = 40;
-            m_transitionDelay = (int)( (m_transitionMul * 1000 * totalTime) / steps );
         } break;
 
             // glitter: similar to dissolve but has a direction
@@ -2328,29 +2437,14 @@ void PresentationWidget::initTransition( const Okular::PageTransition *transitio
                     m_transitionRects[ n1 ] = r;
                 }
             }
-            // set global transition parameters
-            m_transitionMul = (angle == 90) || (angle == 270) ? gridYsteps : gridXsteps;
-            m_transitionMul /= 2;
-            m_transitionDelay = (int)( (m_transitionMul * 1000 * totalTime) / steps );
         } break;
 
         case Okular::PageTransition::Fade:
         {
-            enum {FADE_TRANSITION_FPS = 20};
-            const int steps = totalTime * FADE_TRANSITION_FPS;
-            m_transitionSteps = steps;
-            QPainter pixmapPainter;
-            m_currentPixmapOpacity = (double) 1 / steps;
-            m_transitionDelay = (int)( totalTime * 1000 ) / steps;
-            m_lastRenderedPixmap = QPixmap( m_lastRenderedPixmap.size() );
-            m_lastRenderedPixmap.fill( Qt::transparent );
-            pixmapPainter.begin( &m_lastRenderedPixmap );
-            pixmapPainter.setCompositionMode( QPainter::CompositionMode_Source );
-            pixmapPainter.setOpacity( 1 - m_currentPixmapOpacity );
-            pixmapPainter.drawPixmap( 0, 0, m_previousPagePixmap );
-            pixmapPainter.setOpacity( m_currentPixmapOpacity );
-            pixmapPainter.drawPixmap( 0, 0, m_currentPagePixmap );
-            pixmapPainter.end();
+            // paintEvent() draws the new page over the old one with the
+            // opacity of the current step, nothing is blended beforehand
+            m_currentPixmapOpacity = 0.0;
+            m_fading = true;
             update();
         } break;
         // implement missing transitions (a binary raster engine needed here)
@@ -2367,6 +2461,18 @@ void PresentationWidget::initTransition( const Okular::PageTransition *transitio
             return;
     }
 
+    // the progress comes from the clock: a late frame catches up instead of
+    // making the whole transition longer; the steps are no closer than a
+    // refresh of the screen
+    const QScreen *screen = windowHandle() ? windowHandle()->screen() : QGuiApplication::primaryScreen();
+    const qreal refreshRate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60.0;
+    m_transitionFrameInterval = qMax( 1, qRound( 1000.0 / refreshRate ) );
+    m_transitionDuration = qMax( 0, (int)( totalTime * 1000 ) );
+    m_transitionRectsShown = 0;
+    m_lastTransitionStepTime = 0;
+    m_transitionStepPainting = false;
+    m_transitionClock.start();
+
     // send the first start to the timer
     m_transitionTimer->start( 0 );
 }
@@ -11,6 +11,7 @@
 #define _OKULAR_PRESENTATIONWIDGET_H_
 
 #include <QDomElement>
+#include <qelapsedtimer.h>
 #include <qlist.h>
 #include <qpixmap.h>
 #include <qstringlist.h>
@@ -86,6 +87,8 @@ class PresentationWidget : public QWidget, public Okular::DocumentObserver
         void generateContentsPage( int page, QPainter & p );
         void generateOverlay();
         void initTransition( const Okular::PageTransition *transition );
+        void stopTransition();
+        void drawPagePixmap( QPainter &painter, const QPoint &pos, const QRect &source ) const;
         const Okular::PageTransition defaultTransition() const;
         const Okular::PageTransition defaultTransition( int ) const;
         QRect routeMouseDrawingEvent( QMouseEvent * );
@@ -93,6 +96,9 @@ class PresentationWidget : public QWidget, public Okular::DocumentObserver
         void recalcGeometry();
         void repositionContent();
         void requestPixmaps();
+        QList< int > reservedPages() const;
+        bool isReservedPage( int pageNumber ) const;
+        void slideShown();
         void setScreen( int );
         void applyNewScreenSize( const QSize & oldSize );
         void inhibitPowerManagement();
@@ -120,14 +126,27 @@ class PresentationWidget : public QWidget, public Okular::DocumentObserver
         QTimer * m_transitionTimer;
         QTimer * m_overlayHideTimer;
         QTimer * m_nextPageTimer;
-        int m_transitionDelay;
-        int m_transitionMul;
-        int m_transitionSteps;
+        QElapsedTimer m_transitionClock;
+        int m_transitionDuration;
+        int m_transitionFrameInterval;
+        int m_transitionRectsShown;
+        qint64 m_lastTransitionStepTime;
+        bool m_transitionStepPainting;
         QList< QRect > m_transitionRects;
         Okular::PageTransition m_currentTransition;
         QPixmap m_currentPagePixmap;
         QPixmap m_previousPagePixmap;
         double m_currentPixmapOpacity;
+        bool m_fading;
+
+        // slide change latency
+        QElapsedTimer m_slideLatencyClock;
+        int m_slideLatencyPage;
+        bool m_slideLatencyPreloaded;
+        int m_slidesShown;
+        int m_slidesPreloaded;
+        qint64 m_totalSlideLatency;
+        qint64 m_worstSlideLatency;
 
         // misc stuff
         QWidget * m_parentWidget;
@@ -17,5 +17,7 @@
 #define THUMBNAILS_PRELOAD_PRIO 5
 #define PRESENTATION_PRIO 0
 #define PRESENTATION_PRELOAD_PRIO 3
+/** the slides kept ready around the current one in presentation mode **/
+#define PRESENTATION_RESERVED_PRIO 1
 
 #endif
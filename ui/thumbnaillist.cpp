@@ -624,7 +624,10 @@ void ThumbnailListPrivate::slotRequestVisiblePixmaps( int /*newContentsY*/ )
         // if pixmap not present add it to requests
         if ( !t->page()->hasPixmap( q, t->pixmapWidth(), t->pixmapHeight() ) )
         {
-            Okular::PixmapRequest * p = new Okular::PixmapRequest( q, t->pageNumber(), t->pixmapWidth(), t->pixmapHeight(), THUMBNAILS_PRIO, Okular::PixmapRequest::Asynchronous );
+            // thumbnails are kept on disk, so reopening the document shows them at once
+            Okular::PixmapRequest::PixmapRequestFeatures requestFeatures = Okular::PixmapRequest::Asynchronous;
+            requestFeatures |= Okular::PixmapRequest::Persistent;
+            Okular::PixmapRequest * p = new Okular::PixmapRequest( q, t->pageNumber(), t->pixmapWidth(), t->pixmapHeight(), THUMBNAILS_PRIO, requestFeatures );
             requestedPixmaps.push_back( p );
         }
     }